@@ -0,0 +1,451 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nimiq_client.h"
+
+// APDU protocol constants. These must match the definitions in src/main.c.
+#define CLA 0xE0
+#define INS_GET_PUBLIC_KEY 0x02
+#define INS_SIGN_TX 0x04
+#define INS_KEEP_ALIVE 0x08
+#define INS_SIGN_MESSAGE 0x0A
+#define P1_NO_SIGNATURE 0x00
+#define P1_SIGNATURE 0x01
+#define P2_NO_CONFIRM 0x00
+#define P2_CONFIRM 0x01
+#define P1_FIRST 0x00
+#define P1_MORE 0x80
+#define P1_STREAMED_FIRST_PASS 0x01
+#define P1_STREAMED_SECOND_PASS 0x02
+#define P2_LAST 0x00
+#define P2_MORE 0x80
+
+#define OFFSET_CLA 0
+#define OFFSET_INS 1
+#define OFFSET_P1 2
+#define OFFSET_P2 3
+#define OFFSET_LC 4
+#define OFFSET_CDATA 5
+
+#define MAX_CDATA_LENGTH 255
+// Length byte and big endian uint32 indices.
+#define MAX_ENCODED_BIP32_PATH_LENGTH (1 + MAX_BIP32_PATH_LENGTH * 4)
+
+struct nimiq_client_t {
+    nimiq_transport_t *transport;
+    // Held for the duration of a request, or of a batch of requests, as the app only handles one request at a time.
+    pthread_mutex_t request_mutex;
+    // Number of asynchronous requests which did not finish yet, guarded by pending_mutex.
+    pthread_mutex_t pending_mutex;
+    pthread_cond_t pending_condition;
+    size_t pending_count;
+    // Command and response buffers, guarded by request_mutex. Each chunk is assembled in place in command, without
+    // further copies before handing it to the transport.
+    uint8_t command[NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH];
+    uint8_t response[NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH];
+};
+
+// Bip32 paths
+
+error_t nimiq_bip32_path_parse(const char *path_string, nimiq_bip32_path_t *out_path) {
+    if (!strncmp(path_string, "m/", strlen("m/"))) path_string += strlen("m/");
+    out_path->length = 0;
+    while (*path_string) {
+        if (out_path->length == MAX_BIP32_PATH_LENGTH) return ERROR_INVALID_LENGTH;
+        if (*path_string < '0' || *path_string > '9') return ERROR_INCORRECT_DATA;
+        uint64_t index = 0;
+        for (; *path_string >= '0' && *path_string <= '9'; path_string++) {
+            index = index * 10 + (*path_string - '0');
+            if (index >= 0x80000000) return ERROR_INCORRECT_DATA;
+        }
+        if (*path_string == '\'' || *path_string == 'h') {
+            index |= 0x80000000;
+            path_string++;
+        }
+        if (*path_string == '/' && path_string[1]) {
+            path_string++;
+        } else if (*path_string) {
+            return ERROR_INCORRECT_DATA;
+        }
+        out_path->indices[out_path->length++] = (uint32_t) index;
+    }
+    return out_path->length ? ERROR_NONE : ERROR_INCORRECT_DATA;
+}
+
+// Encode a bip32 path as read by reader_read_bip32_path. Returns the encoded length.
+static uint8_t encode_bip32_path(const nimiq_bip32_path_t *path, uint8_t *out) {
+    out[0] = path->length;
+    for (uint8_t i = 0; i < path->length; i++) {
+        out[1 + i * 4] = (uint8_t) (path->indices[i] >> 24);
+        out[2 + i * 4] = (uint8_t) (path->indices[i] >> 16);
+        out[3 + i * 4] = (uint8_t) (path->indices[i] >> 8);
+        out[4 + i * 4] = (uint8_t) path->indices[i];
+    }
+    return 1 + path->length * 4;
+}
+
+// APDU exchange
+
+/**
+ * Send the command APDU assembled in client->command, with cdata_length bytes of command data, and receive the
+ * response. A request interrupted by a SW_KEEP_ALIVE heartbeat is continued via INS_KEEP_ALIVE, until the app responds
+ * with another status word. The response data is left in client->response.
+ */
+static error_t client_exchange(nimiq_client_t *client, uint8_t ins, uint8_t p1, uint8_t p2, uint8_t cdata_length,
+    sw_t *out_sw, uint16_t *out_response_data_length) {
+    client->command[OFFSET_CLA] = CLA;
+    client->command[OFFSET_INS] = ins;
+    client->command[OFFSET_P1] = p1;
+    client->command[OFFSET_P2] = p2;
+    client->command[OFFSET_LC] = cdata_length;
+    uint16_t command_length = OFFSET_CDATA + cdata_length;
+    while (true) {
+        uint16_t response_length;
+        error_t error = client->transport->exchange(client->transport, client->command, command_length,
+            client->response, &response_length);
+        if (error) return error;
+        if (response_length < /* status word */ 2) return ERROR_INVALID_LENGTH;
+        *out_response_data_length = response_length - 2;
+        *out_sw = (sw_t) (((uint16_t) client->response[response_length - 2] << 8)
+            | client->response[response_length - 1]);
+        if (*out_sw != SW_KEEP_ALIVE) return ERROR_NONE;
+        // The request is still ongoing. Renew it with a keep-alive request, which does not have any parameters or data.
+        memset(client->command, 0, OFFSET_CDATA);
+        client->command[OFFSET_CLA] = CLA;
+        client->command[OFFSET_INS] = INS_KEEP_ALIVE;
+        command_length = OFFSET_CDATA;
+    }
+}
+
+/**
+ * Send data in chunks of P1_FIRST / P1_MORE and P2_MORE / P2_LAST APDUs, combined with p1_mode. The header is sent at
+ * the start of the first chunk. All but the last chunk have to be acknowledged by the app with an empty SW_OK response,
+ * otherwise the request is aborted and the status word of the app is returned. The next chunk is only assembled after
+ * the previous one was acknowledged, as the app handles each APDU before it accepts the next one.
+ */
+static error_t client_send_chunked(nimiq_client_t *client, uint8_t ins, uint8_t p1_mode, const uint8_t *header,
+    uint8_t header_length, const uint8_t *data, size_t data_length, sw_t *out_sw, uint16_t *out_response_data_length) {
+    bool is_first = true;
+    do {
+        uint8_t *cdata = client->command + OFFSET_CDATA;
+        uint8_t cdata_length = 0;
+        if (is_first && header_length) {
+            memcpy(cdata, header, header_length);
+            cdata_length = header_length;
+        }
+        size_t chunk_length = MIN((size_t) (MAX_CDATA_LENGTH - cdata_length), data_length);
+        memcpy(cdata + cdata_length, data, chunk_length);
+        cdata_length += (uint8_t) chunk_length;
+        data += chunk_length;
+        data_length -= chunk_length;
+
+        uint8_t p1 = (is_first ? P1_FIRST : P1_MORE) | p1_mode;
+        uint8_t p2 = data_length ? P2_MORE : P2_LAST;
+        error_t error = client_exchange(client, ins, p1, p2, cdata_length, out_sw, out_response_data_length);
+        if (error || *out_sw != SW_OK) return error;
+        if (data_length && *out_response_data_length) return ERROR_INVALID_LENGTH;
+        is_first = false;
+    } while (data_length);
+    return ERROR_NONE;
+}
+
+// Requests, to be called with the request_mutex held
+
+static error_t get_public_key_locked(nimiq_client_t *client, const nimiq_public_key_request_t *request,
+    nimiq_public_key_result_t *out_result) {
+    if (request->path.length > MAX_BIP32_PATH_LENGTH
+        || request->verification_message_length > NIMIQ_MAX_VERIFICATION_MESSAGE_LENGTH) {
+        return ERROR_INVALID_LENGTH;
+    }
+    bool return_signature = request->verification_message != NULL;
+    uint8_t *cdata = client->command + OFFSET_CDATA;
+    uint8_t cdata_length = encode_bip32_path(&request->path, cdata);
+    if (return_signature) {
+        memcpy(cdata + cdata_length, request->verification_message, request->verification_message_length);
+        cdata_length += request->verification_message_length;
+    }
+    uint16_t response_data_length;
+    error_t error = client_exchange(client, INS_GET_PUBLIC_KEY, return_signature ? P1_SIGNATURE : P1_NO_SIGNATURE,
+        request->confirm ? P2_CONFIRM : P2_NO_CONFIRM, cdata_length, &out_result->sw, &response_data_length);
+    if (error || out_result->sw != SW_OK) return error;
+    if (response_data_length != NIMIQ_PUBLIC_KEY_LENGTH + (return_signature ? NIMIQ_SIGNATURE_LENGTH : 0)) {
+        return ERROR_INVALID_LENGTH;
+    }
+    memcpy(out_result->public_key, client->response, NIMIQ_PUBLIC_KEY_LENGTH);
+    if (return_signature) {
+        memcpy(out_result->signature, client->response + NIMIQ_PUBLIC_KEY_LENGTH, NIMIQ_SIGNATURE_LENGTH);
+    }
+    return ERROR_NONE;
+}
+
+static error_t sign_transaction_locked(nimiq_client_t *client, const nimiq_transaction_request_t *request,
+    nimiq_transaction_result_t *out_result) {
+    if (request->path.length > MAX_BIP32_PATH_LENGTH) return ERROR_INVALID_LENGTH;
+    out_result->has_staker_signature = false;
+    uint8_t header[MAX_ENCODED_BIP32_PATH_LENGTH + /* version */ 1];
+    uint8_t header_length = encode_bip32_path(&request->path, header);
+    header[header_length++] = (uint8_t) request->version;
+
+    uint16_t response_data_length;
+    error_t error;
+    if (request->streamed) {
+        // The first pass, for the review, is acknowledged with an empty response. The second pass, for the signing,
+        // does not repeat the header.
+        if ((error = client_send_chunked(client, INS_SIGN_TX, P1_STREAMED_FIRST_PASS, header, header_length,
+            request->transaction, request->transaction_length, &out_result->sw, &response_data_length))
+            || out_result->sw != SW_OK) {
+            return error;
+        }
+        if (response_data_length) return ERROR_INVALID_LENGTH;
+        error = client_send_chunked(client, INS_SIGN_TX, P1_STREAMED_SECOND_PASS, NULL, 0, request->transaction,
+            request->transaction_length, &out_result->sw, &response_data_length);
+    } else {
+        error = client_send_chunked(client, INS_SIGN_TX, 0, header, header_length, request->transaction,
+            request->transaction_length, &out_result->sw, &response_data_length);
+    }
+    if (error || out_result->sw != SW_OK) return error;
+
+    if (response_data_length == 2 * NIMIQ_SIGNATURE_LENGTH && !request->streamed) {
+        out_result->has_staker_signature = true;
+        memcpy(out_result->staker_signature, client->response + NIMIQ_SIGNATURE_LENGTH, NIMIQ_SIGNATURE_LENGTH);
+    } else if (response_data_length != NIMIQ_SIGNATURE_LENGTH) {
+        return ERROR_INVALID_LENGTH;
+    }
+    memcpy(out_result->signature, client->response, NIMIQ_SIGNATURE_LENGTH);
+    return ERROR_NONE;
+}
+
+static error_t sign_message_locked(nimiq_client_t *client, const nimiq_message_request_t *request,
+    nimiq_message_result_t *out_result) {
+    if (request->path.length > MAX_BIP32_PATH_LENGTH) return ERROR_INVALID_LENGTH;
+    uint8_t header[MAX_ENCODED_BIP32_PATH_LENGTH + /* flags */ 1 + /* message length */ 4];
+    uint8_t header_length = encode_bip32_path(&request->path, header);
+    header[header_length++] = request->flags;
+    header[header_length++] = (uint8_t) (request->message_length >> 24);
+    header[header_length++] = (uint8_t) (request->message_length >> 16);
+    header[header_length++] = (uint8_t) (request->message_length >> 8);
+    header[header_length++] = (uint8_t) request->message_length;
+
+    uint16_t response_data_length;
+    error_t error = client_send_chunked(client, INS_SIGN_MESSAGE, 0, header, header_length, request->message,
+        request->message_length, &out_result->sw, &response_data_length);
+    if (error || out_result->sw != SW_OK) return error;
+    if (response_data_length != NIMIQ_SIGNATURE_LENGTH) return ERROR_INVALID_LENGTH;
+    memcpy(out_result->signature, client->response, NIMIQ_SIGNATURE_LENGTH);
+    return ERROR_NONE;
+}
+
+// Client lifecycle
+
+error_t nimiq_client_create(nimiq_transport_t *transport, nimiq_client_t **out_client) {
+    nimiq_client_t *client = malloc(sizeof(nimiq_client_t));
+    if (!client) return ERROR_NOT_SUPPORTED;
+    client->transport = transport;
+    pthread_mutex_init(&client->request_mutex, NULL);
+    pthread_mutex_init(&client->pending_mutex, NULL);
+    pthread_cond_init(&client->pending_condition, NULL);
+    client->pending_count = 0;
+    *out_client = client;
+    return ERROR_NONE;
+}
+
+void nimiq_client_destroy(nimiq_client_t *client) {
+    pthread_mutex_lock(&client->pending_mutex);
+    while (client->pending_count) {
+        pthread_cond_wait(&client->pending_condition, &client->pending_mutex);
+    }
+    pthread_mutex_unlock(&client->pending_mutex);
+    client->transport->close(client->transport);
+    pthread_cond_destroy(&client->pending_condition);
+    pthread_mutex_destroy(&client->pending_mutex);
+    pthread_mutex_destroy(&client->request_mutex);
+    free(client);
+}
+
+// Synchronous and batch requests
+
+error_t nimiq_client_get_public_key(nimiq_client_t *client, const nimiq_public_key_request_t *request,
+    nimiq_public_key_result_t *out_result) {
+    pthread_mutex_lock(&client->request_mutex);
+    error_t error = get_public_key_locked(client, request, out_result);
+    pthread_mutex_unlock(&client->request_mutex);
+    return error;
+}
+
+error_t nimiq_client_sign_transaction(nimiq_client_t *client, const nimiq_transaction_request_t *request,
+    nimiq_transaction_result_t *out_result) {
+    pthread_mutex_lock(&client->request_mutex);
+    error_t error = sign_transaction_locked(client, request, out_result);
+    pthread_mutex_unlock(&client->request_mutex);
+    return error;
+}
+
+error_t nimiq_client_sign_message(nimiq_client_t *client, const nimiq_message_request_t *request,
+    nimiq_message_result_t *out_result) {
+    pthread_mutex_lock(&client->request_mutex);
+    error_t error = sign_message_locked(client, request, out_result);
+    pthread_mutex_unlock(&client->request_mutex);
+    return error;
+}
+
+error_t nimiq_client_get_public_keys(nimiq_client_t *client, const nimiq_public_key_request_t *requests, size_t count,
+    nimiq_public_key_result_t *out_results, size_t *out_processed_count) {
+    error_t error = ERROR_NONE;
+    size_t i = 0;
+    pthread_mutex_lock(&client->request_mutex);
+    while (i < count && !error && (!i || out_results[i - 1].sw == SW_OK)) {
+        error = get_public_key_locked(client, &requests[i], &out_results[i]);
+        i++;
+    }
+    pthread_mutex_unlock(&client->request_mutex);
+    *out_processed_count = i;
+    return error;
+}
+
+error_t nimiq_client_sign_transactions(nimiq_client_t *client, const nimiq_transaction_request_t *requests,
+    size_t count, nimiq_transaction_result_t *out_results, size_t *out_processed_count) {
+    error_t error = ERROR_NONE;
+    size_t i = 0;
+    pthread_mutex_lock(&client->request_mutex);
+    while (i < count && !error && (!i || out_results[i - 1].sw == SW_OK)) {
+        error = sign_transaction_locked(client, &requests[i], &out_results[i]);
+        i++;
+    }
+    pthread_mutex_unlock(&client->request_mutex);
+    *out_processed_count = i;
+    return error;
+}
+
+// Asynchronous requests
+
+typedef enum {
+    ASYNC_REQUEST_PUBLIC_KEY,
+    ASYNC_REQUEST_TRANSACTION,
+    ASYNC_REQUEST_MESSAGE,
+} async_request_type_t;
+
+typedef struct {
+    nimiq_client_t *client;
+    async_request_type_t type;
+    union {
+        nimiq_public_key_request_t public_key;
+        nimiq_transaction_request_t transaction;
+        nimiq_message_request_t message;
+    } request;
+    union {
+        nimiq_public_key_callback_t public_key;
+        nimiq_transaction_callback_t transaction;
+        nimiq_message_callback_t message;
+    } callback;
+    void *user_data;
+} async_request_t;
+
+static void *async_request_run(void *argument) {
+    async_request_t *async_request = argument;
+    nimiq_client_t *client = async_request->client;
+    error_t error;
+    switch (async_request->type) {
+        case ASYNC_REQUEST_PUBLIC_KEY: {
+            nimiq_public_key_result_t result = { 0 };
+            error = nimiq_client_get_public_key(client, &async_request->request.public_key, &result);
+            async_request->callback.public_key(error, &result, async_request->user_data);
+            break;
+        }
+        case ASYNC_REQUEST_TRANSACTION: {
+            nimiq_transaction_result_t result = { 0 };
+            error = nimiq_client_sign_transaction(client, &async_request->request.transaction, &result);
+            async_request->callback.transaction(error, &result, async_request->user_data);
+            break;
+        }
+        case ASYNC_REQUEST_MESSAGE: {
+            nimiq_message_result_t result = { 0 };
+            error = nimiq_client_sign_message(client, &async_request->request.message, &result);
+            async_request->callback.message(error, &result, async_request->user_data);
+            break;
+        }
+    }
+    free(async_request);
+
+    pthread_mutex_lock(&client->pending_mutex);
+    client->pending_count--;
+    pthread_cond_broadcast(&client->pending_condition);
+    pthread_mutex_unlock(&client->pending_mutex);
+    return NULL;
+}
+
+// Start a detached thread for the async request, which takes ownership of it.
+static error_t async_request_start(async_request_t *async_request) {
+    nimiq_client_t *client = async_request->client;
+    pthread_mutex_lock(&client->pending_mutex);
+    client->pending_count++;
+    pthread_mutex_unlock(&client->pending_mutex);
+
+    pthread_t thread;
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    int result = pthread_create(&thread, &attributes, async_request_run, async_request);
+    pthread_attr_destroy(&attributes);
+    if (!result) return ERROR_NONE;
+
+    free(async_request);
+    pthread_mutex_lock(&client->pending_mutex);
+    client->pending_count--;
+    pthread_cond_broadcast(&client->pending_condition);
+    pthread_mutex_unlock(&client->pending_mutex);
+    return ERROR_NOT_SUPPORTED;
+}
+
+static async_request_t *async_request_create(nimiq_client_t *client, async_request_type_t type, void *user_data) {
+    async_request_t *async_request = malloc(sizeof(async_request_t));
+    if (!async_request) return NULL;
+    async_request->client = client;
+    async_request->type = type;
+    async_request->user_data = user_data;
+    return async_request;
+}
+
+error_t nimiq_client_get_public_key_async(nimiq_client_t *client, const nimiq_public_key_request_t *request,
+    nimiq_public_key_callback_t callback, void *user_data) {
+    async_request_t *async_request = async_request_create(client, ASYNC_REQUEST_PUBLIC_KEY, user_data);
+    if (!async_request) return ERROR_NOT_SUPPORTED;
+    async_request->request.public_key = *request;
+    async_request->callback.public_key = callback;
+    return async_request_start(async_request);
+}
+
+error_t nimiq_client_sign_transaction_async(nimiq_client_t *client, const nimiq_transaction_request_t *request,
+    nimiq_transaction_callback_t callback, void *user_data) {
+    async_request_t *async_request = async_request_create(client, ASYNC_REQUEST_TRANSACTION, user_data);
+    if (!async_request) return ERROR_NOT_SUPPORTED;
+    async_request->request.transaction = *request;
+    async_request->callback.transaction = callback;
+    return async_request_start(async_request);
+}
+
+error_t nimiq_client_sign_message_async(nimiq_client_t *client, const nimiq_message_request_t *request,
+    nimiq_message_callback_t callback, void *user_data) {
+    async_request_t *async_request = async_request_create(client, ASYNC_REQUEST_MESSAGE, user_data);
+    if (!async_request) return ERROR_NOT_SUPPORTED;
+    async_request->request.message = *request;
+    async_request->callback.message = callback;
+    return async_request_start(async_request);
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_CLIENT_H_
+#define _NIMIQ_CLIENT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h" // for error_t, sw_t, transaction_version_t, MAX_BIP32_PATH_LENGTH and MESSAGE_FLAG_*
+#include "nimiq_transport.h"
+
+/**
+ * Host client for the APDU protocol of the Nimiq app, as described in doc/nimiqapp.md. It handles the encoding of
+ * requests, the splitting of transactions and messages into chunks, and continues requests which were interrupted by a
+ * SW_KEEP_ALIVE heartbeat of the app transparently.
+ *
+ * All request methods return an error_t for errors on the host side, like transport failures or malformed responses.
+ * If a request was answered by the app, ERROR_NONE is returned and the status word of the app is set as sw of the
+ * result, for example SW_DENY if the user rejected the request. The other fields of the result are only valid if the
+ * status word is SW_OK.
+ *
+ * A client is thread safe. Requests are processed one by one in the order in which they acquire the client, as the app
+ * only handles one request at a time.
+ */
+typedef struct nimiq_client_t nimiq_client_t;
+
+#define NIMIQ_PUBLIC_KEY_LENGTH 32
+#define NIMIQ_SIGNATURE_LENGTH 64
+// Maximum length of the verification message of nimiq_public_key_request_t, see handle_get_public_key in main.c.
+#define NIMIQ_MAX_VERIFICATION_MESSAGE_LENGTH 31
+
+typedef struct {
+    uint32_t indices[MAX_BIP32_PATH_LENGTH];
+    uint8_t length;
+} nimiq_bip32_path_t;
+
+typedef struct {
+    nimiq_bip32_path_t path;
+    // Whether the address should be shown to the user for confirmation.
+    bool confirm;
+    // Optional message to sign with the key, to verify the validity of the key pair. Must start with "dummy-data:".
+    // NULL, if no signature is requested.
+    const uint8_t *verification_message;
+    uint8_t verification_message_length;
+} nimiq_public_key_request_t;
+
+typedef struct {
+    sw_t sw;
+    uint8_t public_key[NIMIQ_PUBLIC_KEY_LENGTH];
+    // Only set if a verification message was passed.
+    uint8_t signature[NIMIQ_SIGNATURE_LENGTH];
+} nimiq_public_key_result_t;
+
+typedef struct {
+    nimiq_bip32_path_t path;
+    transaction_version_t version;
+    // The serialized transaction, see "Serialized transaction format" in doc/nimiqapp.md. Its data must remain valid
+    // until the request finished, also for asynchronous requests.
+    const uint8_t *transaction;
+    size_t transaction_length;
+    // Whether to sign in streamed signing mode, for transactions exceeding the supported length of the regular mode.
+    bool streamed;
+} nimiq_transaction_request_t;
+
+typedef struct {
+    sw_t sw;
+    uint8_t signature[NIMIQ_SIGNATURE_LENGTH];
+    // Set for staking transactions with an empty staker or validator signature proof, signed in regular mode.
+    bool has_staker_signature;
+    uint8_t staker_signature[NIMIQ_SIGNATURE_LENGTH];
+} nimiq_transaction_result_t;
+
+typedef struct {
+    nimiq_bip32_path_t path;
+    // Combination of MESSAGE_FLAG_PREFER_DISPLAY_TYPE_HEX and MESSAGE_FLAG_PREFER_DISPLAY_TYPE_HASH, or 0.
+    uint8_t flags;
+    // The message data must remain valid until the request finished, also for asynchronous requests.
+    const uint8_t *message;
+    uint32_t message_length;
+} nimiq_message_request_t;
+
+typedef struct {
+    sw_t sw;
+    uint8_t signature[NIMIQ_SIGNATURE_LENGTH];
+} nimiq_message_result_t;
+
+/**
+ * Parse a bip32 path like "44'/242'/0'/0'", optionally prefixed with "m/". Hardened indices are marked by ' or h.
+ * Returns ERROR_INCORRECT_DATA for malformed paths, and ERROR_INVALID_LENGTH for paths longer than
+ * MAX_BIP32_PATH_LENGTH.
+ */
+error_t nimiq_bip32_path_parse(const char *path_string, nimiq_bip32_path_t *out_path);
+
+/**
+ * Create a client communicating over the given transport. On success, the client takes ownership of the transport and
+ * closes it in nimiq_client_destroy.
+ */
+error_t nimiq_client_create(nimiq_transport_t *transport, nimiq_client_t **out_client);
+
+/**
+ * Wait for pending asynchronous requests to finish, then close the transport and free the client.
+ */
+void nimiq_client_destroy(nimiq_client_t *client);
+
+// Synchronous requests, which block until the request is finished, including the review by the user, if any.
+
+error_t nimiq_client_get_public_key(nimiq_client_t *client, const nimiq_public_key_request_t *request,
+    nimiq_public_key_result_t *out_result);
+
+error_t nimiq_client_sign_transaction(nimiq_client_t *client, const nimiq_transaction_request_t *request,
+    nimiq_transaction_result_t *out_result);
+
+error_t nimiq_client_sign_message(nimiq_client_t *client, const nimiq_message_request_t *request,
+    nimiq_message_result_t *out_result);
+
+/**
+ * Batch requests, which process multiple requests in order, without other requests of the client being interleaved.
+ * Processing stops at the first request, which failed with an error or which was not answered with SW_OK. The number
+ * of processed requests, including the failed one, is set as out_processed_count, and the error of the failed request,
+ * if any, is returned.
+ */
+error_t nimiq_client_get_public_keys(nimiq_client_t *client, const nimiq_public_key_request_t *requests, size_t count,
+    nimiq_public_key_result_t *out_results, size_t *out_processed_count);
+
+error_t nimiq_client_sign_transactions(nimiq_client_t *client, const nimiq_transaction_request_t *requests,
+    size_t count, nimiq_transaction_result_t *out_results, size_t *out_processed_count);
+
+/**
+ * Asynchronous requests, which return immediately and invoke the callback from a background thread when the request
+ * finished. The result passed to the callback is only valid during the callback. The request struct itself is copied,
+ * but the transaction or message data it points to must remain valid until the callback. Returns ERROR_NOT_SUPPORTED,
+ * if the background thread could not be started, in which case the callback is not invoked.
+ */
+typedef void (*nimiq_public_key_callback_t)(error_t error, const nimiq_public_key_result_t *result, void *user_data);
+typedef void (*nimiq_transaction_callback_t)(error_t error, const nimiq_transaction_result_t *result, void *user_data);
+typedef void (*nimiq_message_callback_t)(error_t error, const nimiq_message_result_t *result, void *user_data);
+
+error_t nimiq_client_get_public_key_async(nimiq_client_t *client, const nimiq_public_key_request_t *request,
+    nimiq_public_key_callback_t callback, void *user_data);
+
+error_t nimiq_client_sign_transaction_async(nimiq_client_t *client, const nimiq_transaction_request_t *request,
+    nimiq_transaction_callback_t callback, void *user_data);
+
+error_t nimiq_client_sign_message_async(nimiq_client_t *client, const nimiq_message_request_t *request,
+    nimiq_message_callback_t callback, void *user_data);
+
+#endif // _NIMIQ_CLIENT_H_
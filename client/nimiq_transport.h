@@ -0,0 +1,62 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_TRANSPORT_H_
+#define _NIMIQ_TRANSPORT_H_
+
+#include <stdint.h>
+
+#include "constants.h" // for error_t
+
+// Maximum length of a command APDU: CLA, INS, P1, P2, Lc and up to 255 bytes of data.
+#define NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH (5 + 255)
+// Maximum length of a response APDU, including the status word, as limited by IO_APDU_BUFFER_SIZE of the SDK.
+#define NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH 260
+
+/**
+ * A transport, over which command APDUs are exchanged with the Nimiq app. Transports only handle the framing of the
+ * underlying connection. The APDU protocol of the app on top of it, like chunking and keep-alives, is handled by
+ * nimiq_client.h.
+ */
+typedef struct nimiq_transport_t {
+    /**
+     * Send a raw command APDU and receive the raw response APDU, including the trailing status word. out_response must
+     * have room for NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH bytes. Returns ERROR_READ if the connection failed, and
+     * ERROR_INVALID_LENGTH if the response is malformed or too long.
+     */
+    error_t (*exchange)(struct nimiq_transport_t *transport, const uint8_t *command, uint16_t command_length,
+        uint8_t *out_response, uint16_t *out_response_length);
+    /**
+     * Close the connection and free the transport.
+     */
+    void (*close)(struct nimiq_transport_t *transport);
+} nimiq_transport_t;
+
+/**
+ * Open a Ledger device via a Linux hidraw device node like /dev/hidraw0. If device_path is NULL, the first hidraw node
+ * of the generic HID interface of a connected Ledger device is used. Returns ERROR_NOT_SUPPORTED if no device was
+ * found, and ERROR_READ if the device could not be opened, for example due to missing permissions.
+ */
+error_t nimiq_transport_hidraw_open(const char *device_path, nimiq_transport_t **out_transport);
+
+/**
+ * Connect to the APDU port of the speculos emulator, which is 9999 by default. Returns ERROR_READ if the connection
+ * failed.
+ */
+error_t nimiq_transport_speculos_open(const char *host, uint16_t port, nimiq_transport_t **out_transport);
+
+#endif // _NIMIQ_TRANSPORT_H_
@@ -0,0 +1,181 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "nimiq_transport.h"
+
+// APDUs are exchanged over HID in reports of 64 bytes, as described in "General transport description" in
+// doc/nimiqapp.md. Each report starts with the channel id, the command tag and the packet sequence index. The first
+// report of an APDU additionally holds the length of the APDU.
+#define HID_REPORT_LENGTH 64
+#define HID_CHANNEL 0x0101
+#define HID_TAG_APDU 0x05
+#define HID_HEADER_LENGTH 5 // channel, tag and sequence index
+#define HID_APDU_LENGTH_LENGTH 2
+#define LEDGER_USB_VENDOR_ID "00002C97"
+
+typedef struct {
+    nimiq_transport_t transport; // must be the first member, see the casts below
+    int fd;
+} hidraw_transport_t;
+
+static error_t write_report(int fd, const uint8_t *report) {
+    // hidraw expects the report id as first byte, which is 0 as the device does not use numbered reports.
+    uint8_t buffer[1 + HID_REPORT_LENGTH] = { 0 };
+    memcpy(buffer + 1, report, HID_REPORT_LENGTH);
+    ssize_t written;
+    do {
+        written = write(fd, buffer, sizeof(buffer));
+    } while (written < 0 && errno == EINTR);
+    return written == sizeof(buffer) ? ERROR_NONE : ERROR_READ;
+}
+
+static error_t read_report(int fd, uint8_t *out_report) {
+    ssize_t received;
+    do {
+        received = read(fd, out_report, HID_REPORT_LENGTH);
+    } while (received < 0 && errno == EINTR);
+    return received == HID_REPORT_LENGTH ? ERROR_NONE : ERROR_READ;
+}
+
+static void write_report_header(uint8_t *report, uint16_t sequence_index) {
+    report[0] = (uint8_t) (HID_CHANNEL >> 8);
+    report[1] = (uint8_t) HID_CHANNEL;
+    report[2] = HID_TAG_APDU;
+    report[3] = (uint8_t) (sequence_index >> 8);
+    report[4] = (uint8_t) sequence_index;
+}
+
+static error_t hidraw_exchange(nimiq_transport_t *transport, const uint8_t *command, uint16_t command_length,
+    uint8_t *out_response, uint16_t *out_response_length) {
+    int fd = ((hidraw_transport_t *) transport)->fd;
+    if (command_length > NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH) return ERROR_INVALID_LENGTH;
+
+    uint8_t report[HID_REPORT_LENGTH];
+    uint16_t offset = 0;
+    for (uint16_t sequence_index = 0; offset < command_length; sequence_index++) {
+        memset(report, 0, sizeof(report));
+        write_report_header(report, sequence_index);
+        uint8_t header_length = HID_HEADER_LENGTH;
+        if (sequence_index == 0) {
+            report[header_length++] = (uint8_t) (command_length >> 8);
+            report[header_length++] = (uint8_t) command_length;
+        }
+        uint16_t chunk_length = HID_REPORT_LENGTH - header_length;
+        if (chunk_length > command_length - offset) chunk_length = command_length - offset;
+        memcpy(report + header_length, command + offset, chunk_length);
+        offset += chunk_length;
+        error_t error = write_report(fd, report);
+        if (error) return error;
+    }
+
+    uint16_t response_length = 0;
+    offset = 0;
+    for (uint16_t sequence_index = 0; sequence_index == 0 || offset < response_length; sequence_index++) {
+        error_t error = read_report(fd, report);
+        if (error) return error;
+        if (report[0] != (uint8_t) (HID_CHANNEL >> 8) || report[1] != (uint8_t) HID_CHANNEL
+            || report[2] != HID_TAG_APDU || report[3] != (uint8_t) (sequence_index >> 8)
+            || report[4] != (uint8_t) sequence_index) {
+            return ERROR_INVALID_LENGTH;
+        }
+        uint8_t header_length = HID_HEADER_LENGTH;
+        if (sequence_index == 0) {
+            response_length = ((uint16_t) report[header_length] << 8) | report[header_length + 1];
+            header_length += HID_APDU_LENGTH_LENGTH;
+            if (response_length < /* status word */ 2 || response_length > NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH) {
+                return ERROR_INVALID_LENGTH;
+            }
+        }
+        uint16_t chunk_length = HID_REPORT_LENGTH - header_length;
+        if (chunk_length > response_length - offset) chunk_length = response_length - offset;
+        memcpy(out_response + offset, report + header_length, chunk_length);
+        offset += chunk_length;
+    }
+    *out_response_length = response_length;
+    return ERROR_NONE;
+}
+
+static void hidraw_close(nimiq_transport_t *transport) {
+    close(((hidraw_transport_t *) transport)->fd);
+    free(transport);
+}
+
+static bool read_sysfs_file(const char *path, char *out, size_t out_length) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    size_t length = fread(out, 1, out_length - 1, file);
+    fclose(file);
+    out[length] = '\0';
+    return true;
+}
+
+// Find the hidraw node of the generic HID interface (interface 0) of a Ledger device. The other interface, if enabled,
+// is the U2F / FIDO interface, which is not used here.
+static bool find_ledger_hidraw(char *out_device_path, size_t out_device_path_length) {
+    DIR *directory = opendir("/sys/class/hidraw");
+    if (!directory) return false;
+    bool found = false;
+    struct dirent *entry;
+    while (!found && (entry = readdir(directory))) {
+        if (strncmp(entry->d_name, "hidraw", strlen("hidraw"))) continue;
+        char path[512];
+        char content[1024];
+        snprintf(path, sizeof(path), "/sys/class/hidraw/%s/device/uevent", entry->d_name);
+        if (!read_sysfs_file(path, content, sizeof(content))) continue;
+        char *hid_id = strstr(content, "HID_ID=");
+        // HID_ID is formatted as <bus>:<vendor id>:<product id>.
+        if (!hid_id || strncmp(hid_id + strlen("HID_ID=0003:"), LEDGER_USB_VENDOR_ID, strlen(LEDGER_USB_VENDOR_ID))) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/class/hidraw/%s/device/../bInterfaceNumber", entry->d_name);
+        if (!read_sysfs_file(path, content, sizeof(content)) || strtol(content, NULL, 16) != 0) continue;
+        snprintf(out_device_path, out_device_path_length, "/dev/%s", entry->d_name);
+        found = true;
+    }
+    closedir(directory);
+    return found;
+}
+
+error_t nimiq_transport_hidraw_open(const char *device_path, nimiq_transport_t **out_transport) {
+    char found_device_path[sizeof("/dev/") + sizeof(((struct dirent *) NULL)->d_name)];
+    if (!device_path) {
+        if (!find_ledger_hidraw(found_device_path, sizeof(found_device_path))) return ERROR_NOT_SUPPORTED;
+        device_path = found_device_path;
+    }
+    int fd = open(device_path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) return ERROR_READ;
+
+    hidraw_transport_t *transport = malloc(sizeof(hidraw_transport_t));
+    if (!transport) {
+        close(fd);
+        return ERROR_READ;
+    }
+    transport->transport.exchange = hidraw_exchange;
+    transport->transport.close = hidraw_close;
+    transport->fd = fd;
+    *out_transport = &transport->transport;
+    return ERROR_NONE;
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "nimiq_transport.h"
+
+// The APDU port of speculos frames each command APDU with its length as big endian uint32. Responses are framed with
+// the length of the response data, excluding the status word, which follows after the data.
+
+typedef struct {
+    nimiq_transport_t transport; // must be the first member, see the casts below
+    int socket_fd;
+} speculos_transport_t;
+
+static error_t write_all(int socket_fd, const uint8_t *data, size_t length) {
+    while (length) {
+        ssize_t written = send(socket_fd, data, length, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return ERROR_READ;
+        data += written;
+        length -= written;
+    }
+    return ERROR_NONE;
+}
+
+static error_t read_all(int socket_fd, uint8_t *out, size_t length) {
+    while (length) {
+        ssize_t received = recv(socket_fd, out, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return ERROR_READ;
+        out += received;
+        length -= received;
+    }
+    return ERROR_NONE;
+}
+
+static error_t speculos_exchange(nimiq_transport_t *transport, const uint8_t *command, uint16_t command_length,
+    uint8_t *out_response, uint16_t *out_response_length) {
+    int socket_fd = ((speculos_transport_t *) transport)->socket_fd;
+    if (command_length > NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH) return ERROR_INVALID_LENGTH;
+    // Send the length and the command in one piece.
+    uint8_t frame[4 + NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH] = { 0, 0, (uint8_t) (command_length >> 8),
+        (uint8_t) command_length };
+    memcpy(frame + 4, command, command_length);
+    uint8_t length_bytes[4];
+    error_t error;
+    if ((error = write_all(socket_fd, frame, 4 + command_length))
+        || (error = read_all(socket_fd, length_bytes, sizeof(length_bytes)))) {
+        return error;
+    }
+    uint32_t data_length = ((uint32_t) length_bytes[0] << 24) | ((uint32_t) length_bytes[1] << 16)
+        | ((uint32_t) length_bytes[2] << 8) | length_bytes[3];
+    if (data_length > NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH - /* status word */ 2) return ERROR_INVALID_LENGTH;
+    if ((error = read_all(socket_fd, out_response, data_length + /* status word */ 2))) return error;
+    *out_response_length = (uint16_t) data_length + 2;
+    return ERROR_NONE;
+}
+
+static void speculos_close(nimiq_transport_t *transport) {
+    close(((speculos_transport_t *) transport)->socket_fd);
+    free(transport);
+}
+
+error_t nimiq_transport_speculos_open(const char *host, uint16_t port, nimiq_transport_t **out_transport) {
+    char port_string[6];
+    snprintf(port_string, sizeof(port_string), "%u", port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addresses;
+    if (getaddrinfo(host, port_string, &hints, &addresses)) return ERROR_READ;
+
+    int socket_fd = -1;
+    for (struct addrinfo *address = addresses; address && socket_fd < 0; address = address->ai_next) {
+        socket_fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket_fd >= 0 && connect(socket_fd, address->ai_addr, address->ai_addrlen)) {
+            close(socket_fd);
+            socket_fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (socket_fd < 0) return ERROR_READ;
+    // Don't delay the small request packets via Nagle's algorithm.
+    int no_delay = 1;
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+    speculos_transport_t *transport = malloc(sizeof(speculos_transport_t));
+    if (!transport) {
+        close(socket_fd);
+        return ERROR_READ;
+    }
+    transport->transport.exchange = speculos_exchange;
+    transport->transport.close = speculos_close;
+    transport->socket_fd = socket_fd;
+    *out_transport = &transport->transport;
+    return ERROR_NONE;
+}
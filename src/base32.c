@@ -19,6 +19,8 @@
 
 #include "base32.h"
 
+#define ERROR_SITE_FILE ERROR_SITE_FILE_BASE32
+
 WARN_UNUSED_RESULT
 error_t base32_encode(const uint8_t *data, int length, char *result, int buf_size) {
     int count = 0;
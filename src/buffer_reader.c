@@ -0,0 +1,104 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "buffer_reader.h"
+
+/**
+ * Read a varint of arbitrary encoded length, see reader_read_serde_uvarint which should be preferred, as it includes a
+ * fast path for single byte varints.
+ */
+uint32_t reader_read_serde_uvarint_multi_byte(buffer_reader_t *reader, uint8_t max_bits) {
+    if (max_bits == 0 || max_bits > 32) {
+        DEBUG_EMIT(if (!reader->has_error) PRINTF("Unsupported varint length\n");)
+        reader->has_error = true;
+        return 0;
+    }
+    // Each byte encodes 7 bits of the value, least significant group first, while the most significant bit of each byte
+    // is the continuation bit. The encoding of a type with max_bits bits is thus at most ceil(max_bits / 7) bytes long,
+    // for example 3 bytes for u16 and 5 bytes for u32, with the unused high bits of the last byte required to be 0.
+    uint32_t value = 0;
+    for (uint8_t shift = 0; ; shift += 7) {
+        uint8_t byte = reader_read_u8(reader);
+        if (reader->has_error) return 0;
+        uint8_t payload = byte & 0x7f;
+        // Check that the payload does not exceed max_bits. Note that shift < max_bits <= 32 is guaranteed by the
+        // continuation check below, such that neither shift is undefined behavior.
+        if (max_bits - shift < 7 && (payload >> (max_bits - shift))) {
+            PRINTF("Varint exceeds max bits\n");
+            reader->has_error = true;
+            return 0;
+        }
+        value |= ((uint32_t) payload) << shift;
+        if (!(byte & 0x80)) {
+            // This is the last byte. Reject non-canonical encodings with trailing zero groups, which postcard never
+            // generates, to ensure that a value has a unique encoding.
+            if (!payload && shift) {
+                PRINTF("Non-canonical varint\n");
+                reader->has_error = true;
+                return 0;
+            }
+            return value;
+        }
+        if (shift + 7 >= max_bits) {
+            PRINTF("Varint too long\n");
+            reader->has_error = true;
+            return 0;
+        }
+    }
+}
+
+/**
+ * Read a vector of bytes, compatible with serde / postcard serialization of a rust Vec<u8>. No copy of the data is
+ * created. Returns NULL for an empty vector or on error.
+ */
+uint8_t *reader_read_serde_vec_u8(buffer_reader_t *reader, uint16_t *out_data_length) {
+    // A Vec is represented as a seq by serde, see https://serde.rs/data-model.html#types, which in turn is encoded as a
+    // varint(usize) followed by the u8 data by postcard, see https://postcard.jamesmunns.com/wire-format.html#23---seq.
+    // While usize is typically 32 bit or 64 bit, see https://postcard.jamesmunns.com/wire-format.html#isize-and-usize,
+    // depending on the host size, we limit it to 16 bit here, as the memory of Ledger devices can't hold that long data
+    // anyway. The u8 data is stored as individual bytes, see https://postcard.jamesmunns.com/wire-format.html#7---u8.
+    // No risk of overflow, as we limit the reading of the uvarint to 16 bits.
+    *out_data_length = (uint16_t) reader_read_serde_uvarint(reader, 16);
+    uint8_t *data = reader_read_sub_buffer(reader, *out_data_length);
+    if (reader->has_error) {
+        *out_data_length = 0;
+    }
+    return data;
+}
+
+/**
+ * Read a bip32 path. The data is copied to the output. The output must have a size of at least MAX_BIP32_PATH_LENGTH.
+ */
+void reader_read_bip32_path(buffer_reader_t *reader, uint32_t *out_bip32_path, uint8_t *out_bip32_path_length) {
+    *out_bip32_path_length = reader_read_u8(reader);
+    if (*out_bip32_path_length < 1 || *out_bip32_path_length > MAX_BIP32_PATH_LENGTH) {
+        DEBUG_EMIT(if (!reader->has_error) PRINTF("Invalid bip32 path length\n");)
+        reader->has_error = true;
+        *out_bip32_path_length = 0;
+        return;
+    }
+    // Check the length of the entire path at once.
+    const uint8_t *path_data = reader_advance(reader, *out_bip32_path_length * 4);
+    if (!path_data) {
+        *out_bip32_path_length = 0;
+        return;
+    }
+    for (uint8_t i = 0; i < *out_bip32_path_length; i++, path_data += 4) {
+        out_bip32_path[i] = ((uint32_t) path_data[0] << 24) | ((uint32_t) path_data[1] << 16)
+            | ((uint32_t) path_data[2] << 8) | path_data[3];
+    }
+}
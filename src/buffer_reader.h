@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_BUFFER_READER_H_
+#define _NIMIQ_BUFFER_READER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "constants.h"
+#include "error_macros.h"
+
+/**
+ * A cursor for reading serialized data from a buffer.
+ *
+ * Each read checks the remaining length only once for the entire field and then loads the field directly from the
+ * buffer, instead of composing larger integers from individually bounds checked single bytes. Errors are sticky: once a
+ * read failed, because the buffer is too short, has_error is set, and all following reads fail as well and return 0 or
+ * NULL, without advancing the cursor. This way, a sequence of reads can be checked for errors just once at the end, or
+ * before a read value is used to make a decision, for example for selecting a type specific decoder. Note that read
+ * values must not be used, before has_error was checked.
+ */
+typedef struct {
+    uint8_t *position; // pointer to the next unread byte in the original buffer
+    uint16_t remaining_length;
+    bool has_error;
+} buffer_reader_t;
+
+static inline buffer_reader_t reader_init(uint8_t *buffer, uint16_t buffer_length) {
+    return (buffer_reader_t) {
+        .position = buffer,
+        .remaining_length = buffer_length,
+        .has_error = buffer == NULL && buffer_length != 0,
+    };
+}
+
+/**
+ * Advance the cursor by the given length, after a single check that the remaining buffer is long enough. Returns a
+ * pointer to the skipped data in the original buffer, or NULL on error, in which case the sticky error gets set.
+ */
+static inline uint8_t *reader_advance(buffer_reader_t *reader, uint16_t length) {
+    if (reader->has_error || reader->remaining_length < length) {
+        DEBUG_EMIT(if (!reader->has_error) PRINTF("Buffer too short\n");)
+        reader->has_error = true;
+        return NULL;
+    }
+    uint8_t *position = reader->position;
+    reader->position += length;
+    reader->remaining_length -= length;
+    return position;
+}
+
+/**
+ * Reads the leading part of the remaining buffer as pointer in the original buffer, and advances the cursor by the
+ * length of the sub buffer. Notably, no copy of the sub buffer is created. Returns NULL for an empty sub buffer or on
+ * error.
+ */
+static inline uint8_t *reader_read_sub_buffer(buffer_reader_t *reader, uint16_t sub_buffer_length) {
+    uint8_t *sub_buffer = reader_advance(reader, sub_buffer_length);
+    return sub_buffer_length ? sub_buffer : NULL;
+}
+
+static inline uint8_t reader_read_u8(buffer_reader_t *reader) {
+    const uint8_t *data = reader_advance(reader, 1);
+    return data ? data[0] : 0;
+}
+
+static inline uint16_t reader_read_u16(buffer_reader_t *reader) {
+    // Big endian.
+    const uint8_t *data = reader_advance(reader, 2);
+    return data ? (uint16_t) ((data[0] << 8) | data[1]) : 0;
+}
+
+static inline uint32_t reader_read_u32(buffer_reader_t *reader) {
+    // Big endian. Note that the data is not required to be memory aligned, therefore it's loaded byte by byte.
+    const uint8_t *data = reader_advance(reader, 4);
+    return data
+        ? ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3]
+        : 0;
+}
+
+static inline uint64_t reader_read_u64(buffer_reader_t *reader) {
+    // Big endian. Composed of two 32 bit words, which is cheaper on the 32 bit Ledger devices than shifting bytes into
+    // a 64 bit integer individually.
+    const uint8_t *data = reader_advance(reader, 8);
+    if (!data) return 0;
+    uint32_t high = ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+    uint32_t low = ((uint32_t) data[4] << 24) | ((uint32_t) data[5] << 16) | ((uint32_t) data[6] << 8) | data[7];
+    return ((uint64_t) high << 32) | low;
+}
+
+static inline bool reader_read_bool(buffer_reader_t *reader) {
+    return reader_read_u8(reader) != 0;
+}
+
+uint32_t reader_read_serde_uvarint_multi_byte(buffer_reader_t *reader, uint8_t max_bits);
+
+/**
+ * Read a varint compatible with serde / postcard serialization, see https://postcard.jamesmunns.com/wire-format.html,
+ * also called LEB, see https://en.wikipedia.org/wiki/LEB128. Note that this serialization format is different from, for
+ * example, Bitcoin's variable length integers. max_bits is the bit size of the serialized rust integer type, for
+ * example 16 for u16, or 32 for u32 or usize as we limit it to 32 bit. Values not fitting max_bits are rejected.
+ */
+static inline uint32_t reader_read_serde_uvarint(buffer_reader_t *reader, uint8_t max_bits) {
+    // Fast path for the common case of single byte varints, i.e. values up to 127, which is inlined.
+    if (max_bits >= 7 && !reader->has_error && reader->remaining_length && !(reader->position[0] & 0x80)) {
+        return reader_read_u8(reader);
+    }
+    return reader_read_serde_uvarint_multi_byte(reader, max_bits);
+}
+
+uint8_t *reader_read_serde_vec_u8(buffer_reader_t *reader, uint16_t *out_data_length);
+
+void reader_read_bip32_path(buffer_reader_t *reader, uint32_t *out_bip32_path, uint8_t *out_bip32_path_length);
+
+#endif // _NIMIQ_BUFFER_READER_H_
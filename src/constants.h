@@ -54,8 +54,9 @@
 // to added sender data and uint64 timestamps instead of uint32 block counts in vesting and htlc contracts. Sum of:
 // - Minimum of 67 bytes common to all transactions for recipient data length, sender address, sender type, recipient
 //   address, recipient type, value, fee, validity start height, network id, flags, sender data length (assuming sender
-//   data length being encoded in a single byte varint, i.e. sender data up to 127 bytes length), recipient data length.
-// - Sender or recipient data of up to 121 bytes. Note that currently, we don't support sender data and recipient data
+//   data length being encoded in a single byte varint, i.e. sender data up to 127 bytes length; longer sender data is
+//   encoded as multi-byte varint which is supported by the parser), recipient data length.
+// - Sender or recipient data of up to 189 bytes. Note that currently, we don't support sender data and recipient data
 //   to be set at the same time. This number is the maximum of:
 //   1 byte sender data for OutgoingStakingTransactionData.
 //   64 bytes recipient data limit we set for basic transactions.
@@ -65,14 +66,47 @@
 //     120 bytes for fully specified CreateStaker with ed25519 signature proof with empty merkle path.
 //     21 bytes for AddStake.
 //     121 bytes for fully specified UpdateStaker with ed25519 signature proof with empty merkle path.
+//     Signature proofs of multisig stakers have a non-empty merkle path, which adds 32 bytes per node plus one byte
+//     per 8 nodes. With a MAX_RAW_TX of 256 bytes, paths of up to 2 nodes fit, i.e. multisigs of up to 4 signer
+//     combinations, for example 2-of-3. With 640 bytes, paths of up to 14 nodes fit.
 //     107 bytes for SetActiveStake.
 //     107 bytes for RetireStake.
-//     (Validator transactions are not covered yet, as not supported yet.)
-#define MAX_RAW_TX 188
-// Limit printable message length as Nano S has only about 4kB of RAM total, used for global vars and stack, and on top
-// of the message buffer, there is the buffer for the printed message, which is twice as large, see messageSigningContext_t
-// in globals.h Additionally, the paging ui displays only ~16 chars per page on Nano S.
-#define MAX_PRINTABLE_MESSAGE_LENGTH 160 // 10+ pages ascii or 20 pages hex on Nano S
+//     119 bytes for DeactivateValidator and ReactivateValidator and 99 bytes for RetireValidator.
+//     Up to 189 bytes for UpdateValidator without new voting key and proof of knowledge.
+//     CreateValidator (532 or 564 bytes) and UpdateValidator with a new voting key and proof of knowledge (at least 484
+//     bytes), due to the size of the BLS voting key (285 bytes) and proof of knowledge (95 bytes). These are supported
+//     in full on devices with a MAX_RAW_TX of at least 631 bytes, see below. Otherwise, they're only supported in
+//     streamed signing mode, see handle_sign_transaction in main.c, in which these fields are not kept in the raw
+//     transaction buffer, such that 184 bytes remain for CreateValidator, and still up to 189 bytes for UpdateValidator.
+// Shorter transactions leave headroom, for example for sender data of more than 127 bytes, which is encoded with a
+// multi-byte varint.
+//
+// The limits for the raw transaction and the printable message determine the size of the largest request contexts, see
+// generalContext_t in globals.h. They are set per device, based on the following RAM budget model: the app's RAM holds
+// the SDK's globals, the io and ux buffers, the stack, and the app's own globals, of which the general context with the
+// request memory is by far the largest part. The general context may occupy at most GENERAL_CONTEXT_RAM_BUDGET bytes,
+// which leaves the remaining RAM of each device to the stack and the other globals. This is checked at compile time in
+// globals.c.
+// - Nano X has the least RAM of the supported devices, part of which is additionally used by the Bluetooth stack. Its
+//   limits stay close to the ones originally chosen for the Nano S, which had only about 4kB of RAM in total.
+// - Nano S+ has more RAM, such that validator transactions fit entirely, and longer messages can be displayed. The
+//   message length is still limited by the number of pages the paging ui of Nano devices displays at ~16 chars each.
+// - Stax, Flex and Apex P have the most RAM, and display messages on pages of multiple lines.
+// On Nano devices, printed messages occupy twice the printable message length in the request arena, for display as hex,
+// see messageSigningContext_t in globals.h. NBGL devices print messages in parts, independent of the message length.
+#if defined(TARGET_STAX) || defined(TARGET_FLEX) || defined(TARGET_APEX_P)
+#define GENERAL_CONTEXT_RAM_BUDGET 4096
+#define MAX_RAW_TX 640
+#define MAX_PRINTABLE_MESSAGE_LENGTH 1024
+#elif defined(TARGET_NANOS2)
+#define GENERAL_CONTEXT_RAM_BUDGET 2048
+#define MAX_RAW_TX 640
+#define MAX_PRINTABLE_MESSAGE_LENGTH 320 // 20+ pages ascii or 40 pages hex
+#else // Nano X and unit tests
+#define GENERAL_CONTEXT_RAM_BUDGET 1536
+#define MAX_RAW_TX 256
+#define MAX_PRINTABLE_MESSAGE_LENGTH 160 // 10+ pages ascii or 20 pages hex
+#endif
 
 typedef enum {
     TRANSACTION_VERSION_LEGACY,
@@ -112,6 +146,12 @@ typedef enum {
     TRANSACTION_LABEL_TYPE_STAKING_SET_ACTIVE_STAKE,
     TRANSACTION_LABEL_TYPE_STAKING_RETIRE_STAKE,
     TRANSACTION_LABEL_TYPE_STAKING_REMOVE_STAKE,
+    TRANSACTION_LABEL_TYPE_STAKING_CREATE_VALIDATOR,
+    TRANSACTION_LABEL_TYPE_STAKING_UPDATE_VALIDATOR,
+    TRANSACTION_LABEL_TYPE_STAKING_DEACTIVATE_VALIDATOR,
+    TRANSACTION_LABEL_TYPE_STAKING_REACTIVATE_VALIDATOR,
+    TRANSACTION_LABEL_TYPE_STAKING_RETIRE_VALIDATOR,
+    TRANSACTION_LABEL_TYPE_STAKING_DELETE_VALIDATOR,
 } transaction_label_type_t;
 
 // Recipient data type for incoming transactions to the staking contract.
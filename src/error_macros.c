@@ -17,6 +17,9 @@
 
 #include "error_macros.h"
 
+// Specified in error_macros.h
+uint16_t G_error_site;
+
 sw_t error_to_sw(error_t error) {
     switch (error) {
         case ERROR_READ: // Assume that the read error is due to too short data, which is the most common reason.
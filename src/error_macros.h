@@ -18,15 +18,67 @@
 #ifndef _NIMIQ_ERROR_MACROS_H_
 #define _NIMIQ_ERROR_MACROS_H_
 
+#if !defined(TEST) || !TEST
 #include "ledger_assert.h" // For LEDGER_ASSERT in ON_ERROR, ERROR_TO_SW, and files that include error_macros.h
+#endif // !TEST
 
 #include "constants.h" // For error_t and sw_t
 #include "utility_macros.h" // For VA_ARGS_* and DEBUG_EMIT macros
+#include "trace.h" // For TRACE of errors in debug builds
 
 #if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+#include <stdbool.h> // for bool used in debug expression sanity check in ON_ERROR
 #include <string.h> // for strstr used in debug expression sanity check in ON_ERROR
 #endif
 
+/**
+ * Source files, in which errors can originate, for compact error site ids. Each source file which uses the error macros
+ * defines ERROR_SITE_FILE as its entry. The values are part of the error site ids reported to the host and must
+ * therefore not be reassigned. New files are appended at the end.
+ */
+typedef enum: uint8_t {
+    ERROR_SITE_FILE_BASE32 = 1,
+    ERROR_SITE_FILE_MAIN = 2,
+    ERROR_SITE_FILE_NIMIQ_STAKING_UTILS = 3,
+    ERROR_SITE_FILE_NIMIQ_UTILS = 4,
+    ERROR_SITE_FILE_PRINTING = 5,
+    ERROR_SITE_FILE_SIGNATURE_PROOF = 6,
+    ERROR_SITE_FILE_STREAMED_SIGNING = 7,
+    ERROR_SITE_FILE_USER_FRIENDLY_ADDRESS = 8,
+    ERROR_SITE_FILE_TIMING = 9,
+} error_site_file_t;
+
+/**
+ * Compact 16 bit id of the source location of an error macro, which is determined at compile time. The upper 5 bits are
+ * the ERROR_SITE_FILE of the source file, and the lower 11 bits the line in that file, which is the line PRINTed in
+ * debug builds.
+ */
+#define ERROR_SITE_LINE_BITS 11
+#define ERROR_SITE_ID ((uint16_t) ((ERROR_SITE_FILE << ERROR_SITE_LINE_BITS) | __LINE__))
+
+#if !defined(TEST) || !TEST
+/**
+ * Id of the error site, where the error of the current or, if queried via INS_GET_ERROR_SITE, the previous request
+ * originated; 0 if no error occurred. Also in production builds, this allows to map an error returned to the host back
+ * to the exact check that failed. Only the first error site per request is recorded, which is the origin of an error
+ * that is then forwarded via RETURN_ON_ERROR through the call stack. Reset for each request in nimiq_main. Declared in
+ * error_macros.c.
+ */
+extern uint16_t G_error_site;
+
+/**
+ * Record the current error site, unless an error site was already recorded for the current request. Only used within
+ * the error branches of the error macros, such that it adds no cost when no error occurs.
+ */
+#define RECORD_ERROR_SITE() \
+    do { \
+        _Static_assert(__LINE__ < (1 << ERROR_SITE_LINE_BITS), "Line exceeds the error site id range\n"); \
+        if (!G_error_site) G_error_site = ERROR_SITE_ID; \
+    } while (0)
+#else
+#define RECORD_ERROR_SITE() do {} while (0)
+#endif // !TEST
+
 /**
  * Return from the current function with an error code and print debug messages.
  *
@@ -39,9 +91,12 @@
  */
 #define RETURN_ERROR(error, message, ...) \
     do { \
-        PRINTF("    !!! Error 0x%02x returned in %s (file %s, line %d)\n", error, __func__, __FILE__, __LINE__); \
-        PRINTF("        "); \
-        PRINTF(message __VA_OPT__(,) __VA_ARGS__); \
+        VERBOSE_PRINTF("    !!! Error 0x%02x returned in %s (file %s, line %d)\n", error, __func__, __FILE__, \
+            __LINE__); \
+        VERBOSE_PRINTF("        "); \
+        VERBOSE_PRINTF(message __VA_OPT__(,) __VA_ARGS__); \
+        TRACE(TRACE_EVENT_ERROR, 0, ERROR_SITE_ID, (uint32_t) (error)); \
+        RECORD_ERROR_SITE(); \
         return (error); \
     } while(0)
 
@@ -57,11 +112,11 @@
  *     can be used.
  * Second and following optional parameters: a debug message and parameters to pass to PRINTF.
  *
- * Note: while this macro looks like it's injecting a lot of code (which would bloat the app binary), all the PRINTFs
- * and the sanity check are not included in production builds. Additionally, the compiler might be able to optimize
- * variables received_error and error away (both are const, and if a custom error is passed, both are set and read only
- * once (depending on statements), and if no custom error is passed, error will always get the same value as
- * received_error).
+ * Note: while this macro looks like it's injecting a lot of code (which would bloat the app binary), all the PRINTFs,
+ * the trace and the sanity check are not included in production builds, which only record the error site. Additionally,
+ * the compiler might be able to optimize variables received_error and error away (both are const, and if a custom error
+ * is passed, both are set and read only once (depending on statements), and if no custom error is passed, error will
+ * always get the same value as received_error).
  */
 #define ON_ERROR(expression, statements, ...) \
     do { \
@@ -92,13 +147,14 @@
         }) \
         const error_t received_error = (expression); \
         if (received_error) { \
-            PRINTF("    !!! Error 0x%02x returned by %s in %s (file %s, line %d)\n", received_error, #expression, \
-                __func__, __FILE__, __LINE__); \
+            VERBOSE_PRINTF("    !!! Error 0x%02x returned by %s in %s (file %s, line %d)\n", received_error, \
+                #expression, __func__, __FILE__, __LINE__); \
             /* Print custom debug message if passed as second and following optional arguments. */ \
             VA_ARGS_IF_NOT_EMPTY_EMIT( \
-                { PRINTF("        "); PRINTF(VA_ARGS_OMIT_FIRST(__VA_ARGS__)); }, \
+                { VERBOSE_PRINTF("        "); VERBOSE_PRINTF(VA_ARGS_OMIT_FIRST(__VA_ARGS__)); }, \
                 VA_ARGS_OMIT_FIRST(__VA_ARGS__) \
             ) \
+            RECORD_ERROR_SITE(); \
             /* Assign received_error or, if passed, custom error to error. */ \
             /* No curly braces around the assignment, to avoid it being scoped to a separate scope. */ \
             /* Silence warning regarding unused variable, as the statements are not required to use variable error, */ \
@@ -114,6 +170,7 @@
                 VA_ARGS_PICK_FIRST(__VA_ARGS__) \
             ) \
             _Pragma("GCC diagnostic pop") \
+            TRACE(TRACE_EVENT_ERROR, 0, ERROR_SITE_ID, (uint32_t) error); \
             /* Run specified statements. */ \
             { statements } \
         } \
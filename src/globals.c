@@ -31,3 +31,5 @@ bolos_ux_params_t G_ux_params;
 // Specified in globals.h
 const internal_storage_t N_storage_real; // const variable in flash storage; writable via nvm_write
 generalContext_t ctx;
+// See the RAM budget model in constants.h.
+_Static_assert(sizeof(generalContext_t) <= GENERAL_CONTEXT_RAM_BUDGET, "General context exceeds the RAM budget\n");
@@ -27,6 +27,8 @@
 #include "constants.h"
 #include "utility_macros.h"
 #include "nimiq_utils.h"
+#include "request_arena.h"
+#include "streamed_signing.h"
 
 /**
  * Global structure for NVM data storage.
@@ -53,51 +55,109 @@ typedef struct transactionContext_t {
     transaction_version_t transactionVersion;
     uint8_t rawTx[MAX_RAW_TX];
     uint32_t rawTxLength;
+    tx_parser_state_t parser;
     parsed_tx_t parsed;
+    // Only used in streamed signing mode, see handle_sign_transaction. The voting key hash context and fingerprint are
+    // allocated in the request arena, like the hash contexts of streamedSigning.
+    streamed_signing_state_t streamedSigning;
+    cx_blake2b_t *streamedVotingKeyHashContext;
+    uint8_t *streamedVotingKeyFingerprint;
 } transactionContext_t;
 
-// Printed message buffer length dimension chosen such that it can hold the printed uint32 message length
+// Transaction values are printed on demand into the request arena, see ux_transaction_print_entry. On BAGL devices only
+// a single value is displayed at a time, which is printed when its ui step is initialized, such that the arena needs to
+// hold only the longest value of a transaction type. NBGL reviews are streamed in batches of entries, which reference
+// all their values at once, which is why the arena has to hold all printed values of a batch there. A batch is closed
+// once the next value exceeds the batch budget, see nimiq_ux_nbgl.c. Constant strings like the network name are not
+// printed on NBGL. The budgets are checked against the available arena memory at compile time in request_arena.c.
+#ifdef HAVE_NBGL
+// The longest printed transaction values are the data of normal transactions, and HTLC hash roots.
+#define REVIEW_ENTRY_MAX_PRINTED_LENGTH MAX(STRING_LENGTH_NORMAL_TX_DATA_MAX, STRING_LENGTH_HTLC_HASH_ROOT)
+// Fits the printed values of all common transactions in a single batch, which take less than 300 bytes, and messages of
+// up to 1024 characters as ascii.
+#define REVIEW_BATCH_ARENA_BUDGET (8 * REVIEW_ENTRY_MAX_PRINTED_LENGTH)
+// Transaction values are printed before checking them against the batch budget, which requires space for one more.
+#define TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING (REVIEW_BATCH_ARENA_BUDGET + REVIEW_ENTRY_MAX_PRINTED_LENGTH)
+#define TX_ARENA_BUDGET_STAKING_INCOMING TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING
+#define TX_ARENA_BUDGET_HTLC_CREATION TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING
+#define TX_ARENA_BUDGET_VESTING_CREATION TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING
+#else
+// The longest values per transaction type. Also the transaction label is printed into the arena, which is shorter.
+#define TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING STRING_LENGTH_NORMAL_TX_DATA_MAX
+#define TX_ARENA_BUDGET_STAKING_INCOMING MAX(STRING_LENGTH_NIM_AMOUNT_WITH_TICKER, \
+    MAX(STRING_LENGTH_USER_FRIENDLY_ADDRESS, STRING_LENGTH_VALIDATOR_KEY_OR_HASH))
+#define TX_ARENA_BUDGET_HTLC_CREATION STRING_LENGTH_HTLC_HASH_ROOT
+#define TX_ARENA_BUDGET_VESTING_CREATION MAX(STRING_LENGTH_NIM_AMOUNT_WITH_TICKER, STRING_LENGTH_USER_FRIENDLY_ADDRESS)
+#endif
+// While a transaction is received in streamed signing mode, the arena holds the hash contexts of the signature, and the
+// hash context and result of the voting key fingerprint. They're not needed anymore during the review.
+#define TX_ARENA_BUDGET_STREAMED_SIGNING (STREAMED_SIGNING_ARENA_BUDGET \
+    + REQUEST_ARENA_ALIGN(sizeof(cx_blake2b_t)) + 32)
+#define TX_ARENA_BUDGET MAX( \
+    MAX(TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING, TX_ARENA_BUDGET_STAKING_INCOMING), \
+    MAX(MAX(TX_ARENA_BUDGET_HTLC_CREATION, TX_ARENA_BUDGET_VESTING_CREATION), TX_ARENA_BUDGET_STREAMED_SIGNING) \
+)
+
+// Printed message length dimension chosen such that it can hold the printed uint32 message length
 // (STRING_LENGTH_UINT32 (11) bytes), the message printed as hash (32 byte hash as hex + string terminator = 65 bytes),
-// ascii (1 char per byte + string terminator) or hex (2 char per byte + string terminator).
-#define PRINTED_MESSAGE_BUFFER_LENGTH (MAX_PRINTABLE_MESSAGE_LENGTH * 2 + 1)
+// ascii (1 char per byte + string terminator) or hex (2 char per byte + string terminator). Only BAGL devices print the
+// whole message at once, while NBGL reviews print it in parts per review batch, see ui_message_add_review_entries.
+#define PRINTED_MESSAGE_MAX_LENGTH (MAX_PRINTABLE_MESSAGE_LENGTH * 2 + 1)
 typedef struct messageSigningContext_t {
     uint32_t bip32Path[MAX_BIP32_PATH_LENGTH];
     // nimiq supports signing data of arbitrary length, but for now we restrict the length in the ledger app to uint32_t
     uint32_t messageLength;
     uint32_t processedMessageLength;
-    union {
-        // the memory is specifically aligned such that messageHashContext and prefixedMessageHashContext do not overlap
-        // with messageHash and prefxedMessageHash, see _Static_assert in handleSignMessage.
-        struct {
-            cx_sha256_t messageHashContext;
-            cx_sha256_t prefixedMessageHashContext;
-        } prepare;
-        struct {
-            message_display_type_t displayType;
-            char printedMessageLabel[MAX(sizeof("Message"), MAX(sizeof("Message Hex"), sizeof("Message Hash")))];
-            char printedMessage[PRINTED_MESSAGE_BUFFER_LENGTH];
-            uint8_t messageHash[32];
-            uint8_t prefixedMessageHash[32];
-        } confirm;
-    };
+    // The hash contexts are only needed while the message is received, and are allocated in the request arena, which is
+    // later reused for the printed message.
+    cx_sha256_t *messageHashContext;
+    cx_sha256_t *prefixedMessageHashContext;
+    uint8_t messageHash[32];
+    uint8_t prefixedMessageHash[32];
+    message_display_type_t displayType;
     uint8_t printableMessage[MAX_PRINTABLE_MESSAGE_LENGTH];
     bool isPrintableAscii;
     uint8_t bip32PathLength;
     uint8_t flags;
 } messageSigningContext_t;
 
+// The message arena holds either both hash contexts, or the printed message, or on NBGL the printed message part of a
+// review batch and its numbered label, e.g. "Message Hex (2/2)".
+#ifdef HAVE_NBGL
+#define STRING_LENGTH_MESSAGE_PART_LABEL sizeof("Message Hash (255/255)")
+#define MESSAGE_ARENA_BUDGET MAX(2 * REQUEST_ARENA_ALIGN(sizeof(cx_sha256_t)), \
+    REVIEW_BATCH_ARENA_BUDGET + STRING_LENGTH_MESSAGE_PART_LABEL)
+#else
+#define MESSAGE_ARENA_BUDGET MAX(2 * REQUEST_ARENA_ALIGN(sizeof(cx_sha256_t)), \
+    REQUEST_ARENA_ALIGN(PRINTED_MESSAGE_MAX_LENGTH))
+#endif
+
+// Memory shared by the contexts of the different request types, which each are followed by their request arena.
+#define REQUEST_MEMORY_SIZE MAX(sizeof(publicKeyContext_t), MAX( \
+    REQUEST_ARENA_ALIGN(sizeof(transactionContext_t)) + TX_ARENA_BUDGET, \
+    REQUEST_ARENA_ALIGN(sizeof(messageSigningContext_t)) + MESSAGE_ARENA_BUDGET \
+))
+
 typedef struct {
     union {
         publicKeyContext_t pk;
         transactionContext_t tx;
         messageSigningContext_t msg;
+        uint8_t memory[REQUEST_MEMORY_SIZE];
     } req;
+    request_arena_t arena;
     uint16_t u2fTimer;
 } generalContext_t;
 
 // extern variable, shared across .c files. Declared in globals.c
 extern generalContext_t ctx;
 
+// Start of the request arena following the given request context. This is a constant address, which can for example be
+// used in the constant step definitions of BAGL ui flows, and is the address of the first allocation after a reset or
+// request_arena_free_all.
+#define REQUEST_ARENA_START(context_type) \
+    ((char *) ctx.req.memory + REQUEST_ARENA_ALIGN(sizeof(context_type)))
+
 // Shortcuts for parsed transaction data
 #define PARSED_TX (ctx.req.tx.parsed)
 #define PARSED_TX_NORMAL_OR_STAKING_OUTGOING (PARSED_TX.type_specific.normal_or_staking_outgoing_tx)
@@ -28,7 +28,15 @@
 #include "globals.h"
 #include "error_macros.h"
 #include "nimiq_utils.h"
+#include "buffer_reader.h"
+#include "streamed_signing.h"
 #include "nimiq_ux.h"
+#include "stack_usage.h"
+#include "timing.h"
+#include "trace.h"
+#include "user_friendly_address.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_MAIN
 
 #define CLA 0xE0
 // Defined instructions.
@@ -40,14 +48,26 @@
 // #define INS_GET_APP_CONFIGURATION 0x06 // was removed, but still listing it here to avoid assigning the same value
 #define INS_KEEP_ALIVE 0x08
 #define INS_SIGN_MESSAGE 0x0A
+#define INS_GET_ERROR_SITE 0x0C
+#define INS_GET_STACK_USAGE 0x0E // only supported in debug builds
+#define INS_GET_TIMINGS 0x10 // only supported in debug builds
+#define INS_BENCHMARK 0x12 // only supported in debug builds
+#define INS_GET_TRACE 0x14 // only supported in debug builds
 #define P1_NO_SIGNATURE 0x00
 #define P1_SIGNATURE 0x01
 #define P2_NO_CONFIRM 0x00
 #define P2_CONFIRM 0x01
 #define P1_FIRST 0x00
 #define P1_MORE 0x80
+// Modes of transaction signing, which are combined with P1_FIRST or P1_MORE; see handle_sign_transaction.
+#define P1_STREAMED_FIRST_PASS 0x01
+#define P1_STREAMED_SECOND_PASS 0x02
 #define P2_LAST 0x00
 #define P2_MORE 0x80
+#define P1_KEEP_STACK_USAGE 0x00
+#define P1_RESET_STACK_USAGE 0x01
+#define P1_KEEP_TIMINGS 0x00
+#define P1_RESET_TIMINGS 0x01
 
 #define OFFSET_CLA 0
 #define OFFSET_INS 1
@@ -80,6 +100,7 @@ static void io_finalize_async_reply(uint8_t *data, uint16_t data_length, sw_t sw
     // Append status word
     G_io_apdu_buffer[data_length] = (uint8_t) (sw >> 8);
     G_io_apdu_buffer[data_length + 1] = (uint8_t) (sw);
+    TRACE(TRACE_EVENT_APDU_RESPONSE, /* async reply sent */ 2, G_error_site, sw);
     // Send APDU with flag IO_RETURN_AFTER_TX, in response to a previous call with IO_ASYNCH_REPLY. Note that an
     // io_exchange call with IO_ASYNCH_REPLY skips sending any data, which we now make up for by submitting the data at
     // a later time. On the other hand, IO_RETURN_AFTER_TX returns after the data transmission, and skips waiting for a
@@ -90,11 +111,20 @@ static void io_finalize_async_reply(uint8_t *data, uint16_t data_length, sw_t sw
 }
 
 void on_rejected() {
-    PRINTF("User rejected the request.\n");
+    STACK_USAGE_BEGIN(STACK_USAGE_SLOT_ON_REJECTED);
+    TRACE(TRACE_EVENT_ON_REJECTED, 0, 0, 0);
+    TIMING_REVIEW_END();
+    TIMING_START(callback_start);
     io_finalize_async_reply(NULL, 0, SW_DENY);
+    TIMING_RECORD(TIMING_STAGE_UX_CALLBACK, callback_start);
+    STACK_USAGE_END();
 }
 
 void on_address_approved() {
+    STACK_USAGE_BEGIN(STACK_USAGE_SLOT_ON_ADDRESS_APPROVED);
+    TRACE(TRACE_EVENT_ON_ADDRESS_APPROVED, 0, 0, 0);
+    TIMING_REVIEW_END();
+    TIMING_START(callback_start);
     sw_t sw = SW_OK;
     uint16_t data_length = 0;
     ON_ERROR(
@@ -102,15 +132,31 @@ void on_address_approved() {
         { sw = ERROR_TO_SW(); }
     );
     io_finalize_async_reply(G_io_apdu_buffer, data_length, sw);
+    TIMING_RECORD(TIMING_STAGE_UX_CALLBACK, callback_start);
+    STACK_USAGE_END();
 }
 
 void on_transaction_approved() {
+    STACK_USAGE_BEGIN(STACK_USAGE_SLOT_ON_TRANSACTION_APPROVED);
+    TRACE(TRACE_EVENT_ON_TRANSACTION_APPROVED, 0, 0, 0);
+    TIMING_REVIEW_END();
+    TIMING_START(callback_start);
     sw_t sw = SW_OK;
     uint16_t data_length = 0;
 
+    if (ctx.req.tx.streamedSigning.stage == STREAMED_SIGNING_STAGE_REVIEW) {
+        // In streamed signing mode, the signature is only created in the second pass, which is now unlocked.
+        ctx.req.tx.streamedSigning.stage = STREAMED_SIGNING_STAGE_APPROVED;
+        io_finalize_async_reply(NULL, 0, SW_OK);
+        TIMING_RECORD(TIMING_STAGE_UX_CALLBACK, callback_start);
+        STACK_USAGE_END();
+        return;
+    }
+
     // initialize private key
     uint8_t privateKeyData[64]; // the private key is only 32 bytes, but os_derive_bip32_with_seed_no_throw expects 64
     cx_ecfp_256_private_key_t privateKey;
+    TIMING_START(derive_start);
     GOTO_ON_ERROR(
         os_derive_bip32_with_seed_no_throw(
             /* derivation mode */ HDW_ED25519_SLIP10,
@@ -133,6 +179,7 @@ void on_transaction_approved() {
         SW_CRYPTOGRAPHY_FAIL,
         "Failed to derive private key\n"
     );
+    TIMING_RECORD(TIMING_STAGE_DERIVE_KEY, derive_start);
     // The private key data is also cleared at the end, but for extra paranoia, clear it as soon as possible.
     explicit_bzero(privateKeyData, sizeof(privateKeyData));
 
@@ -156,6 +203,7 @@ void on_transaction_approved() {
         // what the staker signatue must sign. Write the signature to a temporary buffer, instead of directly to the
         // signature proof, to avoid writing to the data that is currently being signed. To save some stack space, we
         // use G_io_apdu_buffer as that temporary buffer.
+        TIMING_START(sign_start);
         GOTO_ON_ERROR(
             // As specified in datatracker.ietf.org/doc/html/rfc8032#section-5.1.6, we're using CX_SHA512 as internal
             // hash algorithm for the ed25519 signature. According to the specification, there is no length restriction
@@ -173,6 +221,7 @@ void on_transaction_approved() {
             SW_CRYPTOGRAPHY_FAIL,
             "Failed to sign\n"
         );
+        TIMING_RECORD(TIMING_STAGE_SIGN, sign_start);
         // Overwrite the signature in the signature proof in rawTx via pointers in validator_or_staker_signature_proof
         // which point to the original buffer.
         memmove(PARSED_TX_STAKING_INCOMING.validator_or_staker_signature_proof.signature, G_io_apdu_buffer, 64);
@@ -181,6 +230,7 @@ void on_transaction_approved() {
         // Similarly, overwrite the public key in the signature proof with the ledger account public key as staker, with
         // G_io_apdu_buffer as temporary buffer again.
         DECLARE_TEMPORARY_G_IO_APDU_BUFFER_POINTER(cx_ecfp_256_public_key_t *, temporary_public_key_pointer);
+        TIMING_START(generate_start);
         GOTO_ON_ERROR(
             cx_ecfp_generate_pair_no_throw(
                 /* curve */ CX_CURVE_Ed25519,
@@ -193,6 +243,7 @@ void on_transaction_approved() {
             SW_CRYPTOGRAPHY_FAIL,
             "Failed to generate public key\n"
         );
+        TIMING_RECORD(TIMING_STAGE_GENERATE_PUBLIC_KEY, generate_start);
         // copy public key little endian to big endian
         for (uint8_t i = 0; i < 32; i++) {
             PARSED_TX_STAKING_INCOMING.validator_or_staker_signature_proof.public_key[i] =
@@ -206,6 +257,7 @@ void on_transaction_approved() {
     // Create final transaction signature.
     // Note that we only generate the signature here. It's the calling library's responsibility to build an appropriate
     // signature proof or contract proof out of this signature, depending on the sender type.
+    TIMING_START(sign_start);
     GOTO_ON_ERROR(
         // As specified in datatracker.ietf.org/doc/html/rfc8032#section-5.1.6, we're using CX_SHA512 as internal
         // hash algorithm for the ed25519 signature. According to the specification, there is no length restriction
@@ -223,6 +275,7 @@ void on_transaction_approved() {
         SW_CRYPTOGRAPHY_FAIL,
         "Failed to sign\n"
     );
+    TIMING_RECORD(TIMING_STAGE_SIGN, sign_start);
     data_length = 64;
 
     if (created_staker_signature) {
@@ -239,9 +292,15 @@ end:
     explicit_bzero(privateKeyData, sizeof(privateKeyData));
     explicit_bzero(&privateKey, sizeof(privateKey));
     io_finalize_async_reply(G_io_apdu_buffer, data_length, sw);
+    TIMING_RECORD(TIMING_STAGE_UX_CALLBACK, callback_start);
+    STACK_USAGE_END();
 }
 
 void on_message_approved() {
+    STACK_USAGE_BEGIN(STACK_USAGE_SLOT_ON_MESSAGE_APPROVED);
+    TRACE(TRACE_EVENT_ON_MESSAGE_APPROVED, 0, 0, 0);
+    TIMING_REVIEW_END();
+    TIMING_START(callback_start);
     sw_t sw = SW_OK;
     uint16_t data_length = 64; // Response is a single signature, which fits a single APDU response.
 
@@ -272,8 +331,8 @@ void on_message_approved() {
         || cx_eddsa_sign_no_throw(
             /* private key */ &privateKey,
             /* hash id */ CX_SHA512,
-            /* hash */ ctx.req.msg.confirm.prefixedMessageHash,
-            /* hash length */ sizeof(ctx.req.msg.confirm.prefixedMessageHash),
+            /* hash */ ctx.req.msg.prefixedMessageHash,
+            /* hash length */ sizeof(ctx.req.msg.prefixedMessageHash),
             /* out */ G_io_apdu_buffer,
             /* out length */ 64
         ),
@@ -288,10 +347,12 @@ void on_message_approved() {
     explicit_bzero(&privateKey, sizeof(privateKey));
 
     io_finalize_async_reply(G_io_apdu_buffer, data_length, sw);
+    TIMING_RECORD(TIMING_STAGE_UX_CALLBACK, callback_start);
+    STACK_USAGE_END();
 }
 
 void u2f_send_keep_alive() {
-    PRINTF("Send U2F heartbeat\n");
+    TRACE(TRACE_EVENT_KEEP_ALIVE_SENT, 0, 0, 0);
     ctx.u2fTimer = 0;
     io_finalize_async_reply(NULL, 0, SW_KEEP_ALIVE);
 }
@@ -342,12 +403,16 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
         "Invalid P1 or P2\n"
     );
 
+    // The public key context overwrites the context of any other request, which must not be continued anymore.
+    request_arena_reset(INS_GET_PUBLIC_KEY, sizeof(ctx.req.pk));
     ctx.req.pk.returnSignature = (p1 == P1_SIGNATURE);
 
+    buffer_reader_t reader = reader_init(data_buffer, data_length);
     uint32_t bip32Path[MAX_BIP32_PATH_LENGTH];
     uint8_t bip32PathLength;
+    reader_read_bip32_path(&reader, bip32Path, &bip32PathLength);
     GOTO_ON_ERROR(
-        !read_bip32_path(&data_buffer, &data_length, bip32Path, &bip32PathLength),
+        reader.has_error,
         end,
         sw,
         SW_WRONG_DATA_LENGTH
@@ -361,15 +426,16 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
     uint8_t *msg = NULL;
     if (ctx.req.pk.returnSignature) {
         GOTO_ON_ERROR(
-            data_length > 31,
+            reader.remaining_length > 31,
             end,
             sw,
             SW_INCORRECT_DATA,
             "Verification message to sign must not exceed 31 bytes\n"
         );
-        msgLength = (uint8_t) data_length;
+        msgLength = (uint8_t) reader.remaining_length;
+        msg = reader_read_sub_buffer(&reader, msgLength);
         GOTO_ON_ERROR(
-            !read_sub_buffer(data_length, &data_buffer, &data_length, &msg),
+            reader.has_error,
             end,
             sw,
             SW_WRONG_DATA_LENGTH
@@ -384,13 +450,14 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
     }
 
     GOTO_ON_ERROR(
-        data_length != 0,
+        reader.remaining_length != 0,
         end,
         sw,
         SW_WRONG_DATA_LENGTH,
         "INS_GET_PUBLIC_KEY instruction data too long\n"
     );
 
+    TIMING_START(derive_start);
     GOTO_ON_ERROR(
         os_derive_bip32_with_seed_no_throw(
             /* derivation mode */ HDW_ED25519_SLIP10,
@@ -413,9 +480,11 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
         SW_CRYPTOGRAPHY_FAIL,
         "Failed to derive private key\n"
     );
+    TIMING_RECORD(TIMING_STAGE_DERIVE_KEY, derive_start);
     // The private key data is also cleared at the end, but for extra paranoia, clear it as soon as possible.
     explicit_bzero(privateKeyData, sizeof(privateKeyData));
 
+    TIMING_START(generate_start);
     GOTO_ON_ERROR(
         cx_ecfp_generate_pair_no_throw(
             /* curve */ CX_CURVE_Ed25519,
@@ -428,7 +497,9 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
         SW_CRYPTOGRAPHY_FAIL,
         "Failed to generate public key\n"
     );
+    TIMING_RECORD(TIMING_STAGE_GENERATE_PUBLIC_KEY, generate_start);
     if (ctx.req.pk.returnSignature && msg) {
+        TIMING_START(sign_start);
         GOTO_ON_ERROR(
             cx_eddsa_sign_no_throw(
                 /* private key */ &privateKey,
@@ -443,6 +514,7 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
             SW_CRYPTOGRAPHY_FAIL,
             "Failed to sign\n"
         );
+        TIMING_RECORD(TIMING_STAGE_SIGN, sign_start);
     }
     // The private key is also cleared at the end, but for extra paranoia, clear it as soon as possible.
     explicit_bzero(&privateKey, sizeof(privateKey));
@@ -466,7 +538,9 @@ sw_t handle_get_public_key(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_
             "Failed to print public key\n"
         );
 
+        TIMING_START(ui_start);
         ui_public_key();
+        TIMING_RECORD(TIMING_STAGE_UI_INIT, ui_start);
         *out_start_async_reply = true;
     } else {
         // Sync request, in which the public key is returned without any user interaction.
@@ -484,63 +558,245 @@ end:
     return sw;
 }
 
+/**
+ * Append a chunk of a transaction received in the first pass of streamed signing mode to the raw transaction. Large
+ * fields of the recipient data are not kept, see next_staking_data_run. Of those, only the voting key is hashed for
+ * display.
+ */
+WARN_UNUSED_RESULT
+static error_t append_streamed_tx_chunk(uint8_t *chunk, uint16_t chunk_length) {
+    tx_parser_state_t *parser = &ctx.req.tx.parser;
+    while (chunk_length) {
+        uint16_t run_length = chunk_length;
+        staking_data_run_t run = STAKING_DATA_RUN_RETAINED;
+        // Offset of the chunk in the entire transaction, and the data length, once it has been received.
+        uint32_t offset = ctx.req.tx.rawTxLength + parser->streamed_data_length;
+        if (offset < /* data length */ 2) {
+            run_length = MIN(run_length, 2 - offset);
+        } else {
+            uint32_t data_end = /* data length */ 2 + U2BE(ctx.req.tx.rawTx, 0);
+            if (offset < data_end) {
+                uint16_t data_run_length;
+                run = next_staking_data_run(ctx.req.tx.rawTx + /* data length */ 2,
+                    ctx.req.tx.rawTxLength - /* data length */ 2, parser->streamed_data_length, &data_run_length);
+                // Runs are limited to the data, also for invalid data, which is then rejected by the parser.
+                run_length = MIN(run_length, data_run_length && data_run_length < data_end - offset
+                    ? data_run_length
+                    : data_end - offset);
+                if (run == STAKING_DATA_RUN_STREAMED_VOTING_KEY) {
+                    RETURN_ON_ERROR(
+                        cx_hash_update(&ctx.req.tx.streamedVotingKeyHashContext->header, chunk, run_length),
+                        ERROR_CRYPTOGRAPHY,
+                        "Failed to update voting key hash\n"
+                    );
+                    if (run_length == data_run_length) {
+                        // The voting key is complete.
+                        RETURN_ON_ERROR(
+                            cx_hash_final(&ctx.req.tx.streamedVotingKeyHashContext->header,
+                                ctx.req.tx.streamedVotingKeyFingerprint),
+                            ERROR_CRYPTOGRAPHY,
+                            "Failed to finalize voting key hash\n"
+                        );
+                    }
+                }
+            }
+        }
+
+        if (run == STAKING_DATA_RUN_RETAINED) {
+            RETURN_ON_ERROR(
+                ctx.req.tx.rawTxLength + run_length > MAX_RAW_TX,
+                ERROR_INVALID_LENGTH,
+                "Transaction too long\n"
+            );
+            memmove(ctx.req.tx.rawTx + ctx.req.tx.rawTxLength, chunk, run_length);
+            ctx.req.tx.rawTxLength += run_length;
+        } else {
+            parser->streamed_data_length += run_length;
+        }
+        chunk += run_length;
+        chunk_length -= run_length;
+    }
+    return ERROR_NONE;
+}
+
+/**
+ * Second pass of streamed signing mode, in which the transaction is sent again, after it has been approved by the user
+ * in the first pass. The signature R || S is returned on the last chunk.
+ */
+WARN_UNUSED_RESULT
+static sw_t handle_sign_transaction_second_pass(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t data_length,
+    uint16_t *out_apdu_length) {
+    RETURN_ON_ERROR(
+        !request_arena_belongs_to(INS_SIGN_TX)
+        || ctx.req.tx.streamedSigning.stage != ((p1 & P1_MORE)
+            ? STREAMED_SIGNING_STAGE_SECOND_PASS
+            : STREAMED_SIGNING_STAGE_APPROVED),
+        SW_BAD_STATE,
+        "Streamed transaction not approved\n"
+    );
+    if (!(p1 & P1_MORE)) {
+        // The printed values of the review are not needed anymore.
+        request_arena_free_all();
+        RETURN_ON_ERROR(
+            streamed_signing_start_second_pass(&ctx.req.tx.streamedSigning, ctx.req.tx.bip32Path,
+                ctx.req.tx.bip32PathLength),
+            ERROR_TO_SW()
+        );
+    }
+    RETURN_ON_ERROR(
+        streamed_signing_update(&ctx.req.tx.streamedSigning, data_buffer, data_length),
+        ERROR_TO_SW()
+    );
+
+    if (p2 == P2_MORE) {
+        return SW_OK;
+    }
+
+    RETURN_ON_ERROR(
+        streamed_signing_finish_second_pass(&ctx.req.tx.streamedSigning, ctx.req.tx.bip32Path,
+            ctx.req.tx.bip32PathLength, G_io_apdu_buffer),
+        ERROR_TO_SW(),
+        "Failed to sign\n"
+    );
+    request_arena_free_all();
+    *out_apdu_length = 64;
+    return SW_OK;
+}
+
+/**
+ * Transaction signing. In the regular mode, the transaction is kept in memory in its entirety, and signed after the
+ * user's approval.
+ * In streamed signing mode, the transaction is sent twice, and is only partially kept in memory, such that transactions
+ * larger than MAX_RAW_TX can be signed, see streamed_signing.h. In the first pass, the transaction is parsed, hashed, and
+ * reviewed by the user, and an empty response is sent after approval. In the second pass, the transaction is hashed
+ * again, and the signature is returned. Streamed signing mode is only supported for incoming staking transactions, where
+ * it allows signing validator transactions with voting keys. Note that in streamed signing mode no staker signature
+ * proof is created for an empty signature proof, as the transaction is not available anymore for writing the signature
+ * proof into it. Instead, the transaction with the empty signature proof is signed as is, which is exactly the signature
+ * for the signature proof, and the caller can create a second request with the signature proof filled in.
+ */
 WARN_UNUSED_RESULT
 sw_t handle_sign_transaction(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t data_length,
-    bool *out_start_async_reply) {
+    uint16_t *out_apdu_length, bool *out_start_async_reply) {
+    *out_apdu_length = 0;
     *out_start_async_reply = false;
 
+    uint8_t mode = p1 & ~P1_MORE;
     RETURN_ON_ERROR(
-        ((p1 != P1_FIRST) && (p1 != P1_MORE))
+        ((mode != P1_FIRST) && (mode != P1_STREAMED_FIRST_PASS) && (mode != P1_STREAMED_SECOND_PASS))
         || ((p2 != P2_LAST) && (p2 != P2_MORE)),
         SW_WRONG_P1P2,
         "Invalid P1 or P2\n"
     );
 
-    if (p1 == P1_FIRST) {
+    if (mode == P1_STREAMED_SECOND_PASS) {
+        return handle_sign_transaction_second_pass(p1, p2, data_buffer, data_length, out_apdu_length);
+    }
+
+    if (!(p1 & P1_MORE)) {
         _Static_assert(
             sizeof(ctx.req.tx.transactionVersion) == 1,
             "transactionVersion has more than one byte. Need to take endianness into account when reading into a u8 "
                 "pointer.\n"
         );
+        buffer_reader_t reader = reader_init(data_buffer, data_length);
+        reader_read_bip32_path(&reader, ctx.req.tx.bip32Path, &ctx.req.tx.bip32PathLength);
+        ctx.req.tx.transactionVersion = reader_read_u8(&reader);
         RETURN_ON_ERROR(
-            !read_bip32_path(&data_buffer, &data_length, ctx.req.tx.bip32Path, &ctx.req.tx.bip32PathLength)
-            || !read_u8(&data_buffer, &data_length, &ctx.req.tx.transactionVersion),
+            reader.has_error,
             SW_WRONG_DATA_LENGTH
         );
+        data_buffer = reader.position;
+        data_length = reader.remaining_length;
+
+        ctx.req.tx.rawTxLength = 0;
+        memset(&ctx.req.tx.parser, 0, sizeof(ctx.req.tx.parser));
+        memset(&PARSED_TX, 0, sizeof(PARSED_TX));
+        memset(&ctx.req.tx.streamedSigning, 0, sizeof(ctx.req.tx.streamedSigning));
+        request_arena_reset(INS_SIGN_TX, sizeof(ctx.req.tx));
+
+        if (mode == P1_STREAMED_FIRST_PASS) {
+            RETURN_ON_ERROR(
+                streamed_signing_start_first_pass(&ctx.req.tx.streamedSigning, ctx.req.tx.bip32Path,
+                    ctx.req.tx.bip32PathLength),
+                ERROR_TO_SW()
+            );
+            ctx.req.tx.streamedVotingKeyHashContext = request_arena_alloc(sizeof(cx_blake2b_t));
+            ctx.req.tx.streamedVotingKeyFingerprint = request_arena_alloc(32);
+            // Until the voting key is received, if at all, the fingerprint is all zeros.
+            memset(ctx.req.tx.streamedVotingKeyFingerprint, 0, 32);
+            ctx.req.tx.parser.streamed_voting_key_fingerprint = ctx.req.tx.streamedVotingKeyFingerprint;
+            RETURN_ON_ERROR(
+                cx_blake2b_init_no_throw(ctx.req.tx.streamedVotingKeyHashContext, /* hash length in bits */ 256),
+                SW_CRYPTOGRAPHY_FAIL,
+                "Failed to initialize voting key hash\n"
+            );
+        }
+    } else {
+        // Check that the request context still belongs to this request, and was not overwritten by another request or
+        // wiped on an error in the meantime, and that the chunk continues the same mode.
+        RETURN_ON_ERROR(
+            !request_arena_belongs_to(INS_SIGN_TX)
+            || ctx.req.tx.streamedSigning.stage != (mode == P1_STREAMED_FIRST_PASS
+                ? STREAMED_SIGNING_STAGE_FIRST_PASS
+                : STREAMED_SIGNING_STAGE_NONE),
+            SW_BAD_STATE,
+            "Transaction signing not started\n"
+        );
+    }
 
-        // read raw tx data
+    if (mode == P1_STREAMED_FIRST_PASS) {
         RETURN_ON_ERROR(
-            data_length > MAX_RAW_TX,
-            SW_WRONG_DATA_LENGTH,
-            "Transaction too long\n"
+            streamed_signing_update(&ctx.req.tx.streamedSigning, data_buffer, data_length),
+            ERROR_TO_SW()
+        );
+        RETURN_ON_ERROR(
+            append_streamed_tx_chunk(data_buffer, data_length),
+            ERROR_TO_SW()
         );
-        ctx.req.tx.rawTxLength = data_length;
-        memmove(ctx.req.tx.rawTx, data_buffer, data_length);
     } else {
-        // read more raw tx data
-        uint32_t offset = ctx.req.tx.rawTxLength;
-        ctx.req.tx.rawTxLength += data_length;
+        // read raw tx data
         RETURN_ON_ERROR(
-            ctx.req.tx.rawTxLength > MAX_RAW_TX,
+            ctx.req.tx.rawTxLength + data_length > MAX_RAW_TX,
             SW_WRONG_DATA_LENGTH,
             "Transaction too long\n"
         );
-        memmove(ctx.req.tx.rawTx+offset, data_buffer, data_length);
+        memmove(ctx.req.tx.rawTx + ctx.req.tx.rawTxLength, data_buffer, data_length);
+        ctx.req.tx.rawTxLength += data_length;
     }
 
+    // Parse the newly received data right away, such that invalid data is rejected on the chunk which contains it, and
+    // the review can start immediately after the last chunk.
+    TIMING_START(parse_start);
+    RETURN_ON_ERROR(
+        parse_tx_chunk(&ctx.req.tx.parser, ctx.req.tx.transactionVersion, ctx.req.tx.rawTx, ctx.req.tx.rawTxLength,
+            /* is_last_chunk */ p2 == P2_LAST, &PARSED_TX),
+        ERROR_TO_SW(),
+        "Failed to parse transaction\n"
+    );
+    TIMING_RECORD(TIMING_STAGE_PARSE_TX, parse_start);
+
     if (p2 == P2_MORE) {
         // Processing of current chunk finished; send success status word and let the caller continue with more chunks.
         return SW_OK;
     }
 
-    memset(&PARSED_TX, 0, sizeof(PARSED_TX));
-    RETURN_ON_ERROR(
-        parse_tx(ctx.req.tx.transactionVersion, ctx.req.tx.rawTx, ctx.req.tx.rawTxLength, &PARSED_TX),
-        ERROR_TO_SW(),
-        "Failed to parse transaction\n"
-    );
+    if (mode == P1_STREAMED_FIRST_PASS) {
+        RETURN_ON_ERROR(
+            streamed_signing_finish_first_pass(&ctx.req.tx.streamedSigning),
+            ERROR_TO_SW()
+        );
+        // The hash contexts are not needed anymore, and their memory is reused for printing during the review. The
+        // voting key fingerprint has been copied to the parsed transaction.
+        request_arena_free_all();
+        ctx.req.tx.streamedVotingKeyHashContext = NULL;
+        ctx.req.tx.streamedVotingKeyFingerprint = NULL;
+        ctx.req.tx.parser.streamed_voting_key_fingerprint = NULL;
+    }
 
+    TIMING_START(ui_start);
     ui_transaction_signing();
+    TIMING_RECORD(TIMING_STAGE_UI_INIT, ui_start);
     *out_start_async_reply = true;
     return SW_OK;
 }
@@ -559,18 +815,25 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
 
     if (p1 == P1_FIRST) {
         // Note: we expect the first chunk to at least contain the bip path, flags and encoded message length completely
+        buffer_reader_t reader = reader_init(data_buffer, data_length);
+        reader_read_bip32_path(&reader, ctx.req.msg.bip32Path, &ctx.req.msg.bip32PathLength);
+        ctx.req.msg.flags = reader_read_u8(&reader);
+        ctx.req.msg.messageLength = reader_read_u32(&reader);
         RETURN_ON_ERROR(
-            !read_bip32_path(&data_buffer, &data_length, ctx.req.msg.bip32Path, &ctx.req.msg.bip32PathLength)
-            || !read_u8(&data_buffer, &data_length, &ctx.req.msg.flags)
-            || !read_u32(&data_buffer, &data_length, &ctx.req.msg.messageLength),
+            reader.has_error,
             SW_WRONG_DATA_LENGTH
         );
+        data_buffer = reader.position;
+        data_length = reader.remaining_length;
 
         ctx.req.msg.processedMessageLength = 0;
         ctx.req.msg.isPrintableAscii = ctx.req.msg.messageLength <= MAX_PRINTABLE_MESSAGE_LENGTH; // ascii-check later
+        request_arena_reset(INS_SIGN_MESSAGE, sizeof(ctx.req.msg));
+        ctx.req.msg.messageHashContext = request_arena_alloc(sizeof(cx_sha256_t));
+        ctx.req.msg.prefixedMessageHashContext = request_arena_alloc(sizeof(cx_sha256_t));
         // Note that cx_sha256_init never throws and is not deprecated. See lcx_sha256.h and lcx_hash.h in Ledger sdk.
-        cx_sha256_init(&ctx.req.msg.prepare.messageHashContext);
-        cx_sha256_init(&ctx.req.msg.prepare.prefixedMessageHashContext);
+        cx_sha256_init(ctx.req.msg.messageHashContext);
+        cx_sha256_init(ctx.req.msg.prefixedMessageHashContext);
 
         // Nimiq signed messages add a prefix to the message and then hash both together.
         // This makes the calculated signature recognisable as a Nimiq specific signature and prevents signing arbitrary
@@ -578,7 +841,7 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
         // Keyguard.
         RETURN_ON_ERROR(
             cx_hash_update(
-                /* hash context */ &ctx.req.msg.prepare.prefixedMessageHashContext.header,
+                /* hash context */ &ctx.req.msg.prefixedMessageHashContext->header,
                 /* data */ (uint8_t *) MESSAGE_SIGNING_PREFIX,
                 /* data length */ sizeof(MESSAGE_SIGNING_PREFIX) - /* exclude string terminator */ 1
             ),
@@ -587,18 +850,27 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
         );
         // add data length printed as decimal number to the message prefix
         char decimalMessageLength[STRING_LENGTH_UINT32];
-        // note: not %lu (for unsigned long int) because int is already 32bit on ledgers (see "Memory Alignment" in
-        // Ledger docu), additionally Ledger's own implementation of sprintf does not support %lu (see os_printf.c)
-        snprintf(decimalMessageLength, sizeof(decimalMessageLength), "%u", ctx.req.msg.messageLength);
+        RETURN_ON_ERROR(
+            print_u32(ctx.req.msg.messageLength, decimalMessageLength, sizeof(decimalMessageLength)),
+            ERROR_TO_SW()
+        );
         RETURN_ON_ERROR(
             cx_hash_update(
-                /* hash context */ &ctx.req.msg.prepare.prefixedMessageHashContext.header,
+                /* hash context */ &ctx.req.msg.prefixedMessageHashContext->header,
                 /* data */ (uint8_t *) decimalMessageLength,
                 /* data length */ strlen(decimalMessageLength)
             ),
             SW_CRYPTOGRAPHY_FAIL,
             "Failed to update message hash\n"
         );
+    } else {
+        // Check that the request context still belongs to this request, and was not overwritten by another request or
+        // wiped on an error in the meantime.
+        RETURN_ON_ERROR(
+            !request_arena_belongs_to(INS_SIGN_MESSAGE),
+            SW_BAD_STATE,
+            "Message signing not started\n"
+        );
     }
 
     if (data_length != 0) {
@@ -615,12 +887,12 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
         // hash message bytes
         RETURN_ON_ERROR(
             cx_hash_update(
-                /* has context */ &ctx.req.msg.prepare.messageHashContext.header,
+                /* has context */ &ctx.req.msg.messageHashContext->header,
                 /* data */ data_buffer,
                 /* data length */ data_length
             )
             || cx_hash_update(
-                /* hash context */ &ctx.req.msg.prepare.prefixedMessageHashContext.header,
+                /* hash context */ &ctx.req.msg.prefixedMessageHashContext->header,
                 /* data */ data_buffer,
                 /* data length */ data_length
             ),
@@ -641,43 +913,38 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
         SW_WRONG_DATA_LENGTH,
         "Invalid message length\n"
     );
-    // We're sharing the memory between the hash contexts and the created hashes to reduce memory usage. Make sure that
-    // we're not overwriting the hash contexts while generating the hashes (which is also safe with the current cx_hash
-    // implementation but could break anytime) by checking whether it fits the yet unused memory allocated in front of
-    // the output messageHash and prefixedMessageHash. Note that this is a compile time assertion.
-    _Static_assert(
-        sizeof(ctx.req.msg.prepare.messageHashContext) + sizeof(ctx.req.msg.prepare.prefixedMessageHashContext)
-            < sizeof(ctx.req.msg.confirm.printedMessageLabel) + sizeof(ctx.req.msg.confirm.printedMessage),
-        "Hash context memory overlaps with output hash memory\n"
-    );
 #if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
     // Check output size manually, because cx_hash_final doesn't check it, in contrast to cx_hash_no_throw.
     RETURN_ON_ERROR(
-        cx_hash_get_size(&ctx.req.msg.prepare.messageHashContext.header)
-            > sizeof(ctx.req.msg.confirm.messageHash)
-        || cx_hash_get_size(&ctx.req.msg.prepare.prefixedMessageHashContext.header)
-            > sizeof(ctx.req.msg.confirm.prefixedMessageHash),
+        cx_hash_get_size(&ctx.req.msg.messageHashContext->header)
+            > sizeof(ctx.req.msg.messageHash)
+        || cx_hash_get_size(&ctx.req.msg.prefixedMessageHashContext->header)
+            > sizeof(ctx.req.msg.prefixedMessageHash),
         SW_CRYPTOGRAPHY_FAIL,
         "Invalid message hash output length\n"
     );
 #endif
     RETURN_ON_ERROR(
         cx_hash_final(
-            /* hash context */ &ctx.req.msg.prepare.messageHashContext.header,
-            /* output */ ctx.req.msg.confirm.messageHash
+            /* hash context */ &ctx.req.msg.messageHashContext->header,
+            /* output */ ctx.req.msg.messageHash
         )
         || cx_hash_final(
-            /* hash context */ &ctx.req.msg.prepare.prefixedMessageHashContext.header,
-            /* output */ ctx.req.msg.confirm.prefixedMessageHash
+            /* hash context */ &ctx.req.msg.prefixedMessageHashContext->header,
+            /* output */ ctx.req.msg.prefixedMessageHash
         ),
         SW_CRYPTOGRAPHY_FAIL,
         "Failed to finalize message hash\n"
     );
+    // The hash contexts are not needed anymore, and their memory is reused for printing the message.
+    request_arena_free_all();
+    ctx.req.msg.messageHashContext = NULL;
+    ctx.req.msg.prefixedMessageHashContext = NULL;
 
+    TIMING_START(ui_start);
     ui_message_signing(
         // Depending on whether the data can be printed as ASCII or hex, default to ASCII, hex or hash display, unless
-        // a specific preference was provided. The user can still switch the display type during the confirmation (not
-        // implemented yet for NBGL).
+        // a specific preference was provided. The user can still switch the display type during the confirmation.
         ctx.req.msg.isPrintableAscii
             && !(ctx.req.msg.flags & (MESSAGE_FLAG_PREFER_DISPLAY_TYPE_HEX | MESSAGE_FLAG_PREFER_DISPLAY_TYPE_HASH))
             ? MESSAGE_DISPLAY_TYPE_ASCII
@@ -687,6 +954,7 @@ sw_t handle_sign_message(uint8_t p1, uint8_t p2, uint8_t *data_buffer, uint16_t
                 : MESSAGE_DISPLAY_TYPE_HASH,
         false
     );
+    TIMING_RECORD(TIMING_STAGE_UI_INIT, ui_start);
     *out_start_async_reply = true;
     return SW_OK;
 }
@@ -700,6 +968,145 @@ sw_t handle_keep_alive(bool *out_start_async_reply) {
     return SW_OK;
 }
 
+WARN_UNUSED_RESULT
+sw_t handle_get_error_site(uint16_t *out_apdu_length) {
+    // Return the id of the error site of the previous request, see G_error_site, as big endian uint16.
+    G_io_apdu_buffer[0] = (uint8_t) (G_error_site >> 8);
+    G_io_apdu_buffer[1] = (uint8_t) G_error_site;
+    *out_apdu_length = 2;
+    return SW_OK;
+}
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+WARN_UNUSED_RESULT
+sw_t handle_get_stack_usage(uint8_t p1, uint16_t *out_apdu_length) {
+    // Return the stack size and the peak stack depths per stack_usage_slot_t, see stack_usage.h, as big endian uint16.
+    RETURN_ON_ERROR(
+        p1 != P1_KEEP_STACK_USAGE && p1 != P1_RESET_STACK_USAGE,
+        SW_WRONG_P1P2,
+        "Invalid P1\n"
+    );
+    uint16_t values[1 + STACK_USAGE_SLOT_COUNT];
+    values[0] = stack_usage_get_stack_size();
+    for (uint8_t slot = 0; slot < STACK_USAGE_SLOT_COUNT; slot++) {
+        values[1 + slot] = stack_usage_get_peak(slot);
+    }
+    for (uint8_t i = 0; i < ARRAY_LENGTH(values); i++) {
+        G_io_apdu_buffer[2 * i] = (uint8_t) (values[i] >> 8);
+        G_io_apdu_buffer[2 * i + 1] = (uint8_t) values[i];
+    }
+    *out_apdu_length = sizeof(values);
+    if (p1 == P1_RESET_STACK_USAGE) {
+        stack_usage_reset_peaks();
+    }
+    return SW_OK;
+}
+
+static void write_u32_big_endian(uint8_t *destination, uint32_t value) {
+    destination[0] = (uint8_t) (value >> 24);
+    destination[1] = (uint8_t) (value >> 16);
+    destination[2] = (uint8_t) (value >> 8);
+    destination[3] = (uint8_t) value;
+}
+
+WARN_UNUSED_RESULT
+sw_t handle_get_timings(uint8_t p1, uint16_t *out_apdu_length) {
+    // Return the timing unit, followed by count, total and maximum duration per timing_stage_t, see timing.h, and the
+    // hits and misses of the printed address memo, see user_friendly_address.h, as big endian uint32.
+    RETURN_ON_ERROR(
+        p1 != P1_KEEP_TIMINGS && p1 != P1_RESET_TIMINGS,
+        SW_WRONG_P1P2,
+        "Invalid P1\n"
+    );
+    _Static_assert(1 + (TIMING_STAGE_COUNT * 3 + 2) * sizeof(uint32_t) <= sizeof(G_io_apdu_buffer) - /* for sw */ 2,
+        "Timings don't fit the response\n");
+    uint16_t length = 0;
+    G_io_apdu_buffer[length++] = timing_get_unit();
+    for (uint8_t stage = 0; stage < TIMING_STAGE_COUNT; stage++) {
+        const timing_stats_t *stats = timing_get_stats(stage);
+        write_u32_big_endian(G_io_apdu_buffer + length, stats->count);
+        write_u32_big_endian(G_io_apdu_buffer + length + 4, stats->total);
+        write_u32_big_endian(G_io_apdu_buffer + length + 8, stats->max);
+        length += 12;
+    }
+    address_cache_stats_t address_cache_stats = address_cache_get_stats();
+    write_u32_big_endian(G_io_apdu_buffer + length, address_cache_stats.hits);
+    write_u32_big_endian(G_io_apdu_buffer + length + 4, address_cache_stats.misses);
+    length += 8;
+    *out_apdu_length = length;
+    if (p1 == P1_RESET_TIMINGS) {
+        timing_reset();
+        address_cache_reset_stats();
+    }
+    return SW_OK;
+}
+
+WARN_UNUSED_RESULT
+sw_t handle_benchmark(uint8_t p1, uint8_t *data_buffer, uint16_t data_length, uint16_t *out_apdu_length) {
+    // Run the operation specified by P1 (see timing_benchmark_operation_t) for the big endian uint16 iteration count
+    // from the data, and return the timing unit, followed by the mean and maximum duration as big endian uint32.
+    buffer_reader_t reader = reader_init(data_buffer, data_length);
+    uint16_t iteration_count = reader_read_u16(&reader);
+    RETURN_ON_ERROR(
+        reader.has_error || reader.remaining_length,
+        SW_WRONG_DATA_LENGTH
+    );
+    uint32_t mean, max;
+    RETURN_ON_ERROR(
+        timing_benchmark(p1, iteration_count, &mean, &max),
+        ERROR_TO_SW(),
+        "Benchmark failed\n"
+    );
+    G_io_apdu_buffer[0] = timing_get_unit();
+    write_u32_big_endian(G_io_apdu_buffer + 1, mean);
+    write_u32_big_endian(G_io_apdu_buffer + 5, max);
+    *out_apdu_length = 9;
+    return SW_OK;
+}
+
+#define TRACE_ENTRIES_PER_RESPONSE 20
+#define TRACE_ENTRY_ENCODED_LENGTH 12
+
+WARN_UNUSED_RESULT
+sw_t handle_get_trace(uint8_t first_entry_index, uint16_t *out_apdu_length) {
+    // Return the total event count as big endian uint16 and the retained entry count, followed by up to
+    // TRACE_ENTRIES_PER_RESPONSE retained entries, starting at the entry index specified by P1, see trace.h. The entries
+    // are encoded as event, arg, error site, payload and timestamp, all big endian.
+    _Static_assert(3 + TRACE_ENTRIES_PER_RESPONSE * TRACE_ENTRY_ENCODED_LENGTH <= sizeof(G_io_apdu_buffer) - 2,
+        "Trace entries don't fit the response\n");
+    uint16_t event_count = trace_get_event_count();
+    uint16_t length = 0;
+    G_io_apdu_buffer[length++] = (uint8_t) (event_count >> 8);
+    G_io_apdu_buffer[length++] = (uint8_t) event_count;
+    G_io_apdu_buffer[length++] = trace_get_entry_count();
+    const trace_entry_t *entry;
+    for (uint8_t i = 0; i < TRACE_ENTRIES_PER_RESPONSE && (entry = trace_get_entry(first_entry_index + i)); i++) {
+        G_io_apdu_buffer[length] = entry->event;
+        G_io_apdu_buffer[length + 1] = entry->arg;
+        G_io_apdu_buffer[length + 2] = (uint8_t) (entry->error_site >> 8);
+        G_io_apdu_buffer[length + 3] = (uint8_t) entry->error_site;
+        write_u32_big_endian(G_io_apdu_buffer + length + 4, entry->payload);
+        write_u32_big_endian(G_io_apdu_buffer + length + 8, entry->timestamp);
+        length += TRACE_ENTRY_ENCODED_LENGTH;
+    }
+    *out_apdu_length = length;
+    return SW_OK;
+}
+
+static stack_usage_slot_t stack_usage_slot_for_instruction(uint8_t instruction) {
+    switch (instruction) {
+        case INS_GET_PUBLIC_KEY:
+            return STACK_USAGE_SLOT_GET_PUBLIC_KEY;
+        case INS_SIGN_TX:
+            return STACK_USAGE_SLOT_SIGN_TX;
+        case INS_SIGN_MESSAGE:
+            return STACK_USAGE_SLOT_SIGN_MESSAGE;
+        default:
+            return STACK_USAGE_SLOT_OTHER_INSTRUCTIONS;
+    }
+}
+#endif // NIMIQ_DEBUG
+
 WARN_UNUSED_RESULT
 sw_t handle_apdu(uint16_t *out_apdu_length, bool *out_start_async_reply) {
     *out_apdu_length = 0;
@@ -717,7 +1124,7 @@ sw_t handle_apdu(uint16_t *out_apdu_length, bool *out_start_async_reply) {
 
     switch (G_io_apdu_buffer[OFFSET_INS]) {
         case INS_GET_PUBLIC_KEY:
-            PRINTF("Handle INS_GET_PUBLIC_KEY\n");
+            VERBOSE_PRINTF("Handle INS_GET_PUBLIC_KEY\n");
             return handle_get_public_key(
                 G_io_apdu_buffer[OFFSET_P1],
                 G_io_apdu_buffer[OFFSET_P2],
@@ -727,16 +1134,17 @@ sw_t handle_apdu(uint16_t *out_apdu_length, bool *out_start_async_reply) {
                 out_start_async_reply
             );
         case INS_SIGN_TX:
-            PRINTF("Handle INS_SIGN_TX\n");
+            VERBOSE_PRINTF("Handle INS_SIGN_TX\n");
             return handle_sign_transaction(
                 G_io_apdu_buffer[OFFSET_P1],
                 G_io_apdu_buffer[OFFSET_P2],
                 G_io_apdu_buffer + OFFSET_CDATA,
                 G_io_apdu_buffer[OFFSET_LC],
+                out_apdu_length,
                 out_start_async_reply
             );
         case INS_SIGN_MESSAGE:
-            PRINTF("Handle INS_SIGN_MESSAGE\n");
+            VERBOSE_PRINTF("Handle INS_SIGN_MESSAGE\n");
             return handle_sign_message(
                 G_io_apdu_buffer[OFFSET_P1],
                 G_io_apdu_buffer[OFFSET_P2],
@@ -745,8 +1153,30 @@ sw_t handle_apdu(uint16_t *out_apdu_length, bool *out_start_async_reply) {
                 out_start_async_reply
             );
         case INS_KEEP_ALIVE:
-            PRINTF("Handle INS_KEEP_ALIVE\n");
+            VERBOSE_PRINTF("Handle INS_KEEP_ALIVE\n");
             return handle_keep_alive(out_start_async_reply);
+        case INS_GET_ERROR_SITE:
+            VERBOSE_PRINTF("Handle INS_GET_ERROR_SITE\n");
+            return handle_get_error_site(out_apdu_length);
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+        case INS_GET_STACK_USAGE:
+            VERBOSE_PRINTF("Handle INS_GET_STACK_USAGE\n");
+            return handle_get_stack_usage(G_io_apdu_buffer[OFFSET_P1], out_apdu_length);
+        case INS_GET_TIMINGS:
+            VERBOSE_PRINTF("Handle INS_GET_TIMINGS\n");
+            return handle_get_timings(G_io_apdu_buffer[OFFSET_P1], out_apdu_length);
+        case INS_BENCHMARK:
+            VERBOSE_PRINTF("Handle INS_BENCHMARK\n");
+            return handle_benchmark(
+                G_io_apdu_buffer[OFFSET_P1],
+                G_io_apdu_buffer + OFFSET_CDATA,
+                G_io_apdu_buffer[OFFSET_LC],
+                out_apdu_length
+            );
+        case INS_GET_TRACE:
+            VERBOSE_PRINTF("Handle INS_GET_TRACE\n");
+            return handle_get_trace(G_io_apdu_buffer[OFFSET_P1], out_apdu_length);
+#endif // NIMIQ_DEBUG
         default:
             RETURN_ERROR(
                 SW_INS_NOT_SUPPORTED,
@@ -778,13 +1208,44 @@ void nimiq_main() {
         command_apdu_length = io_exchange(channel_and_flags, response_apdu_length);
 
         sw_t sw;
+        DEBUG_EMIT(bool is_traced = true;)
+        // Each request records its own error site, except for the query of the previous request's error site. Reset
+        // before the length check, such that APDUs rejected for their length don't report the site of a previous error.
+        if (command_apdu_length <= OFFSET_INS || G_io_apdu_buffer[OFFSET_INS] != INS_GET_ERROR_SITE) {
+            G_error_site = 0;
+        }
         if (command_apdu_length < OFFSET_LC + 1
             || command_apdu_length != G_io_apdu_buffer[OFFSET_LC] + OFFSET_CDATA) {
-            PRINTF("No or invalid length APDU received\n");
+            VERBOSE_PRINTF("No or invalid length APDU received\n");
             sw = SW_WRONG_DATA_LENGTH;
+            TRACE(TRACE_EVENT_ERROR, 0, ERROR_SITE_ID, (uint32_t) sw);
+            RECORD_ERROR_SITE();
         } else {
-            PRINTF("New APDU received:\n%.*H\n", command_apdu_length, G_io_apdu_buffer);
+            VERBOSE_PRINTF("New APDU received:\n%.*H\n", command_apdu_length, G_io_apdu_buffer);
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+            // Requests of the trace itself are not traced, such that the trace doesn't change while it's read.
+            is_traced = G_io_apdu_buffer[OFFSET_INS] != INS_GET_TRACE;
+            if (is_traced) {
+                TRACE(TRACE_EVENT_APDU_COMMAND, G_io_apdu_buffer[OFFSET_INS], 0,
+                    ((uint32_t) G_io_apdu_buffer[OFFSET_CLA] << 24) | ((uint32_t) G_io_apdu_buffer[OFFSET_P1] << 16)
+                    | ((uint32_t) G_io_apdu_buffer[OFFSET_P2] << 8) | G_io_apdu_buffer[OFFSET_LC]);
+            }
+#endif // NIMIQ_DEBUG
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+            // Not measured for INS_GET_STACK_USAGE, which is queried after, and reports the measurements of a request.
+            bool measure_stack_usage = G_io_apdu_buffer[OFFSET_INS] != INS_GET_STACK_USAGE;
+            if (measure_stack_usage) {
+                STACK_USAGE_BEGIN(stack_usage_slot_for_instruction(G_io_apdu_buffer[OFFSET_INS]));
+            }
+#endif // NIMIQ_DEBUG
+            TIMING_START(apdu_start);
             sw = handle_apdu(&response_apdu_length, &start_async_reply);
+            TIMING_RECORD(TIMING_STAGE_HANDLE_APDU, apdu_start);
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+            if (measure_stack_usage) {
+                STACK_USAGE_END();
+            }
+#endif // NIMIQ_DEBUG
         }
 
         if (sw != SW_OK) {
@@ -795,6 +1256,16 @@ void nimiq_main() {
             start_async_reply = false;
         }
 
+        if (start_async_reply) {
+            // The review, or a renewed async reply after a keep alive, starts.
+            TIMING_REVIEW_START();
+        }
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+        if (is_traced) {
+            TRACE(TRACE_EVENT_APDU_RESPONSE, /* async reply started */ start_async_reply, G_error_site, sw);
+        }
+#endif // NIMIQ_DEBUG
+
         // Finalize the APDU response by appending the status word. The final response will be sent out with io_exchange
         // in the next loop iteration.
         G_io_apdu_buffer[response_apdu_length++] = (uint8_t) (sw >> 8);
@@ -829,6 +1300,7 @@ unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
 }
 
 unsigned char io_event(UNUSED_PARAMETER(uint8_t channel)) {
+    STACK_USAGE_BEGIN(STACK_USAGE_SLOT_IO_EVENT);
     // nothing done with the event, throw an error on the transport layer if needed
 
     // can't have more than one tag in the reply, not supported yet.
@@ -862,6 +1334,7 @@ unsigned char io_event(UNUSED_PARAMETER(uint8_t channel)) {
 #endif // HAVE_NBGL
 
         case SEPROXYHAL_TAG_TICKER_EVENT:
+            TIMING_TICK();
             if (G_io_app.apdu_media == IO_APDU_MEDIA_U2F && ctx.u2fTimer > 0) {
                 ctx.u2fTimer -= 100;
                 if (ctx.u2fTimer == 0) {
@@ -881,6 +1354,7 @@ unsigned char io_event(UNUSED_PARAMETER(uint8_t channel)) {
         io_seproxyhal_general_status();
     }
 
+    STACK_USAGE_END();
     // command has been processed, DO NOT reset the current APDU transport
     return 1;
 }
@@ -897,6 +1371,9 @@ __attribute__((section(".boot"))) int main() {
     // ensure exception will work as planned
     os_boot();
 
+    STACK_USAGE_INIT();
+    TIMING_INIT();
+
     for (;;) {
         memset(&ctx, 0, sizeof(ctx));
 
@@ -930,6 +1407,7 @@ __attribute__((section(".boot"))) int main() {
                 // CATCH_OTHER already does so automatically.
                 if (e == EXCEPTION_IO_RESET || e == INVALID_STATE) {
                     PRINTF("Received EXCEPTION_IO_RESET or INVALID_STATE. Resetting the app...");
+                    TRACE(TRACE_EVENT_APP_RESET, 0, 0, e);
                     continue; // Reset IO and UX and restart.
                 } else {
                     // On other exceptions terminate the application.
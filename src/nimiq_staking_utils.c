@@ -20,6 +20,9 @@
 #include "nimiq_staking_utils.h"
 #include "nimiq_utils.h"
 #include "signature_proof.h"
+#include "buffer_reader.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_NIMIQ_STAKING_UTILS
 
 // Staking transactions
 // Incoming staking transactions are to the staking contract and encode their data in the recipient data, outgoing
@@ -31,140 +34,351 @@
 // - which are serialized to bytes in postcard format: https://postcard.jamesmunns.com/wire-format.html, see data() in
 //   transaction-builder/src/recipient/mod.rs and there used serialize_to_vec
 
+// Staking data is decoded via field descriptor tables, which list for each data type the fields in their serialization
+// order, instead of hand-written read sequences per type. The tables are constant and therefore stored in flash, and are
+// interpreted by decode_staking_data_fields. Supporting a new data type whose fields are already known to the decoder
+// thus only costs a table row.
+typedef enum {
+    // Zero, such that data types without a table row are unsupported.
+    STAKING_FIELD_UNSUPPORTED = 0,
+    STAKING_FIELD_END,
+    STAKING_FIELD_DELEGATION, // Option<Address>, stored as create_staker_or_update_staker.delegation
+    STAKING_FIELD_REACTIVATE_ALL_STAKE, // bool, stored as create_staker_or_update_staker.update_staker_reactivate_all_stake
+    STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS, // Address, stored as validator or staker address
+    STAKING_FIELD_AMOUNT, // Coin, stored as set_active_stake_or_retire_stake.amount
+    STAKING_FIELD_SIGNATURE_PROOF, // SignatureProof, stored as validator or staker signature proof
+    // The following are stored in create_validator_or_update_validator.
+    STAKING_FIELD_SIGNING_KEY, // SchnorrPublicKey, i.e. an ed25519 public key
+    STAKING_FIELD_VOTING_KEY, // BlsPublicKey, of which only the fingerprint is stored
+    STAKING_FIELD_REWARD_ADDRESS, // Address
+    STAKING_FIELD_SIGNAL_DATA, // Option<Blake2bHash>
+    STAKING_FIELD_PROOF_OF_KNOWLEDGE, // BlsSignature, which is not stored
+} staking_field_t;
+
+// Modifier for a field that is wrapped in an Option, as used for the changes of UpdateValidator. If the Option is None,
+// the field is skipped, and its stored value is left unset.
+#define STAKING_FIELD_OPTIONAL 0x80
+
+#define STAKING_DATA_MAX_FIELDS 7 // including STAKING_FIELD_END
+typedef uint8_t staking_data_fields_t[STAKING_DATA_MAX_FIELDS];
+
+static const staking_data_fields_t STAKING_INCOMING_DATA_FIELDS[] = {
+    [CREATE_VALIDATOR] = {
+        STAKING_FIELD_SIGNING_KEY,
+        STAKING_FIELD_VOTING_KEY,
+        STAKING_FIELD_REWARD_ADDRESS,
+        STAKING_FIELD_SIGNAL_DATA,
+        STAKING_FIELD_PROOF_OF_KNOWLEDGE,
+        STAKING_FIELD_SIGNATURE_PROOF,
+        STAKING_FIELD_END,
+    },
+    [UPDATE_VALIDATOR] = {
+        STAKING_FIELD_OPTIONAL | STAKING_FIELD_SIGNING_KEY,
+        STAKING_FIELD_OPTIONAL | STAKING_FIELD_VOTING_KEY,
+        STAKING_FIELD_OPTIONAL | STAKING_FIELD_REWARD_ADDRESS,
+        STAKING_FIELD_OPTIONAL | STAKING_FIELD_SIGNAL_DATA, // Option<Option<Blake2bHash>>
+        STAKING_FIELD_OPTIONAL | STAKING_FIELD_PROOF_OF_KNOWLEDGE,
+        STAKING_FIELD_SIGNATURE_PROOF,
+        STAKING_FIELD_END,
+    },
+    [DEACTIVATE_VALIDATOR] = {
+        STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS,
+        STAKING_FIELD_SIGNATURE_PROOF,
+        STAKING_FIELD_END,
+    },
+    [REACTIVATE_VALIDATOR] = {
+        STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS,
+        STAKING_FIELD_SIGNATURE_PROOF,
+        STAKING_FIELD_END,
+    },
+    [RETIRE_VALIDATOR] = { STAKING_FIELD_SIGNATURE_PROOF, STAKING_FIELD_END },
+    [CREATE_STAKER] = { STAKING_FIELD_DELEGATION, STAKING_FIELD_SIGNATURE_PROOF, STAKING_FIELD_END },
+    [ADD_STAKE] = { STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS, STAKING_FIELD_END },
+    [UPDATE_STAKER] = {
+        STAKING_FIELD_DELEGATION,
+        STAKING_FIELD_REACTIVATE_ALL_STAKE,
+        STAKING_FIELD_SIGNATURE_PROOF,
+        STAKING_FIELD_END,
+    },
+    [SET_ACTIVE_STAKE] = { STAKING_FIELD_AMOUNT, STAKING_FIELD_SIGNATURE_PROOF, STAKING_FIELD_END },
+    [RETIRE_STAKE] = { STAKING_FIELD_AMOUNT, STAKING_FIELD_SIGNATURE_PROOF, STAKING_FIELD_END },
+};
+
+static const staking_data_fields_t STAKING_OUTGOING_DATA_FIELDS[] = {
+    [DELETE_VALIDATOR] = { STAKING_FIELD_END },
+    [REMOVE_STAKE] = { STAKING_FIELD_END },
+};
+
+/**
+ * Decode the fields listed in a field descriptor table row, and check that no data remains. The address of a validator
+ * or staker address field is returned via out_validator_or_staker_address as pointer into the data. For streamed data,
+ * see next_staking_data_run, the voting key and proof of knowledge are not part of the data.
+ */
+WARN_UNUSED_RESULT
+static error_t decode_staking_data_fields(buffer_reader_t *reader, const uint8_t *fields,
+    const uint8_t *streamed_voting_key_fingerprint, tx_data_staking_incoming_t *out,
+    uint8_t **out_validator_or_staker_address) {
+    RETURN_ON_ERROR(
+        fields[0] == STAKING_FIELD_UNSUPPORTED,
+        ERROR_NOT_SUPPORTED,
+        "Unsupported staking data type\n"
+    );
+    for (uint8_t i = 0; i < STAKING_DATA_MAX_FIELDS && fields[i] != STAKING_FIELD_END; i++) {
+        // Note that on a read error, reader_read_bool returns false, such that the field is skipped, and the sticky read
+        // error is detected at the end.
+        if ((fields[i] & STAKING_FIELD_OPTIONAL) && !reader_read_bool(reader)) continue;
+        switch (fields[i] & ~STAKING_FIELD_OPTIONAL) {
+            case STAKING_FIELD_DELEGATION:
+                out->create_staker_or_update_staker.delegation = reader_read_bool(reader)
+                    ? reader_read_sub_buffer(reader, 20)
+                    : NULL;
+                break;
+            case STAKING_FIELD_REACTIVATE_ALL_STAKE:
+                out->create_staker_or_update_staker.update_staker_reactivate_all_stake = reader_read_bool(reader);
+                break;
+            case STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS:
+                *out_validator_or_staker_address = reader_read_sub_buffer(reader, 20);
+                break;
+            case STAKING_FIELD_AMOUNT:
+                out->set_active_stake_or_retire_stake.amount = reader_read_u64(reader);
+                RETURN_ON_ERROR(
+                    reader->has_error,
+                    ERROR_READ
+                );
+                RETURN_ON_ERROR(
+                    check_amount(out->set_active_stake_or_retire_stake.amount)
+                );
+                break;
+            case STAKING_FIELD_SIGNATURE_PROOF:
+                out->has_validator_or_staker_signature_proof = true;
+                RETURN_ON_ERROR(
+                    !read_signature_proof(reader, &out->validator_or_staker_signature_proof),
+                    ERROR_READ
+                );
+                break;
+            case STAKING_FIELD_SIGNING_KEY:
+                out->create_validator_or_update_validator.signing_key = reader_read_sub_buffer(reader, 32);
+                break;
+            case STAKING_FIELD_VOTING_KEY: {
+                out->create_validator_or_update_validator.has_voting_key = true;
+                if (streamed_voting_key_fingerprint) {
+                    memmove(out->create_validator_or_update_validator.voting_key_fingerprint,
+                        streamed_voting_key_fingerprint, 32);
+                    break;
+                }
+                // The voting key is hashed right away, such that only its fingerprint needs to be kept for display.
+                uint8_t *voting_key = reader_read_sub_buffer(reader, BLS_COMPRESSED_PUBLIC_KEY_LENGTH);
+                RETURN_ON_ERROR(
+                    reader->has_error,
+                    ERROR_READ
+                );
+                RETURN_ON_ERROR(
+                    blake2b_256(voting_key, BLS_COMPRESSED_PUBLIC_KEY_LENGTH,
+                        out->create_validator_or_update_validator.voting_key_fingerprint)
+                );
+                break;
+            }
+            case STAKING_FIELD_REWARD_ADDRESS:
+                out->create_validator_or_update_validator.reward_address = reader_read_sub_buffer(reader, 20);
+                break;
+            case STAKING_FIELD_SIGNAL_DATA:
+                out->create_validator_or_update_validator.signal_data = reader_read_bool(reader)
+                    ? reader_read_sub_buffer(reader, 32)
+                    : NULL;
+                // For an update, an unset signal data means that it's cleared.
+                out->create_validator_or_update_validator.is_signal_data_cleared =
+                    (fields[i] & STAKING_FIELD_OPTIONAL) && !out->create_validator_or_update_validator.signal_data;
+                break;
+            case STAKING_FIELD_PROOF_OF_KNOWLEDGE:
+                // Not displayed, as an invalid proof of knowledge of the voting key is rejected by the network nodes.
+                if (!streamed_voting_key_fingerprint) {
+                    reader_advance(reader, BLS_COMPRESSED_SIGNATURE_LENGTH);
+                }
+                break;
+            default:
+                RETURN_ERROR(
+                    ERROR_NOT_SUPPORTED,
+                    "Invalid staking data field\n"
+                );
+        }
+    }
+    RETURN_ON_ERROR(
+        reader->has_error,
+        ERROR_READ
+    );
+    RETURN_ON_ERROR(
+        reader->remaining_length != 0,
+        ERROR_INVALID_LENGTH,
+        "Staking data too long\n"
+    );
+    return ERROR_NONE;
+}
+
 WARN_UNUSED_RESULT
 error_t parse_staking_incoming_data(transaction_version_t version, uint8_t *data, uint16_t data_length, uint8_t *sender,
-    tx_data_staking_incoming_t *out) {
+    const uint8_t *streamed_voting_key_fingerprint, tx_data_staking_incoming_t *out) {
     RETURN_ON_ERROR(
         version == TRANSACTION_VERSION_LEGACY,
         ERROR_INCORRECT_DATA,
         "Staking is not supported for legacy transactions\n"
     );
 
-    uint8_t validator_or_staker_address_buffer[20];
+    buffer_reader_t reader = reader_init(data, data_length);
     // NULL means not specified, which is then the same as sender, as we create the staker signature proof with the
     // sender account, if the empty signature proof was provided, see transaction signing in main.c
     uint8_t *effective_validator_or_staker_address = NULL;
 
+    // Fields that are not part of the data type are left at 0, i.e. no delegation and no signature proof.
+    memset(out, 0, sizeof(*out));
     _Static_assert(
         sizeof(out->type) == 1,
         "out->type has more than one byte. Need to take endianness into account when reading into a u8 pointer.\n"
     );
+    out->type = reader_read_u8(&reader);
     RETURN_ON_ERROR(
-        !read_u8(&data, &data_length, &out->type),
+        reader.has_error,
         ERROR_READ
     );
-    switch (out->type) {
-        case CREATE_STAKER:
-        case UPDATE_STAKER: {
-            bool hasDelegation;
-            RETURN_ON_ERROR(
-                !read_bool(&data, &data_length, &hasDelegation),
-                ERROR_READ
-            );
-            if (hasDelegation) {
-                uint8_t *delegation_address_pointer;
-                RETURN_ON_ERROR(
-                    !read_sub_buffer(20, &data, &data_length, &delegation_address_pointer),
-                    ERROR_READ
-                );
-                RETURN_ON_ERROR(
-                    print_address(delegation_address_pointer, out->create_staker_or_update_staker.delegation)
-                );
-            } else {
-                COPY_FIXED_SIZE(out->create_staker_or_update_staker.delegation, "");
-            }
-            if (out->type == UPDATE_STAKER) {
-                bool reactivate_all_stake;
-                RETURN_ON_ERROR(
-                    !read_bool(&data, &data_length, &reactivate_all_stake),
-                    ERROR_READ
-                );
-                if (reactivate_all_stake) {
-                    COPY_FIXED_SIZE(out->create_staker_or_update_staker.update_staker_reactivate_all_stake, "Yes");
-                } else {
-                    COPY_FIXED_SIZE(out->create_staker_or_update_staker.update_staker_reactivate_all_stake, "No");
-                }
-            }
-            break;
-        }
-
-        case ADD_STAKE: {
-            RETURN_ON_ERROR(
-                !read_sub_buffer(20, &data, &data_length, &effective_validator_or_staker_address),
-                ERROR_READ
-            );
-            break;
-        }
-
-        case SET_ACTIVE_STAKE:
-        case RETIRE_STAKE: {
-            uint64_t amount;
-            RETURN_ON_ERROR(
-                !read_u64(&data, &data_length, &amount),
-                ERROR_READ
-            );
-            RETURN_ON_ERROR(
-                parse_amount(amount, "NIM", out->set_active_stake_or_retire_stake.amount)
-            );
-            break;
-        }
-
-        default:
-            // Note that validator transactions are not supported yet.
-            RETURN_ERROR(
-                ERROR_NOT_SUPPORTED,
-                "Invalid incoming staking transaction data type\n"
-            );
-    }
+    RETURN_ON_ERROR(
+        out->type >= ARRAY_LENGTH(STAKING_INCOMING_DATA_FIELDS),
+        ERROR_NOT_SUPPORTED,
+        "Invalid incoming staking transaction data type\n"
+    );
+    RETURN_ON_ERROR(
+        decode_staking_data_fields(&reader, STAKING_INCOMING_DATA_FIELDS[out->type], streamed_voting_key_fingerprint,
+            out, &effective_validator_or_staker_address)
+    );
 
-    if (out->type != ADD_STAKE) {
-        // All types but ADD_STAKE encode a validator or staker signature proof at the end of the data.
-        out->has_validator_or_staker_signature_proof = true;
-        RETURN_ON_ERROR(
-            !read_signature_proof(&data, &data_length, &out->validator_or_staker_signature_proof),
-            ERROR_READ
-        );
+    // The validator or staker is the signer of the signature proof, unless the data explicitly specifies its address,
+    // like for ADD_STAKE, DEACTIVATE_VALIDATOR and REACTIVATE_VALIDATOR. The latter two are signed by the validator's
+    // signing key, instead of the validator's address key.
+    if (!effective_validator_or_staker_address
+        && out->has_validator_or_staker_signature_proof
+        && !is_empty_default_signature_proof(out->validator_or_staker_signature_proof)) {
         RETURN_ON_ERROR(
-            // Currently only ed25519 and empty merkle paths are supported.
-            out->validator_or_staker_signature_proof.type_and_flags != 0
-            || out->validator_or_staker_signature_proof.merkle_path_length,
-            ERROR_NOT_SUPPORTED,
-            "Only ed25519 signature proofs without flags and merkle paths supported\n"
+            compute_signature_proof_signer(&out->validator_or_staker_signature_proof, out->validator_or_staker_address)
         );
-        if (!is_empty_default_signature_proof(out->validator_or_staker_signature_proof)) {
-            RETURN_ON_ERROR(
-                public_key_to_address(out->validator_or_staker_signature_proof.public_key,
-                    validator_or_staker_address_buffer)
-            );
-            effective_validator_or_staker_address = validator_or_staker_address_buffer;
-        }
-    } else {
-        out->has_validator_or_staker_signature_proof = false;
+        effective_validator_or_staker_address = out->validator_or_staker_address;
     }
 
-    RETURN_ON_ERROR(
-        data_length != 0,
-        ERROR_INVALID_LENGTH,
-        "Incoming staking data too long\n"
-    );
-
-    // Print the validator or staker address if it is different to the sender address.
+    // Keep the validator or staker address for display if it is different to the sender address, and always for
+    // validator transactions, see compute_tx_display_plan.
     // Other parts of the signature proofs don't need to be displayed or verified as they're verified by network nodes.
-    if (effective_validator_or_staker_address && memcmp(effective_validator_or_staker_address, sender, 20)) {
-        RETURN_ON_ERROR(
-            print_address(effective_validator_or_staker_address, out->validator_or_staker_address)
-        );
-    } else {
-        // The staker address is the same as the sender address. Note that different to parse_htlc_creation_data or
-        // parse_vesting_creation_data we don't block non-basic sender types for staker creation here, because contract
-        // sender addresses would not be able to create a valid signature proof anyway as no signing key is known for
-        // the contract address.
-        COPY_FIXED_SIZE(out->validator_or_staker_address, "");
+    // If the staker address is the same as the sender address, note that different to parse_htlc_creation_data or
+    // parse_vesting_creation_data we don't block non-basic sender types for staker creation here, because contract
+    // sender addresses would not be able to create a valid signature proof anyway as no signing key is known for the
+    // contract address.
+    if (is_validator_transaction_data(out->type) && !effective_validator_or_staker_address) {
+        effective_validator_or_staker_address = sender;
+    }
+    out->has_validator_or_staker_address = effective_validator_or_staker_address
+        && (is_validator_transaction_data(out->type) || memcmp(effective_validator_or_staker_address, sender, 20));
+    if (out->has_validator_or_staker_address) {
+        // memmove, as the address might already be in place, if it was derived from the signature proof.
+        memmove(out->validator_or_staker_address, effective_validator_or_staker_address, 20);
     }
 
     return ERROR_NONE;
 }
 
+/**
+ * Determine how the next bytes of incoming staking data are handled in streamed signing mode, in which the data is not
+ * kept in its entirety. Fields which are too large to be kept in the raw transaction buffer, i.e. the voting key and the
+ * proof of knowledge of validator transactions, are streamed, i.e. only hashed but not kept. All other bytes are
+ * retained in the raw transaction buffer, such that the data can be parsed as usual, with the streamed fields skipped,
+ * see decode_staking_data_fields. Based on the data retained so far, and the number of bytes streamed so far, the field
+ * descriptor table row is walked up to the current position, and the length of the next run of retained or streamed
+ * bytes is returned via out_run_length. A length of 0 means that all remaining data is retained. Invalid data is not
+ * rejected here, but by the parser.
+ */
+staking_data_run_t next_staking_data_run(uint8_t *retained_data, uint16_t retained_data_length,
+    uint16_t streamed_data_length, uint16_t *out_run_length) {
+    // The data type.
+    *out_run_length = 1;
+    if (!retained_data_length) return STAKING_DATA_RUN_RETAINED;
+    *out_run_length = 0;
+    if (retained_data[0] >= ARRAY_LENGTH(STAKING_INCOMING_DATA_FIELDS)) return STAKING_DATA_RUN_RETAINED;
+    const uint8_t *fields = STAKING_INCOMING_DATA_FIELDS[retained_data[0]];
+
+    // Only the fields up to the last streamed field need to be walked. The remaining data is retained.
+    uint8_t field_count = 0;
+    for (uint8_t i = 0; i < STAKING_DATA_MAX_FIELDS && fields[i] != STAKING_FIELD_END; i++) {
+        uint8_t field = fields[i] & ~STAKING_FIELD_OPTIONAL;
+        if (field == STAKING_FIELD_VOTING_KEY || field == STAKING_FIELD_PROOF_OF_KNOWLEDGE) {
+            field_count = i + 1;
+        }
+    }
+
+    uint16_t retained_offset = 1;
+    uint16_t streamed_offset = 0;
+    for (uint8_t i = 0; i < field_count; i++) {
+        // Tags of Options are retained, and determine whether the field is present.
+        bool has_tag = (fields[i] & STAKING_FIELD_OPTIONAL)
+            || fields[i] == STAKING_FIELD_DELEGATION || fields[i] == STAKING_FIELD_SIGNAL_DATA;
+        if (has_tag && retained_offset >= retained_data_length) {
+            *out_run_length = 1;
+            return STAKING_DATA_RUN_RETAINED;
+        }
+        if ((fields[i] & STAKING_FIELD_OPTIONAL) && !retained_data[retained_offset++]) continue;
+
+        uint16_t field_length = 0;
+        staking_data_run_t run = STAKING_DATA_RUN_RETAINED;
+        switch (fields[i] & ~STAKING_FIELD_OPTIONAL) {
+            case STAKING_FIELD_DELEGATION:
+            case STAKING_FIELD_SIGNAL_DATA:
+                // Option<Address> or Option<Blake2bHash>. Note that for an Option<Option<Blake2bHash>> the tag of the
+                // outer option has already been handled above.
+                if ((fields[i] & STAKING_FIELD_OPTIONAL) && retained_offset >= retained_data_length) {
+                    *out_run_length = 1;
+                    return STAKING_DATA_RUN_RETAINED;
+                }
+                if (retained_data[retained_offset++]) {
+                    field_length = (fields[i] & ~STAKING_FIELD_OPTIONAL) == STAKING_FIELD_DELEGATION ? 20 : 32;
+                }
+                break;
+            case STAKING_FIELD_REACTIVATE_ALL_STAKE:
+                field_length = 1;
+                break;
+            case STAKING_FIELD_VALIDATOR_OR_STAKER_ADDRESS:
+            case STAKING_FIELD_REWARD_ADDRESS:
+                field_length = 20;
+                break;
+            case STAKING_FIELD_AMOUNT:
+                field_length = 8;
+                break;
+            case STAKING_FIELD_SIGNING_KEY:
+                field_length = 32;
+                break;
+            case STAKING_FIELD_VOTING_KEY:
+                field_length = BLS_COMPRESSED_PUBLIC_KEY_LENGTH;
+                run = STAKING_DATA_RUN_STREAMED_VOTING_KEY;
+                break;
+            case STAKING_FIELD_PROOF_OF_KNOWLEDGE:
+                field_length = BLS_COMPRESSED_SIGNATURE_LENGTH;
+                run = STAKING_DATA_RUN_STREAMED;
+                break;
+            default:
+                // Fields of variable length, like signature proofs, are not supported before streamed fields.
+                return STAKING_DATA_RUN_RETAINED;
+        }
+
+        if (run == STAKING_DATA_RUN_RETAINED) {
+            if (retained_offset + field_length > retained_data_length) {
+                *out_run_length = retained_offset + field_length - retained_data_length;
+                return run;
+            }
+            retained_offset += field_length;
+        } else {
+            if (streamed_offset + field_length > streamed_data_length) {
+                *out_run_length = streamed_offset + field_length - streamed_data_length;
+                return run;
+            }
+            streamed_offset += field_length;
+        }
+    }
+    return STAKING_DATA_RUN_RETAINED;
+}
+
 WARN_UNUSED_RESULT
 error_t parse_staking_outgoing_data(transaction_version_t version, uint8_t *sender_data, uint16_t sender_data_length,
     staking_outgoing_data_type_t *out_staking_outgoing_type) {
@@ -179,18 +393,26 @@ error_t parse_staking_outgoing_data(transaction_version_t version, uint8_t *send
         "*out_staking_outgoing_type has more than one byte. Need to take endianness into account when reading into a "
             "u8 pointer.\n"
     );
+    buffer_reader_t reader = reader_init(sender_data, sender_data_length);
+    *out_staking_outgoing_type = reader_read_u8(&reader);
     RETURN_ON_ERROR(
-        !read_u8(&sender_data, &sender_data_length, out_staking_outgoing_type),
+        reader.has_error,
         ERROR_READ
     );
     RETURN_ON_ERROR(
-        *out_staking_outgoing_type != DELETE_VALIDATOR && *out_staking_outgoing_type != REMOVE_STAKE,
+        *out_staking_outgoing_type >= ARRAY_LENGTH(STAKING_OUTGOING_DATA_FIELDS),
         ERROR_INCORRECT_DATA,
         "Invalid outgoing staking type\n"
     );
-
+    // The outgoing data types carry no fields besides the type, such that the decoder is not needed here. This way, it
+    // gets inlined into parse_staking_incoming_data, which saves flash and a stack frame.
     RETURN_ON_ERROR(
-        sender_data_length != 0,
+        STAKING_OUTGOING_DATA_FIELDS[*out_staking_outgoing_type][0] != STAKING_FIELD_END,
+        ERROR_NOT_SUPPORTED,
+        "Unsupported outgoing staking type\n"
+    );
+    RETURN_ON_ERROR(
+        reader.remaining_length != 0,
         ERROR_INVALID_LENGTH,
         "Outgoing staking data too long\n"
     );
@@ -217,3 +439,11 @@ bool is_signaling_transaction_data(staking_incoming_data_type_t type) {
         || type == SET_ACTIVE_STAKE
         || type == RETIRE_STAKE;
 }
+
+bool is_validator_transaction_data(staking_incoming_data_type_t type) {
+    return type == CREATE_VALIDATOR
+        || type == UPDATE_VALIDATOR
+        || type == DEACTIVATE_VALIDATOR
+        || type == REACTIVATE_VALIDATOR
+        || type == RETIRE_VALIDATOR;
+}
@@ -24,27 +24,59 @@
 #include "error_macros.h"
 #include "signature_proof.h"
 
+// Sizes of the compressed BLS voting keys and signatures (proofs of knowledge of the voting key) of validators, on the
+// MNT6-753 curve, see CompressedPublicKey and CompressedSignature in the bls crate of core-rs-albatross.
+#define BLS_COMPRESSED_PUBLIC_KEY_LENGTH 285
+#define BLS_COMPRESSED_SIGNATURE_LENGTH 95
+
 typedef struct {
     staking_incoming_data_type_t type;
     bool has_validator_or_staker_signature_proof;
+    // All data types have a validator or staker address. For staker transactions only set if it's different to the
+    // sender address, for validator transactions always set.
+    bool has_validator_or_staker_address;
     signature_proof_t validator_or_staker_signature_proof; // only used if has_validator_or_staker_signature_proof set
-    // All data types have a validator or staker address. Empty string if equal to sender address.
-    char validator_or_staker_address[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
+    // Copied instead of pointing into the raw transaction, as it might have been derived from the signature proof.
+    uint8_t validator_or_staker_address[20];
     union {
-        // Note that validator transactions are not supported yet.
         struct {
-            char delegation[STRING_LENGTH_USER_FRIENDLY_ADDRESS]; // Empty string if optional delegation address unset.
-            char update_staker_reactivate_all_stake[STRING_LENGTH_YES_NO]; // only used for UPDATE_STAKER; "Yes" or "No"
+            uint8_t *signing_key; // pointer to the 32 byte ed25519 public key in the raw transaction; NULL if unchanged
+            uint8_t *reward_address; // pointer to the 20 byte address in the raw transaction; NULL if unchanged
+            uint8_t *signal_data; // pointer to the 32 byte hash in the raw transaction; NULL if unset or unchanged
+            bool has_voting_key; // false for UPDATE_VALIDATOR, if the voting key is unchanged
+            bool is_signal_data_cleared; // only used for UPDATE_VALIDATOR
+            // Blake2b hash of the voting key, which is too long to be displayed. The voting key itself is not needed
+            // after parsing.
+            uint8_t voting_key_fingerprint[32];
+        } create_validator_or_update_validator;
+        struct {
+            uint8_t *delegation; // pointer to the 20 byte address in the raw transaction; NULL if unset
+            bool update_staker_reactivate_all_stake; // only used for UPDATE_STAKER
         } create_staker_or_update_staker;
         struct {
-            char amount[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
+            uint64_t amount;
         } set_active_stake_or_retire_stake;
     };
 } tx_data_staking_incoming_t;
 
+// Handling of the next bytes of incoming staking data in streamed signing mode, see next_staking_data_run.
+typedef enum {
+    STAKING_DATA_RUN_RETAINED,
+    STAKING_DATA_RUN_STREAMED,
+    STAKING_DATA_RUN_STREAMED_VOTING_KEY,
+} staking_data_run_t;
+
+/**
+ * Parse incoming staking data. In streamed signing mode, streamed_voting_key_fingerprint is set, and the data does not
+ * include the voting key and proof of knowledge, see next_staking_data_run; the voting key is then represented by the
+ * passed fingerprint. Otherwise, it's NULL.
+ */
 WARN_UNUSED_RESULT
 error_t parse_staking_incoming_data(transaction_version_t version, uint8_t *data, uint16_t data_length, uint8_t *sender,
-    tx_data_staking_incoming_t *out);
+    const uint8_t *streamed_voting_key_fingerprint, tx_data_staking_incoming_t *out);
+
+staking_data_run_t next_staking_data_run(uint8_t *retained_data, uint16_t retained_data_length,
+    uint16_t streamed_data_length, uint16_t *out_run_length);
 
 WARN_UNUSED_RESULT
 error_t parse_staking_outgoing_data(transaction_version_t version, uint8_t *sender_data, uint16_t sender_data_length,
@@ -54,4 +86,6 @@ bool is_staking_contract(uint8_t *address_bytes);
 
 bool is_signaling_transaction_data(staking_incoming_data_type_t type);
 
+bool is_validator_transaction_data(staking_incoming_data_type_t type);
+
 #endif // _NIMIQ_STAKING_UTILS_H_
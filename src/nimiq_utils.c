@@ -14,7 +14,6 @@
  *  See the License for the specific language governing permissions and
  *  limitations under the License.
  ********************************************************************************/
-#include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -23,116 +22,27 @@
 
 #include "nimiq_utils.h"
 #include "nimiq_staking_utils.h"
-#include "base32.h"
+#include "buffer_reader.h"
 
-WARN_UNUSED_RESULT
-error_t iban_check(char base32[static 32], char *check) {
-    unsigned int counter = 0;
-    unsigned int offset = 0;
-    unsigned int modulo = 0;
-
-    int partial_uint = 0;
-
-    char address[36] = { 0 };
-    char total_number[71] = { 0 };
-    char partial_number[10] = { 0 };
-
-    // According to IBAN standard, "NQ00" needs to be appended to the original address to calculate the checksum
-    // Note: the input base32 is not required to be \0 terminated. We only look at the ascii chars before a potential
-    // string terminator here. Check that it's indeed valid base32 chars happens below.
-    memmove(address, base32, MIN(sizeof(address), 32));
-    address[32] = 'N';
-    address[33] = 'Q';
-    address[34] = '0';
-    address[35] = '0';
-
-    // Convert the address to a number-only string
-    for (unsigned int i = 0; i < 36; i++) {
-        LEDGER_ASSERT(
-            // This assertion should hold, given the number of iterations and the fact that at least two address chars
-            // are digits, which increase the counter only by one.
-            counter < 70,
-            "Overflow in iban check"
-        );
-        if (address[i] >= 48 && address[i] <= 57) {
-            total_number[counter++] = address[i];
-        } else if (address[i] >= 65 && address[i] <= 90) {
-            snprintf(&total_number[counter++], 3, "%d", address[i] - 55);
-            // Letters convert to a two digit number, increase the counter one more time
-            counter++;
-        } else if (address[i] >= 97 && address[i] <= 122) {
-            snprintf(&total_number[counter++], 3, "%d", address[i] - 87);
-            // Letters convert to a two digit number, increase the counter one more time
-            counter++;
-        } else {
-            RETURN_ERROR(
-                ERROR_INCORRECT_DATA,
-                "Invalid ascii code in iban check\n"
-            );
-        }
-    }
-
-    // Compute modulo-97 on the resulting number (do it in 32-bit pieces)
-    counter = 0;
-    for (unsigned int i = 0; i < 10; i++) {
-        memmove(&partial_number[offset], &total_number[counter], 9 - offset);
-        counter += 9 - offset;
-        for (unsigned int j = 0; j < 9; j++) {
-            if (partial_number[j] != '\0') {
-                partial_uint = 10 * partial_uint + (partial_number[j] - '0');
-            } else {
-                break;
-            }
-        }
-
-        modulo = partial_uint % 97;
-        snprintf(partial_number, 3, "%02d", modulo);
-        partial_uint = 0;
-        offset = 2;
-    }
-
-    snprintf(check, 3, "%02d", 98 - modulo);
-
-    return ERROR_NONE;
-}
+#define ERROR_SITE_FILE ERROR_SITE_FILE_NIMIQ_UTILS
 
 WARN_UNUSED_RESULT
-error_t print_address(uint8_t *in, char *out) {
-    unsigned int counter = 4;
-    char after_base32[33] = { 0 }; // includes one extra byte for the string terminator
-
-    RETURN_ON_ERROR(
-        base32_encode(in, 20, after_base32, sizeof(after_base32))
-    );
+error_t blake2b_256(uint8_t *in, uint16_t in_length, uint8_t *out) {
+    // See lcx_blake2.h and lcx_hash.h in Ledger sdk
+    cx_blake2b_t blake2b_context;
     RETURN_ON_ERROR(
-        iban_check(after_base32, &out[2])
+        cx_blake2b_init_no_throw(&blake2b_context, /* hash length in bits */ 256)
+        || cx_hash_no_throw(&blake2b_context.header, CX_LAST, in, in_length, out, 32),
+        ERROR_CRYPTOGRAPHY
     );
-
-    out[0] = 'N';
-    out[1] = 'Q';
-
-    // Insert spaces for readability
-    for (unsigned int i = 0; i < 8; i++) {
-        out[counter++] = ' ';
-        memcpy(&out[counter], &after_base32[i*4], 4);
-        counter += 4;
-    }
-
-    // Make sure that the address string is always null-terminated
-    out[44] = '\0';
-
     return ERROR_NONE;
 }
 
 WARN_UNUSED_RESULT
 error_t public_key_to_address(uint8_t *in, uint8_t *out) {
-    // See lcx_blake2.h and lcx_hash.h in Ledger sdk
     unsigned char blake2b_hash[32];
-    cx_blake2b_t blake2b_context;
     RETURN_ON_ERROR(
-        cx_blake2b_init_no_throw(&blake2b_context, /* hash length in bits */ 256)
-        || cx_hash_no_throw(&blake2b_context.header, CX_LAST, in, 32, blake2b_hash, 32),
-        ERROR_CRYPTOGRAPHY
+        blake2b_256(in, 32, blake2b_hash)
     );
     memmove(out, blake2b_hash, 20); // the first 20 bytes of the hash are the Nimiq address
     return ERROR_NONE;
@@ -151,96 +61,39 @@ error_t print_public_key_as_address(uint8_t *in, char *out) {
 }
 
 WARN_UNUSED_RESULT
-error_t print_hex(uint8_t *data, uint16_t data_length, char *out, uint16_t out_length) {
+error_t check_amount(uint64_t amount) {
+    // If the amount can't be represented safely in JavaScript, signal an error
     RETURN_ON_ERROR(
-        // Check that it fits 2 hex chars per byte + string terminator.
-        out_length < data_length * 2 + 1,
-        ERROR_INVALID_LENGTH,
-        "Out buffer too small to fit hex\n"
+        amount > MAX_SAFE_LUNA_AMOUNT,
+        ERROR_INCORRECT_DATA,
+        "Invalid amount\n"
     );
-    // not using Ledger's proprietary %.*H snprintf format, as it's non-standard
-    // (see https://github.com/LedgerHQ/app-bitcoin/pull/200/files)
-    for (uint16_t i = 0; i < data_length; i++) {
-        snprintf(out + i * 2, /* 2 hex chars + string terminator */ 3, "%02X", data[i]);
-    }
     return ERROR_NONE;
 }
 
 WARN_UNUSED_RESULT
 error_t parse_amount(uint64_t amount, const char * const ticker,
     char out[static STRING_LENGTH_NIM_AMOUNT_WITH_TICKER]) {
-    char buffer[STRING_LENGTH_NIM_AMOUNT]; // Note that we don't have to ensure that this is \0 terminated.
-    uint64_t dVal = amount;
-    uint8_t i, j;
-
-    // If the amount can't be represented safely in JavaScript, signal an error
     RETURN_ON_ERROR(
-        amount > MAX_SAFE_LUNA_AMOUNT,
-        ERROR_INCORRECT_DATA,
-        "Invalid amount\n"
+        check_amount(amount)
+    );
+    RETURN_ON_ERROR(
+        print_amount(amount, ticker, out, STRING_LENGTH_NIM_AMOUNT_WITH_TICKER)
     );
-
-    for (i = 0; dVal > 0 || i < 7; i++) {
-        if (dVal > 0) {
-            buffer[i] = (dVal % 10) + '0';
-            dVal /= 10;
-        } else {
-            buffer[i] = '0';
-        }
-        if (i == 4) { // add decimal separator: 1 nim = 100 000 luna
-            i += 1;
-            buffer[i] = '.';
-        }
-        LEDGER_ASSERT(
-            // This assertion should hold as we checked for MAX_SAFE_LUNA_AMOUNT
-            i < STRING_LENGTH_NIM_AMOUNT,
-            "Overflow in parse_amount"
-        );
-    }
-    // Reverse order. Note: i is now the number of written characters.
-    for (j = 0; j < i; j++) {
-        out[j] = buffer[i - 1 - j];
-    }
-    // Strip trailing 0s. Note: j starts with i as initial value. The loop stops the latest, when the decimal separator
-    // is reached.
-    for (; j > 0; j--) {
-        if (out[j - 1] != '0') break;
-    }
-
-    // strip trailing decimal separator
-    if (j > 0 && out[j - 1] == '.') {
-        j -= 1;
-    }
-
-    if (ticker) {
-        size_t ticker_length = strlen(ticker);
-        RETURN_ON_ERROR(
-            j + /* space */ 1 + ticker_length + /* string terminator */ 1 > STRING_LENGTH_NIM_AMOUNT_WITH_TICKER,
-            ERROR_INCORRECT_DATA,
-            "Result is longer than STRING_LENGTH_NIM_AMOUNT_WITH_TICKER\n"
-        );
-        // Add ticker.
-        out[j++] = ' ';
-        memcpy(out + j, ticker, ticker_length);
-        out[j + ticker_length] = '\0';
-    } else {
-        out[j] = '\0';
-    }
-
     return ERROR_NONE;
 }
 
 WARN_UNUSED_RESULT
-error_t parse_network_id(transaction_version_t version, uint8_t network_id,
-    char out[static STRUCT_MEMBER_SIZE(parsed_tx_t, network)]) {
+error_t parse_network_id(transaction_version_t version, uint8_t network_id, const char **out) {
+    // Pointers to constant strings in flash memory.
     if (network_id == (version == TRANSACTION_VERSION_LEGACY ? 42 : 24)) {
-        memcpy(out, "Main", sizeof("Main"));
+        *out = "Main";
     } else if (network_id == (version == TRANSACTION_VERSION_LEGACY ? 1 : 5)) {
-        memcpy(out, "Test", sizeof("Test"));
+        *out = "Test";
     } else if (network_id == (version == TRANSACTION_VERSION_LEGACY ? 2 : 6)) {
-        memcpy(out, "Development", sizeof("Development"));
+        *out = "Development";
     } else if (network_id == (version == TRANSACTION_VERSION_LEGACY ? 3 : 7)) {
-        memcpy(out, "Bounty", sizeof("Bounty"));
+        *out = "Bounty";
     } else {
         RETURN_ERROR(
             ERROR_INCORRECT_DATA,
@@ -253,9 +106,10 @@ error_t parse_network_id(transaction_version_t version, uint8_t network_id,
 WARN_UNUSED_RESULT
 error_t parse_normal_tx_data(uint8_t *data, uint16_t data_length, tx_data_normal_or_staking_outgoing_t *out,
     bool *out_is_cashlink) {
-    // initiate with empty string / empty data
-    COPY_FIXED_SIZE(out->extra_data_label, "");
-    COPY_FIXED_SIZE(out->extra_data, "");
+    // initiate with no data to display
+    out->extra_data = NULL;
+    out->extra_data_length = 0;
+    out->is_extra_data_hex = false;
     *out_is_cashlink = false;
 
     // Make sure we don't get called with more data than we can fit on the extra data field.
@@ -275,20 +129,10 @@ error_t parse_normal_tx_data(uint8_t *data, uint16_t data_length, tx_data_normal
         *out_is_cashlink = true;
         return ERROR_NONE;
     }
-    // Check if there is any non-printable ASCII characters
-    if (!is_printable_ascii(data, data_length)) {
-        COPY_FIXED_SIZE(out->extra_data_label, "Data Hex");
-        RETURN_ON_ERROR(
-            print_hex(data, data_length, out->extra_data, sizeof(out->extra_data))
-        );
-        return ERROR_NONE;
-    }
-
-    // If there is not, copy the string to be displayed. Note that data is not a \0 terminated string, which is why we
-    // simply copy it with memmove and add a string terminator manually.
-    COPY_FIXED_SIZE(out->extra_data_label, "Data");
-    memmove(out->extra_data, data, data_length);
-    out->extra_data[data_length] = '\0'; // Add string terminator.
+    // The data is displayed as text, or as hex if there are any non-printable ASCII characters.
+    out->extra_data = data;
+    out->extra_data_length = (uint8_t) data_length; // no risk of overflow, as checked against LENGTH_NORMAL_TX_DATA_MAX
+    out->is_extra_data_hex = !is_printable_ascii(data, data_length);
 
     return ERROR_NONE;
 }
@@ -301,17 +145,15 @@ error_t parse_htlc_creation_data(transaction_version_t version, uint8_t *data, u
         ERROR_NOT_SUPPORTED,
         "HTLC creation not implemented yet for Albatross\n"
     );
+    buffer_reader_t reader = reader_init(data, data_length);
 
     // Process refund address
-    uint8_t *refund_address_bytes;
+    out->refund_address = reader_read_sub_buffer(&reader, 20);
     RETURN_ON_ERROR(
-        !read_sub_buffer(20, &data, &data_length, &refund_address_bytes),
+        reader.has_error,
         ERROR_READ
     );
-    RETURN_ON_ERROR(
-        print_address(refund_address_bytes, out->refund_address)
-    );
-    out->is_refund_address_sender_address = memcmp(refund_address_bytes, sender, 20) == 0;
+    out->is_refund_address_sender_address = memcmp(out->refund_address, sender, 20) == 0;
 
     RETURN_ON_ERROR(
         // Although the refund address can be any address, specifying a contract as refund address is not recommendable
@@ -323,34 +165,22 @@ error_t parse_htlc_creation_data(transaction_version_t version, uint8_t *data, u
     );
 
     // Process redeem address
-    uint8_t *redeem_address_bytes;
-    RETURN_ON_ERROR(
-        !read_sub_buffer(20, &data, &data_length, &redeem_address_bytes),
-        ERROR_READ
-    );
-    RETURN_ON_ERROR(
-        print_address(redeem_address_bytes, out->redeem_address)
-    );
+    out->redeem_address = reader_read_sub_buffer(&reader, 20);
 
     // Process hash algorithm
-    hash_algorithm_t hash_algorithm;
     _Static_assert(
-        sizeof(hash_algorithm) == 1,
-        "hash_algorithm has more than one byte. Need to take endianness into account when reading into a u8 pointer.\n"
+        sizeof(hash_algorithm_t) == 1,
+        "hash_algorithm_t has more than one byte. Need to take endianness into account when reading it as u8.\n"
     );
+    out->hash_algorithm = reader_read_u8(&reader);
     RETURN_ON_ERROR(
-        !read_u8(&data, &data_length, &hash_algorithm),
+        reader.has_error,
         ERROR_READ
     );
-    switch (hash_algorithm) {
+    switch (out->hash_algorithm) {
         case HASH_ALGORITHM_BLAKE2B:
-            COPY_FIXED_SIZE(out->hash_algorithm, "BLAKE2b");
-            break;
         case HASH_ALGORITHM_SHA256:
-            COPY_FIXED_SIZE(out->hash_algorithm, "SHA-256");
-            break;
         case HASH_ALGORITHM_SHA512:
-            COPY_FIXED_SIZE(out->hash_algorithm, "SHA-512");
             break;
         default:
             // Invalid hash algorithm. Notably, ARGON2d is blacklisted for HTLCs.
@@ -359,42 +189,21 @@ error_t parse_htlc_creation_data(transaction_version_t version, uint8_t *data, u
                 "Invalid hash algorithm or blacklisted ARGON2d\n"
             );
     }
-    out->is_using_sha256 = hash_algorithm == HASH_ALGORITHM_SHA256;
 
-    // Process hash root
-    uint8_t hash_size = hash_algorithm == HASH_ALGORITHM_SHA512 ? 64 : 32;
-    uint8_t *hash_bytes;
+    // Process hash root, hash count and timeout. Read errors are checked at once.
+    out->hash_root = reader_read_sub_buffer(&reader, out->hash_algorithm == HASH_ALGORITHM_SHA512 ? 64 : 32);
+    out->hash_count = reader_read_u8(&reader);
+    out->timeout = reader_read_u32(&reader);
     RETURN_ON_ERROR(
-        !read_sub_buffer(hash_size, &data, &data_length, &hash_bytes),
+        reader.has_error,
         ERROR_READ
     );
-    // Print the hash as hex.
-    RETURN_ON_ERROR(
-        print_hex(hash_bytes, hash_size, out->hash_root, sizeof(out->hash_root))
-    );
 
-    // Process hash count
-    uint8_t hash_count;
-    RETURN_ON_ERROR(
-        !read_u8(&data, &data_length, &hash_count),
-        ERROR_READ
-    );
-    snprintf(out->hash_count, sizeof(out->hash_count), "%u", hash_count);
-
-    // Process timeout
-    uint32_t timeout;
-    RETURN_ON_ERROR(
-        !read_u32(&data, &data_length, &timeout),
-        ERROR_READ
-    );
-    // note: not %lu (for unsigned long int) because int is already 32bit on ledgers (see "Memory Alignment" in Ledger
-    // docu), additionally Ledger's own implementation of sprintf does not support %lu (see os_printf.c)
-    snprintf(out->timeout, sizeof(out->timeout), "%u", timeout);
-    out->is_timing_out_soon = timeout < validity_start_height
-        || timeout - validity_start_height < HTLC_TIMEOUT_SOON_THRESHOLD;
+    out->is_timing_out_soon = out->timeout < validity_start_height
+        || out->timeout - validity_start_height < HTLC_TIMEOUT_SOON_THRESHOLD;
 
     RETURN_ON_ERROR(
-        data_length != 0,
+        reader.remaining_length != 0,
         ERROR_INVALID_LENGTH,
         "Htlc data too long\n"
     );
@@ -410,21 +219,19 @@ error_t parse_vesting_creation_data(transaction_version_t version, uint8_t *data
         ERROR_NOT_SUPPORTED,
         "Vesting creation not implemented yet for Albatross\n"
     );
+    buffer_reader_t reader = reader_init(data, data_length);
 
     // Note that this method could be quite heavy on the stack (depending on how well the compiler optimizes it). It
     // could be refactored by allocating less variables by printing them directly or re-using variables, but at the cost
     // of less readable code.
 
     // Process owner address
-    uint8_t *owner_address_bytes;
+    out->owner_address = reader_read_sub_buffer(&reader, 20);
     RETURN_ON_ERROR(
-        !read_sub_buffer(20, &data, &data_length, &owner_address_bytes),
+        reader.has_error,
         ERROR_READ
     );
-    RETURN_ON_ERROR(
-        print_address(owner_address_bytes, out->owner_address)
-    );
-    out->is_owner_address_sender_address = memcmp(owner_address_bytes, sender, 20) == 0;
+    out->is_owner_address_sender_address = memcmp(out->owner_address, sender, 20) == 0;
 
     RETURN_ON_ERROR(
         // Although the owner address can be any address, specifying a contract as owner is not recommendable because
@@ -440,29 +247,24 @@ error_t parse_vesting_creation_data(transaction_version_t version, uint8_t *data
     uint32_t step_block_count;
     uint64_t step_amount = tx_amount;
     uint64_t total_locked_amount = tx_amount;
-    if (data_length == 4) {
-        RETURN_ON_ERROR(
-            !read_u32(&data, &data_length, &step_block_count),
-            ERROR_READ
-        );
+    if (reader.remaining_length == 4) {
+        step_block_count = reader_read_u32(&reader);
     } else {
-        RETURN_ON_ERROR(
-            !read_u32(&data, &data_length, &start_block)
-            || !read_u32(&data, &data_length, &step_block_count)
-            || !read_u64(&data, &data_length, &step_amount),
-            ERROR_READ
-        );
+        start_block = reader_read_u32(&reader);
+        step_block_count = reader_read_u32(&reader);
+        step_amount = reader_read_u64(&reader);
 
-        if (data_length == 8) {
-            RETURN_ON_ERROR(
-                !read_u64(&data, &data_length, &total_locked_amount),
-                ERROR_READ
-            );
+        if (reader.remaining_length == 8) {
+            total_locked_amount = reader_read_u64(&reader);
         }
     }
+    RETURN_ON_ERROR(
+        reader.has_error,
+        ERROR_READ
+    );
 
     RETURN_ON_ERROR(
-        data_length != 0,
+        reader.remaining_length != 0,
         ERROR_INVALID_LENGTH,
         "Vesting data too long\n"
     );
@@ -554,315 +356,59 @@ error_t parse_vesting_creation_data(transaction_version_t version, uint8_t *data
         }
     }
 
-    // Print data
-    out->is_multi_step = step_count > 1;
-    // note: not %lu (for unsigned long int) because int is already 32bit on ledgers (see "Memory Alignment" in Ledger
-    // docu), additionally Ledger's own implementation of sprintf does not support %lu (see os_printf.c)
-    snprintf(out->start_block, sizeof(out->start_block), "%u", start_block);
-    snprintf(out->period, sizeof(out->period), "%u block%c", period, period != 1 ? 's' : '\0');
-    snprintf(out->step_count, sizeof(out->step_count), "%u", step_count);
-    snprintf(out->step_block_count, sizeof(out->step_block_count), "%u block%c", step_block_count,
-        step_block_count != 1 ? 's' : '\0');
-    snprintf(out->first_step_block_count, sizeof(out->first_step_block_count), "%u block%c", first_step_block_count,
-        first_step_block_count != 1 ? 's' : '\0');
-    snprintf(out->first_step_block, sizeof(out->first_step_block), "%u",
-        start_block + first_step_block_count); // guaranteed to not overflow as also start_block + period <= UINT32_MAX
+    // Store data for display. Note that start_block + first_step_block_count is guaranteed to not overflow as also
+    // start_block + period <= UINT32_MAX. The amounts are all at most tx_amount or step_amount.
     RETURN_ON_ERROR(
-        parse_amount(step_amount, "NIM", out->step_amount)
-        || parse_amount(first_step_amount, "NIM", out->first_step_amount)
-        || parse_amount(last_step_amount, "NIM", out->last_step_amount)
-        || parse_amount(pre_vested_amount, "NIM", out->pre_vested_amount),
+        check_amount(tx_amount) || check_amount(step_amount),
         ERROR_INCORRECT_DATA
     );
+    out->start_block = start_block;
+    out->period = period;
+    out->step_count = step_count;
+    out->step_block_count = step_block_count;
+    out->first_step_block_count = first_step_block_count;
+    out->step_amount = step_amount;
+    out->first_step_amount = first_step_amount;
+    out->last_step_amount = last_step_amount;
+    out->pre_vested_amount = pre_vested_amount;
 
     return ERROR_NONE;
 }
 
-// Buffer utils
-// Note that these favor sanity checks and code readability over execution speed or low stack / memory usage.
-
-/**
- * Reads the leading part of a buffer as pointer in the original buffer, and advances the buffer pointer by length of
- * the extracted sub buffer. Notably, no copy of the sub buffer is created.
- * @param sub_buffer_length - The length of the sub buffer to read.
- * @param in_out_buffer - Buffer to read sub buffer from, after which the buffer pointer gets advanced by length read.
- * @param in_out_buffer_length - Buffer length to check sub buffer length against. Afterwards reduced by length read.
- * @param out_sub_buffer - A pointer to the sub buffer. This is a pointer in the original buffer (not to a copy) or NULL
- * @return true on success, false on error
- */
-WARN_UNUSED_RESULT
-bool read_sub_buffer(uint16_t sub_buffer_length, uint8_t **in_out_buffer, uint16_t *in_out_buffer_length,
-    uint8_t **out_sub_buffer) {
-    *out_sub_buffer = NULL;
-    if (sub_buffer_length == 0) {
-        return true;
-    }
-    if (in_out_buffer == NULL || *in_out_buffer == NULL || in_out_buffer_length == NULL) {
-        PRINTF("Buffer invalid\n");
-        return false;
-    }
-    if (*in_out_buffer_length < sub_buffer_length) {
-        PRINTF("Buffer too short\n");
-        return false;
-    }
-    *out_sub_buffer = *in_out_buffer;
-    // Advance buffer and reduce the remaining buffer length.
-    *in_out_buffer += sub_buffer_length;
-    *in_out_buffer_length -= sub_buffer_length;
-    return true;
-}
-
-WARN_UNUSED_RESULT
-bool read_u8(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint8_t *out_value) {
-    uint8_t *uint8_pointer;
-    RETURN_ON_ERROR(
-        !read_sub_buffer(1, in_out_buffer, in_out_buffer_length, &uint8_pointer),
-        false
-    );
-    *out_value = *uint8_pointer;
-    return true;
-}
-
-WARN_UNUSED_RESULT
-bool read_u16(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint16_t *out_value) {
-    uint8_t a, b;
-    RETURN_ON_ERROR(
-        !read_u8(in_out_buffer, in_out_buffer_length, &a)
-        || !read_u8(in_out_buffer, in_out_buffer_length, &b),
-        false
-    );
-    *out_value = (((uint16_t) a) << 8) | b;
-    return true;
-}
-
-WARN_UNUSED_RESULT
-bool read_u32(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint32_t *out_value) {
-    uint16_t a, b;
-    RETURN_ON_ERROR(
-        !read_u16(in_out_buffer, in_out_buffer_length, &a)
-        || !read_u16(in_out_buffer, in_out_buffer_length, &b),
-        false
-    );
-    *out_value = (((uint32_t) a) << 16) | b;
-    return true;
-}
+// Transaction parsing
+// For serialization format see serialize_content in primitives/transaction/src/lib.rs in core-rs-albatross.
+// The transaction is parsed in stages, while it's being received in chunks, such that invalid data can be rejected as
+// early as possible, see parse_tx_chunk. The recipient data is located at the beginning of the transaction, but can only
+// be processed once the recipient type and the other fields it depends on have been read. However, by that time, it's
+// already entirely available in the raw transaction buffer.
+// Note: the transaction validity checks here are mostly for good measure and not entirely thorough or strict as they
+// don't need to be, because an invalid transaction will be rejected by the network nodes, even if we let it pass here
+// in the app.
 
 WARN_UNUSED_RESULT
-bool read_u64(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint64_t *out_value) {
-    uint32_t a, b;
-    RETURN_ON_ERROR(
-        !read_u32(in_out_buffer, in_out_buffer_length, &a)
-        || !read_u32(in_out_buffer, in_out_buffer_length, &b),
-        false
-    );
-    *out_value = (((uint64_t) a) << 32) | b;
-    return true;
-}
+static error_t parse_tx_recipient_data(tx_parser_state_t *state, transaction_version_t version, uint8_t *buffer,
+    parsed_tx_t *out) {
+    // In streamed signing mode, only the retained data is in the buffer.
+    uint16_t retained_data_length = state->data_length - state->streamed_data_length;
+    uint8_t *data = retained_data_length ? buffer + /* data length */ 2 : NULL;
+    uint8_t *sender = buffer + /* data length */ 2 + retained_data_length;
+    uint8_t *recipient = sender + /* sender */ 20 + /* sender type */ 1;
 
-WARN_UNUSED_RESULT
-bool read_bool(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, bool *out_value) {
-    uint8_t uint8_value;
     RETURN_ON_ERROR(
-        !read_u8(in_out_buffer, in_out_buffer_length, &uint8_value),
-        false
-    );
-    *out_value = uint8_value != 0;
-    return true;
-}
-
-/**
- * Read a varint compatible with serde / postcard serialization, see https://postcard.jamesmunns.com/wire-format.html,
- * also called LEB, see https://en.wikipedia.org/wiki/LEB128. Note that this serialization format is different from, for
- * example, Bitcoin's variable length integers.
- */
-WARN_UNUSED_RESULT
-bool read_serde_uvarint(uint8_t max_bits, uint8_t **in_out_buffer, uint16_t *in_out_buffer_length,
-    uint32_t *out_value) {
-    // This is currently an incomplete implementation, as it only supports reading single-byte varints, i.e. values up
-    // to 127, as we currently don't need reading higher values. Parameter max_bits is also mostly ignored yet in this
-    // implementation, we only check that it is not less that what's read from a single byte.
-    RETURN_ON_ERROR(
-        max_bits < 7,
-        false,
-        "Unsupported varint length\n"
-    );
-    uint8_t byte;
-    RETURN_ON_ERROR(
-        !read_u8(in_out_buffer, in_out_buffer_length, &byte),
-        false
-    );
-    uint8_t continuationBit = byte & 0x80; // the most significant bit is the continuation bit
-    RETURN_ON_ERROR(
-        continuationBit,
-        false,
-        "Unsupported multi-byte varint\n"
-    );
-    *out_value = byte;
-    return true;
-}
-
-/**
- * Read a vector of bytes, compatible with serde / postcard serialization of a rust Vec<u8>. No copy of the data is
- * created.
- */
-WARN_UNUSED_RESULT
-bool read_serde_vec_u8(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint8_t **out_data,
-    uint16_t *out_data_length) {
-    // A Vec is represented as a seq by serde, see https://serde.rs/data-model.html#types, which in turn is encoded as a
-    // varint(usize) followed by the u8 data by postcard, see https://postcard.jamesmunns.com/wire-format.html#23---seq.
-    // While usize is typically 32 bit or 64 bit, see https://postcard.jamesmunns.com/wire-format.html#isize-and-usize,
-    // depending on the host size, we limit it to 16 bit here, as the memory of Ledger devices can't hold that long data
-    // anyway. The u8 data is stored as individual bytes, see https://postcard.jamesmunns.com/wire-format.html#7---u8.
-    uint32_t data_length; // u32 as that's what read_serde_uvarint expects
-    RETURN_ON_ERROR(
-        !read_serde_uvarint(16, in_out_buffer, in_out_buffer_length, &data_length)
-        || !read_sub_buffer(data_length, in_out_buffer, in_out_buffer_length, out_data),
-        false
-    );
-    *out_data_length = data_length; // no risk of overflow, as we limited the reading of the uvarint to 16 bits
-    return true;
-}
-
-/**
- * Read a bip32 path. The data is copied to the output. The output must have a size of at least MAX_BIP32_PATH_LENGTH.
- */
-WARN_UNUSED_RESULT
-bool read_bip32_path(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint32_t *out_bip32_path,
-    uint8_t *out_bip32_path_length) {
-    RETURN_ON_ERROR(
-        !read_u8(in_out_buffer, in_out_buffer_length, out_bip32_path_length),
-        false
-    );
-    RETURN_ON_ERROR(
-        *out_bip32_path_length < 1 || *out_bip32_path_length > MAX_BIP32_PATH_LENGTH,
-        false,
-        "Invalid bip32 path length\n"
-    );
-    for (uint8_t i = 0; i < *out_bip32_path_length; i++) {
-        RETURN_ON_ERROR(
-            !read_u32(in_out_buffer, in_out_buffer_length, &out_bip32_path[i]),
-            false
-        );
-    }
-    return true;
-}
-
-WARN_UNUSED_RESULT
-error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer_length, parsed_tx_t *out) {
-    RETURN_ON_ERROR(
-        version != TRANSACTION_VERSION_LEGACY && version != TRANSACTION_VERSION_ALBATROSS,
+        state->streamed_voting_key_fingerprint
+            && (state->sender_type == ACCOUNT_TYPE_STAKING || state->recipient_type != ACCOUNT_TYPE_STAKING),
         ERROR_NOT_SUPPORTED,
-        "Unsupported transaction version\n"
-    );
-
-    // For serialization format see serialize_content in primitives/transaction/src/lib.rs in core-rs-albatross.
-
-    // Read the recipient data
-    uint16_t data_length;
-    RETURN_ON_ERROR(
-        !read_u16(&buffer, &buffer_length, &data_length),
-        ERROR_READ
-    );
-    PRINTF("data length: %u\n", data_length);
-    uint8_t *data;
-    RETURN_ON_ERROR(
-        !read_sub_buffer(data_length, &buffer, &buffer_length, &data),
-        ERROR_READ
+        "Streamed signing is only supported for incoming staking transactions\n"
     );
 
-    // Read the sender
-    uint8_t *sender, sender_type;
-    RETURN_ON_ERROR(
-        !read_sub_buffer(20, &buffer, &buffer_length, &sender)
-        || !read_u8(&buffer, &buffer_length, &sender_type),
-        ERROR_READ
-    );
-
-    // Read the recipient
-    uint8_t *recipient, recipient_type;
-    RETURN_ON_ERROR(
-        !read_sub_buffer(20, &buffer, &buffer_length, &recipient)
-        || !read_u8(&buffer, &buffer_length, &recipient_type),
-        ERROR_READ
-    );
-
-    // Process the value field
-    uint64_t value;
-    RETURN_ON_ERROR(
-        !read_u64(&buffer, &buffer_length, &value),
-        ERROR_READ
-    );
-    PRINTF("value: %u\n", value);
-    RETURN_ON_ERROR(
-        parse_amount(value, "NIM", out->value)
-    );
-    PRINTF("amount: %s\n", out->value);
-
-    // Process the fee field
-    uint64_t fee;
-    RETURN_ON_ERROR(
-        !read_u64(&buffer, &buffer_length, &fee),
-        ERROR_READ
-    );
-    PRINTF("fee: %u\n", fee);
-    RETURN_ON_ERROR(
-        parse_amount(fee, "NIM", out->fee)
-    );
-    PRINTF("fee amount: %s\n", out->fee);
-
-    // Read the validity start height
-    uint32_t validity_start_height;
-    RETURN_ON_ERROR(
-        !read_u32(&buffer, &buffer_length, &validity_start_height),
-        ERROR_READ
-    );
-
-    // Process the network field
-    uint8_t network_id;
-    RETURN_ON_ERROR(
-        !read_u8(&buffer, &buffer_length, &network_id),
-        ERROR_READ
-    );
-    RETURN_ON_ERROR(
-        parse_network_id(version, network_id, out->network)
-    );
-
-    // Process the flags field
-    uint8_t flags;
-    RETURN_ON_ERROR(
-        !read_u8(&buffer, &buffer_length, &flags),
-        ERROR_READ
-    );
-    PRINTF("flags: %u\n", flags);
-
-    // Read the sender data
-    uint16_t sender_data_length = 0;
-    uint8_t *sender_data = NULL;
-    if (version == TRANSACTION_VERSION_ALBATROSS) {
-        RETURN_ON_ERROR(
-            !read_serde_vec_u8(&buffer, &buffer_length, &sender_data, &sender_data_length),
-            ERROR_READ
-        );
-        PRINTF("sender data length: %u\n", sender_data_length);
-    }
-
-    RETURN_ON_ERROR(
-        buffer_length != 0,
-        ERROR_INVALID_LENGTH,
-        "Transaction too long\n"
-    );
-
-    // Note: the transaction validity checks here are mostly for good measure and not entirely thorough or strict as
-    // they don't need to be, because an invalid transaction will be rejected by the network nodes, even if we let it
-    // pass here in the app.
-
-    if (sender_type == ACCOUNT_TYPE_STAKING) {
-        // Outgoing staking transaction from the staking contract.
+    if (state->sender_type == ACCOUNT_TYPE_STAKING) {
+        // Outgoing staking transaction from the staking contract. The transaction type is determined from the sender
+        // data, see parse_tx_sender_data.
         RETURN_ON_ERROR(
             // Would theoretically be allowed, but we don't support that yet. E.g. we don't support an unstaking tx to
             // at the same time create a contract. It can also not be a transaction to the staking contract, because
             // the sender and recipient address can not be the same.
-            flags || data_length,
+            state->flags || state->data_length,
             ERROR_NOT_SUPPORTED,
             "Invalid flags or recipient data\n"
         );
@@ -871,61 +417,42 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
             ERROR_INCORRECT_DATA,
             "Sender must be staking contract\n"
         );
-
-        staking_outgoing_data_type_t staking_outgoing_type;
-        RETURN_ON_ERROR(
-            parse_staking_outgoing_data(version, sender_data, sender_data_length, &staking_outgoing_type)
-        );
         out->transaction_type = TRANSACTION_TYPE_STAKING_OUTGOING;
 
-        switch (staking_outgoing_type) {
-            case REMOVE_STAKE:
-                out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_REMOVE_STAKE;
-                break;
-            default:
-                // Note that validator transactions are not supported yet.
-                RETURN_ERROR(
-                    ERROR_NOT_SUPPORTED,
-                    "Invalid outgoing staking transaction data type\n"
-                );
-        }
-
-        // Print the recipient address and set unused data to empty string.
-        RETURN_ON_ERROR(
-            print_address(recipient, out->type_specific.normal_or_staking_outgoing_tx.recipient)
-        );
-        COPY_FIXED_SIZE(out->type_specific.normal_or_staking_outgoing_tx.extra_data_label, "");
-        COPY_FIXED_SIZE(out->type_specific.normal_or_staking_outgoing_tx.extra_data, "");
+        // Store the recipient address; there is no data to display.
+        out->type_specific.normal_or_staking_outgoing_tx.recipient = recipient;
+        out->type_specific.normal_or_staking_outgoing_tx.extra_data = NULL;
+        out->type_specific.normal_or_staking_outgoing_tx.extra_data_length = 0;
+        out->type_specific.normal_or_staking_outgoing_tx.is_extra_data_hex = false;
 
         return ERROR_NONE;
     }
 
-    switch (recipient_type) {
+    switch (state->recipient_type) {
         case ACCOUNT_TYPE_BASIC: {
             RETURN_ON_ERROR(
-                // Signaling flag and sender data might theoretically be allowed, but we don't support that yet.
-                flags || sender_data_length,
+                // Signaling flag might theoretically be allowed, but we don't support that yet.
+                state->flags,
                 ERROR_NOT_SUPPORTED,
-                "Invalid flags or sender data\n"
+                "Invalid flags\n"
             );
 
             bool is_cashlink;
             RETURN_ON_ERROR(
-                parse_normal_tx_data(data, data_length, &out->type_specific.normal_or_staking_outgoing_tx, &is_cashlink)
+                parse_normal_tx_data(data, state->data_length, &out->type_specific.normal_or_staking_outgoing_tx,
+                    &is_cashlink)
             );
-            PRINTF("data: %s - is Cashlink: %d\n", out->type_specific.normal_or_staking_outgoing_tx.extra_data,
-                is_cashlink);
+            PRINTF("data length: %u - is Cashlink: %d\n",
+                out->type_specific.normal_or_staking_outgoing_tx.extra_data_length, is_cashlink);
 
             out->transaction_type = TRANSACTION_TYPE_NORMAL;
             out->transaction_label_type = is_cashlink
                 ? TRANSACTION_LABEL_TYPE_CASHLINK
                 : TRANSACTION_LABEL_TYPE_REGULAR_TRANSACTION;
 
-            // Print the recipient address
+            // Store the recipient address
             // We're ignoring the sender, as it's not too relevant where the funds are coming from.
-            RETURN_ON_ERROR(
-                print_address(recipient, out->type_specific.normal_or_staking_outgoing_tx.recipient)
-            );
+            out->type_specific.normal_or_staking_outgoing_tx.recipient = recipient;
             break;
         }
 
@@ -933,26 +460,25 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
         case ACCOUNT_TYPE_HTLC: {
             RETURN_ON_ERROR(
                 // Contract creation flag must be set, and no other flags are allowed at the same time.
-                // Sender data would theoretically be allowed, but we don't currently support that.
-                flags != TX_FLAG_CONTRACT_CREATION || sender_data_length,
+                state->flags != TX_FLAG_CONTRACT_CREATION,
                 ERROR_NOT_SUPPORTED,
-                "Invalid flags or sender data\n"
+                "Invalid flags\n"
             );
 
             // Note that we're ignoring the recipient address for contract creation transactions as it must be the
             // deterministically calculated contract address, otherwise it's an invalid transaction rejected by the
             // network nodes.
-            if (recipient_type == ACCOUNT_TYPE_VESTING) {
+            if (state->recipient_type == ACCOUNT_TYPE_VESTING) {
                 RETURN_ON_ERROR(
-                    parse_vesting_creation_data(version, data, data_length, sender, sender_type, value,
-                        &out->type_specific.vesting_creation_tx)
+                    parse_vesting_creation_data(version, data, state->data_length, sender, state->sender_type,
+                        out->value, &out->type_specific.vesting_creation_tx)
                 );
                 out->transaction_type = TRANSACTION_TYPE_VESTING_CREATION;
                 out->transaction_label_type = TRANSACTION_LABEL_TYPE_VESTING_CREATION;
             } else { // ACCOUNT_TYPE_HTLC
                 RETURN_ON_ERROR(
-                    parse_htlc_creation_data(version, data, data_length, sender, sender_type, validity_start_height,
-                        &out->type_specific.htlc_creation_tx)
+                    parse_htlc_creation_data(version, data, state->data_length, sender, state->sender_type,
+                        state->validity_start_height, &out->type_specific.htlc_creation_tx)
                 );
                 out->transaction_type = TRANSACTION_TYPE_HTLC_CREATION;
                 out->transaction_label_type = TRANSACTION_LABEL_TYPE_HTLC_CREATION;
@@ -964,10 +490,9 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
             // Incoming staking transaction to the staking contract.
             RETURN_ON_ERROR(
                 // Flags must be either unset or the signaling flag.
-                // Sender data would theoretically be allowed, but we don't currently support that.
-                (flags && flags != TX_FLAG_SIGNALING) || sender_data_length,
+                state->flags && state->flags != TX_FLAG_SIGNALING,
                 ERROR_NOT_SUPPORTED,
-                "Invalid flags or sender data\n"
+                "Invalid flags\n"
             );
             RETURN_ON_ERROR(
                 !is_staking_contract(recipient),
@@ -976,12 +501,27 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
             );
 
             RETURN_ON_ERROR(
-                parse_staking_incoming_data(version, data, data_length, sender,
-                    &out->type_specific.staking_incoming_tx)
+                parse_staking_incoming_data(version, data, retained_data_length, sender,
+                    state->streamed_voting_key_fingerprint, &out->type_specific.staking_incoming_tx)
             );
             out->transaction_type = TRANSACTION_TYPE_STAKING_INCOMING;
 
             switch (out->type_specific.staking_incoming_tx.type) {
+                case CREATE_VALIDATOR:
+                    out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_CREATE_VALIDATOR;
+                    break;
+                case UPDATE_VALIDATOR:
+                    out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_UPDATE_VALIDATOR;
+                    break;
+                case DEACTIVATE_VALIDATOR:
+                    out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_DEACTIVATE_VALIDATOR;
+                    break;
+                case REACTIVATE_VALIDATOR:
+                    out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_REACTIVATE_VALIDATOR;
+                    break;
+                case RETIRE_VALIDATOR:
+                    out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_RETIRE_VALIDATOR;
+                    break;
                 case CREATE_STAKER:
                     out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_CREATE_STAKER;
                     break;
@@ -998,7 +538,6 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
                     out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_RETIRE_STAKE;
                     break;
                 default:
-                    // Note that validator transactions are not supported yet.
                     RETURN_ERROR(
                         ERROR_NOT_SUPPORTED,
                         "Invalid incoming staking transaction data type\n"
@@ -1006,7 +545,7 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
             }
 
             RETURN_ON_ERROR(
-                (flags == TX_FLAG_SIGNALING)
+                (state->flags == TX_FLAG_SIGNALING)
                     != is_signaling_transaction_data(out->type_specific.staking_incoming_tx.type),
                 ERROR_INCORRECT_DATA,
                 "Signaling flag mismatch\n"
@@ -1015,6 +554,7 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
         }
 
         default:
+            // Should not happen, as the recipient type was already checked when it was read.
             RETURN_ERROR(
                 ERROR_INCORRECT_DATA,
                 "Invalid recipient type\n"
@@ -1024,9 +564,390 @@ error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer
     return ERROR_NONE;
 }
 
-bool is_printable_ascii(uint8_t *data, uint16_t data_length) {
-    for (uint16_t i = 0; i < data_length; i++) {
-        if ((data[i] < /* space */ 32) || (data[i] > /* tilde */ 126)) return false;
+WARN_UNUSED_RESULT
+static error_t parse_tx_sender_data(tx_parser_state_t *state, transaction_version_t version, uint8_t *sender_data,
+    parsed_tx_t *out) {
+    if (state->sender_type != ACCOUNT_TYPE_STAKING) {
+        RETURN_ON_ERROR(
+            // Sender data would theoretically be allowed, but we don't currently support that.
+            state->sender_data_length,
+            ERROR_NOT_SUPPORTED,
+            "Invalid sender data\n"
+        );
+        return ERROR_NONE;
+    }
+
+    staking_outgoing_data_type_t staking_outgoing_type;
+    RETURN_ON_ERROR(
+        parse_staking_outgoing_data(version, sender_data, state->sender_data_length, &staking_outgoing_type)
+    );
+    switch (staking_outgoing_type) {
+        case DELETE_VALIDATOR:
+            out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_DELETE_VALIDATOR;
+            break;
+        case REMOVE_STAKE:
+            out->transaction_label_type = TRANSACTION_LABEL_TYPE_STAKING_REMOVE_STAKE;
+            break;
+        default:
+            RETURN_ERROR(
+                ERROR_NOT_SUPPORTED,
+                "Invalid outgoing staking transaction data type\n"
+            );
+    }
+    return ERROR_NONE;
+}
+
+// Determine which optional values of a parsed transaction are displayed for review, see tx_display_flag_t.
+//
+// HTLC creation:
+// As HTLCs are quite technical, we try to not display the less relevant information to the user.
+// Considerations for which data can be safely skipped under which circumstances:
+// - transaction recipient address (not to be confused with the htlc recipient address, also called redeem address):
+//   The recipient address for the contract creation must be the contract address which is deterministically calculated
+//   from the other transaction parameters. Any transaction with a different recipient address than the expected address
+//   is rejected by the Nimiq network which does therefore not need to be displayed or checked.
+// - htlc refund address (also called htlc sender; not to be confused with the transaction sender):
+//   If the refund address equals the transaction sender, we omit display because then the funds can be refunded to
+//   where they came from, which is an address of a BasicAccount or MultiSig under (partial) control of this Ledger.
+//   Note that any other address under the control of this Ledger could also be whitelisted, but currently the refund
+//   address being equal to the transaction sender is the normal case in our current use cases and whitelisting other
+//   Ledger addresses would require transmitting the refund address key path with the request, such that we can verify
+//   that the address is one under control of this Ledger.
+// - hash algorithm:
+//   As the user confirms the hash root, an attacker trying to let the user create a htlc with the wrong hash algorithm
+//   would need to know the pre-image for the hash root for the specified algorithm to be able to gain access to the
+//   funds which is close to impossible unless he's the legitimate recipient anyways who specified the confirmed hash
+//   root. The worst that can happen, is that the funds are locked until the timeout at which point they can be redeemed
+//   by the refund address owner. To avoid that the refund address owner as attacker could take advantage of making it
+//   impossible for the redeem address owner to redeem the funds, we skip the hash algorithm display only if the refund
+//   address is our address (see above). As an additional restriction, we also skip the display of the hash algorithm
+//   only if it's sha256 which is the commonly used hash algorithm and if the funds are not locked for a long time.
+// - hash count (here called hash steps):
+//   Specifying a lower hash count than the actual intended hash count allows the htlc redeem address owner as attacker
+//   to redeem more funds per pre-image step than intended. However, if the user's machine creating the manipulated
+//   transaction to be signed on the Ledger is compromised, also usually the htlc secret (unhashed pre-image) which is
+//   usually on the same machine is compromised such that the hash count doesn't matter anymore. I.e. if the htlc secret
+//   is compromised, the hash count yields no protection of the funds anymore.
+//   Specifying a higher hash count than the intended one effectively locks part of the funds for the redeem address
+//   owner until they become available to the refund address owner after the timeout. To avoid that the refund address
+//   owner as attacker could take advantage of blocking funds to the redeem address owner, we skip the display of the
+//   hash count only if the refund address is our address (see above). Additionally, to avoid that funds are potentially
+//   locked via a higher hash count for a long time, we only skip the display for short timeouts. However, as blocking
+//   the funds requires a higher hash count than the actual one, for 1, the lowest possible hash count, we never have to
+//   display it.
+// - timeout (here called htlc expiry block):
+//   The timeout specifies for how long funds will be locked if not redeemed until they are refundable. As short
+//   timeouts (which should be the case for most practically used htlcs) are favorable for the user if the refund
+//   address is his, we don't display short timeouts. To avoid that another refund address owner as attacker could take
+//   advantage of a short or already passed timeout, we skip the timeout display only if the refund address is our
+//   address (see above).
+//
+// Vesting contract creation:
+// Other than for HTLCs we generally do not try to skip less relevant data as vesting contracts are only rarely created
+// and all parameters are similarly important. However, depending on the specific vesting contract parameters, some data
+// is redundant. Specifically, we have the following optimizations:
+// - vesting owner:
+//   Display of the vesting owner address is skipped if it equals the transaction sender address.
+// - for 0 steps (all funds are pre-vested):
+//   We only show the info about the pre-vested amount and skip all other data.
+// - for 1 step (all funds unlock at a specific block):
+//   We show a special entry with the vesting block. Additionally, the step for a pre-vested amount might be shown. All
+//   other info is redundant and skipped.
+// - for 2 steps:
+//   If first step amount and last step amount differ from regular step amount, do not display what would be the regular
+//   step amount as all steps differ from that.
+//
+// Incoming staking transactions (transactions to the staking contract):
+// Considerations for which data can be safely skipped under which circumstances:
+// - 0 NIM transaction amount for signaling transactions. If the incoming staking data includes an amount, that is shown
+//   instead.
+// - transaction recipient address as this must be the staking contract.
+// - validator address (from validator signature proof): is always displayed as validator management is considered an
+//   advanced feature, where the user probably wants to have a complete overview of the transaction data. It's also not
+//   a very regularly occurring / common transaction.
+// - staker address (from staker signature proof): If the staker address equals the transaction sender, we omit display
+//   because then the staker is under control of the user / this Ledger (in case of multi-sig, partial control). This is
+//   also the most common case. We don't need to check that the sender address actually belongs to the Ledger account as
+//   a signature for a wrong sender address will be rejected by the network. This also covers contracts as sender as the
+//   staker address can't really be the contract address because for the deterministic contract address, no signing key
+//   is known which could create the valid staker signature proof. Also, multi-sig sender addresses are covered, i.e.
+//   the multi-sig signed transactions also assume the multi-sig as staker owner by default. The multi-sig staker address
+//   is computed from the non-empty merkle path of the staker signature proof, see compute_signature_proof_signer. Note
+//   that any other address under the control of this Ledger could also be whitelisted, but currently the staker address
+//   being equal to the transaction sender is the normal case in our current use cases and whitelisting other Ledger
+//   addresses would require transmitting the staker address key path with the request, such that we can verify that
+//   the address is one under control of this Ledger.
+// - no other parts of the signature proof need to be displayed to the user as invalid signature proofs will be rejected
+//   by the network nodes.
+// - delegation addresses: are always displayed as the assumption is that common, non-advanced users would not delegate
+//   to themselves, and advanced users would like to see this information, even if delegating to themselves.
+// - validator signing key, reward address and signal data: are displayed if they are set by a validator creation or
+//   changed by a validator update. The signing key and signal data are displayed as hex.
+// - validator voting key: the BLS voting key is 285 bytes long, which would be 570 hex chars, i.e. far too long to be
+//   reasonably verified by the user on the device. Instead, its 32 byte Blake2b hash is displayed as fingerprint, which
+//   the user can compare to the hash of the voting key of their validator node.
+// - validator proof of knowledge of the voting key: is not displayed as an invalid proof is rejected by the network
+//   nodes.
+static uint32_t compute_tx_display_plan(const parsed_tx_t *tx) {
+    uint32_t plan = 0;
+    // The transaction amount can be 0 for signaling transactions, in which case we want to show the amount given in the
+    // IncomingStakingTransactionData instead, if applicable.
+    if (tx->value != 0) plan |= TX_DISPLAY_AMOUNT;
+    if (tx->fee != 0) plan |= TX_DISPLAY_FEE;
+
+    switch (tx->transaction_type) {
+        case TRANSACTION_TYPE_NORMAL:
+        case TRANSACTION_TYPE_STAKING_OUTGOING: {
+            const tx_data_normal_or_staking_outgoing_t *normal_tx = &tx->type_specific.normal_or_staking_outgoing_tx;
+            if (normal_tx->extra_data) {
+                plan |= normal_tx->is_extra_data_hex
+                    ? TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_HEX
+                    : TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_ASCII;
+            }
+            break;
+        }
+
+        case TRANSACTION_TYPE_HTLC_CREATION: {
+            const tx_data_htlc_creation_t *htlc = &tx->type_specific.htlc_creation_tx;
+            bool is_short_self_refundable = htlc->is_refund_address_sender_address && htlc->is_timing_out_soon;
+            if (!htlc->is_refund_address_sender_address) plan |= TX_DISPLAY_HTLC_CREATION_REFUND_ADDRESS;
+            if (!is_short_self_refundable || htlc->hash_algorithm != HASH_ALGORITHM_SHA256) {
+                plan |= TX_DISPLAY_HTLC_CREATION_HASH_ALGORITHM;
+            }
+            if (htlc->hash_count != 1 && !is_short_self_refundable) plan |= TX_DISPLAY_HTLC_CREATION_HASH_COUNT;
+            if (!is_short_self_refundable) plan |= TX_DISPLAY_HTLC_CREATION_TIMEOUT;
+            break;
+        }
+
+        case TRANSACTION_TYPE_VESTING_CREATION: {
+            const tx_data_vesting_creation_t *vesting = &tx->type_specific.vesting_creation_tx;
+            if (!vesting->is_owner_address_sender_address) plan |= TX_DISPLAY_VESTING_CREATION_OWNER_ADDRESS;
+            if (vesting->step_count <= 1) {
+                // simplified ui for step_count == 1 case
+                plan |= TX_DISPLAY_VESTING_CREATION_SINGLE_VESTING_BLOCK;
+            } else {
+                plan |= TX_DISPLAY_VESTING_CREATION_SCHEDULE;
+                // The first step duration is different from the regular step duration.
+                if (vesting->first_step_block_count != vesting->step_block_count) {
+                    plan |= TX_DISPLAY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT;
+                }
+                // Skip if step_count == 2 and both steps differ from what would be the regular step amount.
+                if (!(vesting->step_count == 2 && vesting->first_step_amount != vesting->step_amount
+                    && vesting->last_step_amount != vesting->step_amount)) {
+                    plan |= TX_DISPLAY_VESTING_CREATION_STEP_AMOUNT;
+                }
+                // The first or last step amount is different from the regular step amount.
+                if (vesting->first_step_amount != vesting->step_amount) {
+                    plan |= TX_DISPLAY_VESTING_CREATION_FIRST_STEP_AMOUNT;
+                }
+                if (vesting->last_step_amount != vesting->step_amount) {
+                    plan |= TX_DISPLAY_VESTING_CREATION_LAST_STEP_AMOUNT;
+                }
+            }
+            if (vesting->pre_vested_amount != 0) plan |= TX_DISPLAY_VESTING_CREATION_PRE_VESTED_AMOUNT;
+            break;
+        }
+
+        case TRANSACTION_TYPE_STAKING_INCOMING: {
+            const tx_data_staking_incoming_t *staking = &tx->type_specific.staking_incoming_tx;
+            switch (staking->type) {
+                case SET_ACTIVE_STAKE:
+                case RETIRE_STAKE:
+                    // Signaling transactions which specify an amount in the data. The regular transaction amount is 0,
+                    // and not displayed.
+                    plan |= TX_DISPLAY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT;
+                    // fall through
+                case CREATE_STAKER:
+                case ADD_STAKE:
+                case UPDATE_STAKER:
+                    // Staker transactions, for which the staker address is set if it's different to the sender.
+                    if (staking->has_validator_or_staker_address) plan |= TX_DISPLAY_STAKING_INCOMING_STAKER_ADDRESS;
+                    break;
+                default:
+                    break;
+            }
+            if ((staking->type == CREATE_STAKER || staking->type == UPDATE_STAKER)
+                && staking->create_staker_or_update_staker.delegation) {
+                plan |= TX_DISPLAY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION;
+            }
+            if (staking->type == UPDATE_STAKER) plan |= TX_DISPLAY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE;
+            // Show for all validator transactions, see considerations above.
+            if (is_validator_transaction_data(staking->type)) plan |= TX_DISPLAY_STAKING_INCOMING_VALIDATOR_ADDRESS;
+            if (staking->type == CREATE_VALIDATOR || staking->type == UPDATE_VALIDATOR) {
+                if (staking->create_validator_or_update_validator.signing_key) {
+                    plan |= TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY;
+                }
+                if (staking->create_validator_or_update_validator.has_voting_key) {
+                    plan |= TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT;
+                }
+                if (staking->create_validator_or_update_validator.reward_address) {
+                    plan |= TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS;
+                }
+                // Show if signal data is set, or if it's cleared by an update.
+                if (staking->create_validator_or_update_validator.signal_data
+                    || staking->create_validator_or_update_validator.is_signal_data_cleared) {
+                    plan |= TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA;
+                }
+            }
+            break;
+        }
+    }
+    return plan;
+}
+
+WARN_UNUSED_RESULT
+error_t parse_tx_chunk(tx_parser_state_t *state, transaction_version_t version, uint8_t *buffer,
+    uint16_t buffer_length, bool is_last_chunk, parsed_tx_t *out) {
+    RETURN_ON_ERROR(
+        version != TRANSACTION_VERSION_LEGACY && version != TRANSACTION_VERSION_ALBATROSS,
+        ERROR_NOT_SUPPORTED,
+        "Unsupported transaction version\n"
+    );
+    LEDGER_ASSERT(
+        state->offset <= buffer_length && state->stage <= TX_PARSER_STAGE_END,
+        "Invalid transaction parser state"
+    );
+
+    // Each stage first checks that all its bytes are available, such that a stage is always processed entirely, and the
+    // parser can continue at state->offset, once more data arrived.
+    buffer_reader_t reader = reader_init(buffer + state->offset, buffer_length - state->offset);
+    for (;;) {
+        switch (state->stage) {
+            case TX_PARSER_STAGE_DATA_LENGTH:
+                if (reader.remaining_length < 2) goto incomplete;
+                state->data_length = reader_read_u16(&reader);
+                PRINTF("data length: %u\n", state->data_length);
+                RETURN_ON_ERROR(
+                    // In streamed signing mode, the data is not kept entirely, and the size of the retained data is
+                    // checked by the caller instead.
+                    !state->streamed_voting_key_fingerprint && /* data length */ 2 + state->data_length > MAX_RAW_TX,
+                    ERROR_INVALID_LENGTH,
+                    "Transaction too long\n"
+                );
+                state->stage = TX_PARSER_STAGE_DATA;
+                break;
+
+            case TX_PARSER_STAGE_DATA:
+                // Only skipped here, and processed once the recipient type is known. In streamed signing mode, the
+                // retained data is complete, once the retained and streamed bytes add up to the data length, as data
+                // is retained and streamed in order, and the following fields are only received after the data.
+                if (reader.remaining_length < state->data_length - state->streamed_data_length) goto incomplete;
+                reader_advance(&reader, state->data_length - state->streamed_data_length);
+                state->stage = TX_PARSER_STAGE_SENDER_AND_RECIPIENT;
+                break;
+
+            case TX_PARSER_STAGE_SENDER_AND_RECIPIENT:
+                if (reader.remaining_length < /* sender and type */ 21 + /* recipient and type */ 21) goto incomplete;
+                reader_advance(&reader, 20); // sender, accessed later via its known offset
+                state->sender_type = reader_read_u8(&reader);
+                reader_advance(&reader, 20); // recipient, accessed later via its known offset
+                state->recipient_type = reader_read_u8(&reader);
+                RETURN_ON_ERROR(
+                    state->recipient_type != ACCOUNT_TYPE_BASIC && state->recipient_type != ACCOUNT_TYPE_VESTING
+                    && state->recipient_type != ACCOUNT_TYPE_HTLC && state->recipient_type != ACCOUNT_TYPE_STAKING,
+                    ERROR_INCORRECT_DATA,
+                    "Invalid recipient type\n"
+                );
+                state->stage = TX_PARSER_STAGE_VALUE_AND_FEE;
+                break;
+
+            case TX_PARSER_STAGE_VALUE_AND_FEE: {
+                if (reader.remaining_length < /* value */ 8 + /* fee */ 8) goto incomplete;
+                out->value = reader_read_u64(&reader);
+                out->fee = reader_read_u64(&reader);
+                PRINTF("value: %u\n", out->value);
+                PRINTF("fee: %u\n", out->fee);
+                RETURN_ON_ERROR(
+                    check_amount(out->value)
+                );
+                RETURN_ON_ERROR(
+                    check_amount(out->fee)
+                );
+                state->stage = TX_PARSER_STAGE_VALIDITY_START_HEIGHT_NETWORK_AND_FLAGS;
+                break;
+            }
+
+            case TX_PARSER_STAGE_VALIDITY_START_HEIGHT_NETWORK_AND_FLAGS: {
+                if (reader.remaining_length < /* validity start height */ 4 + /* network */ 1 + /* flags */ 1) {
+                    goto incomplete;
+                }
+                state->validity_start_height = reader_read_u32(&reader);
+                uint8_t network_id = reader_read_u8(&reader);
+                state->flags = reader_read_u8(&reader);
+                RETURN_ON_ERROR(
+                    parse_network_id(version, network_id, &out->network)
+                );
+                PRINTF("flags: %u\n", state->flags);
+
+                // All fields the recipient data depends on are known now.
+                RETURN_ON_ERROR(
+                    parse_tx_recipient_data(state, version, buffer, out)
+                );
+                if (version == TRANSACTION_VERSION_ALBATROSS) {
+                    state->stage = TX_PARSER_STAGE_SENDER_DATA_LENGTH;
+                } else {
+                    // Legacy transactions don't have sender data.
+                    RETURN_ON_ERROR(
+                        parse_tx_sender_data(state, version, NULL, out)
+                    );
+                    state->stage = TX_PARSER_STAGE_END;
+                }
+                break;
+            }
+
+            case TX_PARSER_STAGE_SENDER_DATA_LENGTH: {
+                // The varint is complete, once a byte without continuation bit is available, or the maximum length of
+                // a varint encoded u16 is reached.
+                uint8_t varint_length = 0;
+                while (varint_length < reader.remaining_length && varint_length < 3
+                    && (reader.position[varint_length++] & 0x80));
+                if (!varint_length || (varint_length < 3 && (reader.position[varint_length - 1] & 0x80))) {
+                    goto incomplete;
+                }
+                state->sender_data_length = (uint16_t) reader_read_serde_uvarint(&reader, 16);
+                RETURN_ON_ERROR(
+                    reader.has_error,
+                    ERROR_READ
+                );
+                PRINTF("sender data length: %u\n", state->sender_data_length);
+                state->stage = TX_PARSER_STAGE_SENDER_DATA;
+                break;
+            }
+
+            case TX_PARSER_STAGE_SENDER_DATA:
+                if (reader.remaining_length < state->sender_data_length) goto incomplete;
+                RETURN_ON_ERROR(
+                    parse_tx_sender_data(state, version, reader_read_sub_buffer(&reader, state->sender_data_length),
+                        out)
+                );
+                state->stage = TX_PARSER_STAGE_END;
+                break;
+
+            case TX_PARSER_STAGE_END:
+                RETURN_ON_ERROR(
+                    reader.remaining_length != 0,
+                    ERROR_INVALID_LENGTH,
+                    "Transaction too long\n"
+                );
+                out->display_plan = compute_tx_display_plan(out);
+                return ERROR_NONE;
+
+        }
+        // The stage has been processed entirely. Continue with the next stage.
+        state->offset = buffer_length - reader.remaining_length;
     }
-    return true;
+
+incomplete:
+    RETURN_ON_ERROR(
+        is_last_chunk,
+        ERROR_READ,
+        "Transaction incomplete\n"
+    );
+    return ERROR_NONE;
+}
+
+WARN_UNUSED_RESULT
+error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer_length, parsed_tx_t *out) {
+    tx_parser_state_t state = { 0 };
+    return parse_tx_chunk(&state, version, buffer, buffer_length, /* is_last_chunk */ true, out);
 }
@@ -25,6 +25,8 @@
 #include "utility_macros.h"
 #include "error_macros.h"
 #include "nimiq_staking_utils.h"
+#include "user_friendly_address.h"
+#include "printing.h"
 
 #define LENGTH_NORMAL_TX_DATA_MAX 64
 // Ascii (1 char per byte + string terminator) or hex (2 char per byte + string terminator).
@@ -35,50 +37,88 @@
 //  reduced, thus ui steps skipped for short timeouts will be displayed even though we could skip them.
 #define HTLC_TIMEOUT_SOON_THRESHOLD (60 * 24 * 31 * 2); // ~ 2 months at 1 minute block time
 
-// Data printed for display.
+// Hash root can be up to 64 bytes; printed as hex + string terminator.
+#define STRING_LENGTH_HTLC_HASH_ROOT (64 * 2 + 1)
+
+// Validator signing keys, voting key fingerprints and signal data are 32 bytes; printed as hex + string terminator.
+#define STRING_LENGTH_VALIDATOR_KEY_OR_HASH (32 * 2 + 1)
+
+// Parsed transaction data.
 // Note that this does not include any information about where the funds are coming from (a regular account, htlc,
 // vesting contract, which address, ...) as this is not too relevant for the user and also not displayed by other apps
 // like the Bitcoin app.
-// Also note that while pre-processing all the data is nice, it's a bit wasteful in allocated memory usage. If we'd run
-// into issues with low memory, we should switch to printing data on demand in the flow ux steps' init methods.
+// Also note that the data is not pre-printed for display, but stored in binary form, either as pointers into the raw
+// transaction or as integers, and only printed on demand, when it is displayed, see ux_transaction_print_entry. This
+// saves the RAM of the worst case sized strings of all values, of which only few are displayed at a time.
 
 typedef struct {
-    char recipient[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
-    char extra_data_label[MAX(sizeof("Data"), sizeof("Data Hex"))];
-    char extra_data[STRING_LENGTH_NORMAL_TX_DATA_MAX];
+    uint8_t *recipient; // pointer to the 20 byte recipient address in the raw transaction
+    uint8_t *extra_data; // pointer to the extra data in the raw transaction, NULL if there is no data to display
+    uint8_t extra_data_length;
+    bool is_extra_data_hex; // whether the extra data is displayed as hex, because it is not printable ascii
 } tx_data_normal_or_staking_outgoing_t;
 
 typedef struct {
     bool is_refund_address_sender_address;
     bool is_timing_out_soon;
-    bool is_using_sha256;
-    char redeem_address[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
-    char refund_address[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
-    char hash_root[64 * 2 + 1]; // hash root can be up to 64 bytes; display as hex + string terminator needs 129 chars
-    char hash_algorithm[MAX(sizeof("BLAKE2b"), MAX(sizeof("SHA-256"), sizeof("SHA-512")))];
-    char hash_count[STRING_LENGTH_UINT8];
-    char timeout[STRING_LENGTH_UINT32];
+    hash_algorithm_t hash_algorithm;
+    uint8_t hash_count;
+    uint32_t timeout;
+    uint8_t *redeem_address; // pointer to the 20 byte address in the raw transaction
+    uint8_t *refund_address; // pointer to the 20 byte address in the raw transaction
+    uint8_t *hash_root; // pointer to the 32 or 64 byte hash root in the raw transaction, depending on hash_algorithm
 } tx_data_htlc_creation_t;
 
 typedef struct {
     bool is_owner_address_sender_address;
-    bool is_multi_step;
-    char owner_address[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
-    char start_block[STRING_LENGTH_UINT32];
-    char period[STRING_LENGTH_WITH_SUFFIX(STRING_LENGTH_UINT32, " blocks")];
-    char step_count[STRING_LENGTH_UINT32];
-    char step_block_count[STRING_LENGTH_WITH_SUFFIX(STRING_LENGTH_UINT32, " blocks")];
-    // Note: first_step_block_count, first_step_block, first_step_amount and pre_vested_amount are not all needed at the
-    // same time and could therefore be moved into a union to save some memory. As however tx_data_htlc_creation_t in
-    // the parsed_tx_t.type_specific union is bigger anyways, we currently don't have to do this optimization.
-    char first_step_block_count[STRING_LENGTH_WITH_SUFFIX(STRING_LENGTH_UINT32, " blocks")];
-    char first_step_block[STRING_LENGTH_UINT32];
-    char step_amount[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
-    char first_step_amount[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
-    char last_step_amount[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
-    char pre_vested_amount[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
+    uint8_t *owner_address; // pointer to the 20 byte address in the raw transaction
+    uint32_t start_block;
+    uint32_t period;
+    uint32_t step_count;
+    uint32_t step_block_count;
+    uint32_t first_step_block_count;
+    uint64_t step_amount;
+    uint64_t first_step_amount;
+    uint64_t last_step_amount;
+    uint64_t pre_vested_amount;
 } tx_data_vesting_creation_t;
 
+// Flags of the display plan of a parsed transaction, see parsed_tx_t.display_plan. A flag is set if the respective
+// optional value is displayed for review. Values which are always displayed for their transaction type, like the
+// recipient of a normal transaction or the network, have no flag.
+typedef enum {
+    TX_DISPLAY_AMOUNT = 1 << 0,
+    TX_DISPLAY_FEE = 1 << 1,
+
+    TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_ASCII = 1 << 2,
+    TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_HEX = 1 << 3,
+
+    TX_DISPLAY_HTLC_CREATION_REFUND_ADDRESS = 1 << 4,
+    TX_DISPLAY_HTLC_CREATION_HASH_ALGORITHM = 1 << 5,
+    TX_DISPLAY_HTLC_CREATION_HASH_COUNT = 1 << 6,
+    TX_DISPLAY_HTLC_CREATION_TIMEOUT = 1 << 7,
+
+    TX_DISPLAY_VESTING_CREATION_OWNER_ADDRESS = 1 << 8,
+    TX_DISPLAY_VESTING_CREATION_SINGLE_VESTING_BLOCK = 1 << 9,
+    // start block, period, step count and step block count
+    TX_DISPLAY_VESTING_CREATION_SCHEDULE = 1 << 10,
+    TX_DISPLAY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT = 1 << 11,
+    TX_DISPLAY_VESTING_CREATION_STEP_AMOUNT = 1 << 12,
+    TX_DISPLAY_VESTING_CREATION_FIRST_STEP_AMOUNT = 1 << 13,
+    TX_DISPLAY_VESTING_CREATION_LAST_STEP_AMOUNT = 1 << 14,
+    TX_DISPLAY_VESTING_CREATION_PRE_VESTED_AMOUNT = 1 << 15,
+
+    TX_DISPLAY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT = 1 << 16,
+    TX_DISPLAY_STAKING_INCOMING_STAKER_ADDRESS = 1 << 17,
+    TX_DISPLAY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION = 1 << 18,
+    TX_DISPLAY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE = 1 << 19,
+    TX_DISPLAY_STAKING_INCOMING_VALIDATOR_ADDRESS = 1 << 20,
+    TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY = 1 << 21,
+    TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT = 1 << 22,
+    TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS = 1 << 23,
+    TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA = 1 << 24,
+} tx_display_flag_t;
+
 typedef struct {
     union {
         tx_data_normal_or_staking_outgoing_t normal_or_staking_outgoing_tx;
@@ -89,30 +129,64 @@ typedef struct {
 
     transaction_type_t transaction_type;
     transaction_label_type_t transaction_label_type;
-#ifdef HAVE_BAGL
-    char transaction_label[MAX(
-        sizeof("Transaction"), MAX(
-        sizeof("Cashlink"), MAX(
-        sizeof("Vesting"), MAX(
-        sizeof("HTLC / Swap"), MAX(
-        sizeof("Create Staker"), MAX(
-        sizeof("Add Stake"), MAX(
-        sizeof("Update Staker"), MAX(
-        sizeof("Set Active Stake"), MAX(
-        sizeof("Retire Stake"),
-        sizeof("Unstake")))))))))
-    )];
-#endif
-    char value[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
-    char fee[STRING_LENGTH_NIM_AMOUNT_WITH_TICKER];
-    char network[MAX(sizeof("Main"), MAX(sizeof("Test"), MAX(sizeof("Development"), sizeof("Bounty"))))];
+    uint64_t value;
+    uint64_t fee;
+    const char *network; // pointer to a constant string
+    // Combination of tx_display_flag_t, determined once the transaction has been parsed entirely, such that the UIs
+    // don't have to re-evaluate which values to display on each screen transition.
+    uint32_t display_plan;
 } parsed_tx_t;
 
+typedef enum {
+    // The initial stage has value 0, such that a zeroed tx_parser_state_t is a valid initial state.
+    TX_PARSER_STAGE_DATA_LENGTH = 0,
+    TX_PARSER_STAGE_DATA,
+    TX_PARSER_STAGE_SENDER_AND_RECIPIENT,
+    TX_PARSER_STAGE_VALUE_AND_FEE,
+    TX_PARSER_STAGE_VALIDITY_START_HEIGHT_NETWORK_AND_FLAGS,
+    TX_PARSER_STAGE_SENDER_DATA_LENGTH, // Albatross only
+    TX_PARSER_STAGE_SENDER_DATA, // Albatross only
+    TX_PARSER_STAGE_END,
+} tx_parser_stage_t;
+
+// State of the incremental transaction parser, which is kept between chunks. Only the fields which are needed for the
+// processing of later stages are kept. Fields which can be accessed via their known offset in the raw transaction, like
+// the sender and recipient addresses, are not copied.
+typedef struct {
+    tx_parser_stage_t stage;
+    uint16_t offset; // offset in the raw transaction at which the current stage starts
+    uint16_t data_length;
+    // In streamed signing mode, the voting key and proof of knowledge of validator transactions are not kept in the raw
+    // transaction, see next_staking_data_run. The number of omitted data bytes, and the fingerprint of the voting key
+    // are then provided by the caller. Otherwise, they're 0 and NULL.
+    uint16_t streamed_data_length;
+    const uint8_t *streamed_voting_key_fingerprint;
+    uint16_t sender_data_length;
+    uint8_t sender_type;
+    uint8_t recipient_type;
+    uint8_t flags;
+    uint32_t validity_start_height;
+} tx_parser_state_t;
+
+/**
+ * Parse the part of a transaction that has been received so far. buffer must hold the entire transaction received so
+ * far, starting at its beginning, and the parser continues at the stage and offset stored in its state. Invalid data is
+ * rejected as soon as it is received. If is_last_chunk is set, the transaction must be complete. In streamed signing
+ * mode, the buffer holds only the retained parts of the transaction, see tx_parser_state_t, and only incoming staking
+ * transactions are supported.
+ */
+WARN_UNUSED_RESULT
+error_t parse_tx_chunk(tx_parser_state_t *state, transaction_version_t version, uint8_t *buffer,
+    uint16_t buffer_length, bool is_last_chunk, parsed_tx_t *out);
+
+/**
+ * Parse an entire transaction at once.
+ */
 WARN_UNUSED_RESULT
 error_t parse_tx(transaction_version_t version, uint8_t *buffer, uint16_t buffer_length, parsed_tx_t *out);
 
 WARN_UNUSED_RESULT
-error_t print_address(uint8_t *in, char *out);
+error_t blake2b_256(uint8_t *in, uint16_t in_length, uint8_t *out);
 
 WARN_UNUSED_RESULT
 error_t public_key_to_address(uint8_t *in, uint8_t *out);
@@ -121,13 +195,13 @@ WARN_UNUSED_RESULT
 error_t print_public_key_as_address(uint8_t *in, char *out);
 
 WARN_UNUSED_RESULT
-error_t print_hex(uint8_t *data, uint16_t data_length, char *out, uint16_t out_length);
+error_t parse_amount(uint64_t amount, const char * const ticker, char out[static STRING_LENGTH_NIM_AMOUNT_WITH_TICKER]);
 
 WARN_UNUSED_RESULT
-error_t parse_amount(uint64_t amount, const char * const ticker, char out[static STRING_LENGTH_NIM_AMOUNT_WITH_TICKER]);
+error_t check_amount(uint64_t amount);
 
 WARN_UNUSED_RESULT
-error_t parse_network_id(transaction_version_t version, uint8_t network_id, char *out);
+error_t parse_network_id(transaction_version_t version, uint8_t network_id, const char **out);
 
 WARN_UNUSED_RESULT
 error_t parse_normal_tx_data(uint8_t *data, uint16_t data_length, tx_data_normal_or_staking_outgoing_t *out,
@@ -141,36 +215,4 @@ WARN_UNUSED_RESULT
 error_t parse_vesting_creation_data(transaction_version_t version, uint8_t *data, uint16_t data_length, uint8_t *sender,
     account_type_t sender_type, uint64_t tx_amount, tx_data_vesting_creation_t *out);
 
-WARN_UNUSED_RESULT
-bool read_sub_buffer(uint16_t sub_buffer_length, uint8_t **in_out_buffer, uint16_t *in_out_buffer_length,
-    uint8_t **out_sub_buffer);
-
-WARN_UNUSED_RESULT
-bool read_u8(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint8_t *out_value);
-
-WARN_UNUSED_RESULT
-bool read_u16(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint16_t *out_value);
-
-WARN_UNUSED_RESULT
-bool read_u32(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint32_t *out_value);
-
-WARN_UNUSED_RESULT
-bool read_u64(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint64_t *out_value);
-
-WARN_UNUSED_RESULT
-bool read_bool(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, bool *out_value);
-
-WARN_UNUSED_RESULT
-bool read_serde_uvarint(uint8_t max_bits, uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint32_t *out_value);
-
-WARN_UNUSED_RESULT
-bool read_serde_vec_u8(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint8_t **out_data,
-    uint16_t *out_data_length);
-
-WARN_UNUSED_RESULT
-bool read_bip32_path(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length, uint32_t *out_bip32_path,
-    uint8_t *out_bip32_path_length);
-
-bool is_printable_ascii(uint8_t *data, uint16_t data_length);
-
 #endif // _NIMIQ_UTILS_H_
@@ -108,38 +108,198 @@ UX_FLOW(ux_public_key_flow,
 //////////////////////////////////////////////////////////////////////
 
 // Generic transaction confirmation UI steps
+// The displayed values are printed on demand into the request arena when a step gets initialized, see
+// ux_transaction_print_entry. As only one value is displayed at a time, the previous value is freed first, such that
+// the displayed value is always located at the start of the arena.
 
-UX_STEP_NOCB(
+#define TRANSACTION_PRINTED_ENTRY REQUEST_ARENA_START(transactionContext_t)
+#define PRINT_TRANSACTION_ENTRY(entry) \
+    (request_arena_free_all(), ux_transaction_print_entry_to_arena(entry))
+
+static void ux_transaction_print_label() {
+    // The complete title will be "Confirm <label>"
+    const char *label;
+    switch (PARSED_TX.transaction_label_type) {
+        case TRANSACTION_LABEL_TYPE_REGULAR_TRANSACTION:
+            label = "Transaction";
+            break;
+        case TRANSACTION_LABEL_TYPE_CASHLINK:
+            label = "Cashlink";
+            break;
+        case TRANSACTION_LABEL_TYPE_VESTING_CREATION:
+            label = "Vesting";
+            break;
+        case TRANSACTION_LABEL_TYPE_HTLC_CREATION:
+            label = "HTLC / Swap";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_CREATE_STAKER:
+            label = "Create Staker";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_ADD_STAKE:
+            label = "Add Stake";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_UPDATE_STAKER:
+            label = "Update Staker";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_SET_ACTIVE_STAKE:
+            label = "Set Active Stake";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_RETIRE_STAKE:
+            label = "Retire Stake";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_REMOVE_STAKE:
+            label = "Unstake";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_CREATE_VALIDATOR:
+            label = "Create Validator";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_UPDATE_VALIDATOR:
+            label = "Update Validator";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_DEACTIVATE_VALIDATOR:
+            label = "Deactivate Validator";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_REACTIVATE_VALIDATOR:
+            label = "Reactivate Validator";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_RETIRE_VALIDATOR:
+            label = "Retire Validator";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_DELETE_VALIDATOR:
+            label = "Delete Validator";
+            break;
+        default:
+            // This should not happen, as the transaction parser should have set a valid transaction label type.
+            LEDGER_ASSERT(
+                false,
+                "Invalid transaction label type"
+            );
+    }
+    request_arena_free_all();
+    uint16_t printed_label_length;
+    LEDGER_ASSERT(
+        print_string(label, request_arena_print_begin(&printed_label_length), printed_label_length) == ERROR_NONE,
+        "Failed to print transaction label"
+    );
+    request_arena_print_end();
+}
+
+UX_STEP_NOCB_INIT(
     ux_transaction_generic_flow_transaction_type_step,
     pnn,
+    ux_transaction_print_label(),
     {
         &C_icon_eye,
         "Confirm",
-        PARSED_TX.transaction_label,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_transaction_generic_flow_amount_step,
-    paging,
-    ux_transaction_generic_has_amount_entry(), // amount can be 0 for signaling transactions
-    {
-        "Amount",
-        PARSED_TX.value,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_transaction_generic_flow_fee_step,
-    paging,
-    ux_transaction_generic_has_fee_entry(),
-    {
-        "Fee",
-        PARSED_TX.fee,
-    });
-UX_STEP_NOCB(
-    ux_transaction_generic_flow_network_step,
-    paging,
-    {
-        "Network",
-        PARSED_TX.network,
+        TRANSACTION_PRINTED_ENTRY,
     });
+
+//////////////////////////////////////////////////////////////////////
+
+// Transaction entry rows
+// Instead of a separate step per displayed value, the entry rows of the transaction type, see
+// ux_transaction_get_entry_rows, are rendered by a single generic paging step, see ux_transaction_flow_entry_step.
+
+/**
+ * Find the next displayed row after row_index in the given direction (1 or -1). row_index can be -1 to start the
+ * search at the first row. Returns -1 if there is no further displayed row in that direction.
+ */
+static int8_t ux_transaction_find_displayed_row(int8_t row_index, int8_t direction) {
+    uint8_t row_count;
+    const ux_transaction_entry_row_t *rows = ux_transaction_get_entry_rows(&row_count);
+    for (row_index += direction; row_index >= 0 && row_index < row_count; row_index += direction) {
+        if (ux_transaction_is_entry_row_displayed(&rows[row_index])) {
+            return row_index;
+        }
+    }
+    return -1;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Transaction confirmation UI steps and flow
+// The generic entry step displays the currently selected row. It's enclosed by two delimiter steps, which are never
+// displayed themselves. When the user leaves the entry step, the delimiter that is entered selects the next or
+// previous displayed row and re-enters the entry step, or passes on to the neighboring step if there are no further
+// displayed rows in that direction. The entry step is always re-entered from the direction the user is moving in,
+// such that the paging layout starts at the first page when moving forward and at the last page when moving backward.
+
+extern const ux_flow_step_t *const ux_transaction_flow[];
+extern const ux_flow_step_t ux_transaction_flow_entry_step;
+extern const ux_flow_step_t ux_transaction_flow_entries_end_step;
+
+// Index of the row displayed by the entry step, in the table of the current transaction type.
+static int8_t ux_transaction_displayed_row;
+// Set to re-enter the entry step from below, via the end delimiter.
+static bool ux_transaction_entry_step_enter_backward;
+// Only the title is set here, on demand. The text is always TRANSACTION_PRINTED_ENTRY.
+static ux_layout_paging_params_t ux_transaction_entry_step_params;
+
+static void ux_transaction_flow_entry_step_init(unsigned int stack_slot) {
+    uint8_t row_count;
+    const ux_transaction_entry_row_t *row = &ux_transaction_get_entry_rows(&row_count)[ux_transaction_displayed_row];
+    ux_transaction_entry_step_params.title = row->label;
+    ux_transaction_entry_step_params.text = TRANSACTION_PRINTED_ENTRY;
+    PRINT_TRANSACTION_ENTRY(row->value);
+    ux_layout_paging_init(stack_slot);
+}
+
+static void ux_transaction_flow_entries_start_step_init(unsigned int stack_slot) {
+    if (ux_flow_direction() != FLOW_DIRECTION_BACKWARD) {
+        // Coming from the transaction type step. There is always at least one displayed row, the network.
+        ux_transaction_displayed_row = ux_transaction_find_displayed_row(-1, 1);
+        ux_flow_next();
+        return;
+    }
+    // Coming back from the entry step.
+    int8_t previous_row = ux_transaction_find_displayed_row(ux_transaction_displayed_row, -1);
+    if (previous_row < 0) {
+        ux_flow_prev();
+        return;
+    }
+    ux_transaction_displayed_row = previous_row;
+    ux_transaction_entry_step_enter_backward = true;
+    ux_flow_init(stack_slot, ux_transaction_flow, &ux_transaction_flow_entries_end_step);
+}
+
+static void ux_transaction_flow_entries_end_step_init(unsigned int stack_slot) {
+    if (ux_transaction_entry_step_enter_backward || ux_flow_direction() == FLOW_DIRECTION_BACKWARD) {
+        // Re-entering the entry step from below, or coming back from the approve step to the last displayed row,
+        // which is still selected.
+        ux_transaction_entry_step_enter_backward = false;
+        ux_flow_prev();
+        return;
+    }
+    // Coming from the entry step.
+    int8_t next_row = ux_transaction_find_displayed_row(ux_transaction_displayed_row, 1);
+    if (next_row < 0) {
+        ux_flow_next();
+        return;
+    }
+    ux_transaction_displayed_row = next_row;
+    // Initializing the flow at the entry step counts as moving forward.
+    ux_flow_init(stack_slot, ux_transaction_flow, &ux_transaction_flow_entry_step);
+}
+
+const ux_flow_step_t ux_transaction_flow_entries_start_step = {
+    ux_transaction_flow_entries_start_step_init,
+    NULL,
+    NULL,
+    NULL,
+};
+const ux_flow_step_t ux_transaction_flow_entry_step = {
+    ux_transaction_flow_entry_step_init,
+    &ux_transaction_entry_step_params,
+    NULL,
+    NULL,
+};
+const ux_flow_step_t ux_transaction_flow_entries_end_step = {
+    ux_transaction_flow_entries_end_step_init,
+    NULL,
+    NULL,
+    NULL,
+};
+
 UX_STEP_CB(
     ux_transaction_generic_flow_approve_step,
     pbb,
@@ -164,263 +324,12 @@ UX_STEP_CB(
         "Reject",
     });
 
-//////////////////////////////////////////////////////////////////////
-
-// Normal, non contract creation transaction specific UI steps and flow
-
-UX_STEP_NOCB(
-    ux_transaction_normal_or_staking_outgoing_flow_recipient_step,
-    paging,
-    {
-        "Recipient",
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.recipient,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_transaction_normal_or_staking_outgoing_flow_data_step,
-    paging,
-    ux_transaction_normal_or_staking_outgoing_has_data_entry(),
-    {
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_label,
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data,
-    });
-
-UX_FLOW(ux_transaction_normal_or_staking_outgoing_flow,
-    &ux_transaction_generic_flow_transaction_type_step,
-    &ux_transaction_generic_flow_amount_step, // optional, but always displayed as this is not a signaling transaction
-    &ux_transaction_normal_or_staking_outgoing_flow_recipient_step,
-    &ux_transaction_normal_or_staking_outgoing_flow_data_step, // optional
-    &ux_transaction_generic_flow_fee_step, // optional
-    &ux_transaction_generic_flow_network_step,
-    &ux_transaction_generic_flow_approve_step,
-    &ux_transaction_generic_flow_reject_step
-);
-
-//////////////////////////////////////////////////////////////////////
-
-// HTLC creation specific UI steps and flow
-
-UX_STEP_NOCB(
-    ux_htlc_creation_flow_redeem_address_step,
-    paging,
-    {
-        "HTLC Recipient",
-        PARSED_TX_HTLC_CREATION.redeem_address,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_htlc_creation_flow_refund_address_step,
-    paging,
-    ux_transaction_htlc_creation_has_refund_address_entry(),
-    {
-        "Refund to",
-        PARSED_TX_HTLC_CREATION.refund_address,
-    });
-UX_STEP_NOCB(
-    ux_htlc_creation_flow_hash_root_step,
-    paging,
-    {
-        "Hashed Secret", // more user friendly label for hash root
-        PARSED_TX_HTLC_CREATION.hash_root,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_htlc_creation_flow_hash_algorithm_step,
-    paging,
-    ux_transaction_htlc_creation_has_hash_algorithm_entry(),
-    {
-        "Hash Algorithm",
-        PARSED_TX_HTLC_CREATION.hash_algorithm,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_htlc_creation_flow_hash_count_step,
-    paging,
-    ux_transaction_htlc_creation_has_hash_count_entry(),
-    {
-        "Hash Steps", // more user friendly label for hash count
-        PARSED_TX_HTLC_CREATION.hash_count,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_htlc_creation_flow_timeout_step,
-    paging,
-    ux_transaction_htlc_creation_has_timeout_entry(),
-    {
-        "HTLC Expiry Block", // more user friendly label for timeout
-        PARSED_TX_HTLC_CREATION.timeout,
-    });
-
-UX_FLOW(ux_transaction_htlc_creation_flow,
-    &ux_transaction_generic_flow_transaction_type_step,
-    &ux_transaction_generic_flow_amount_step, // optional, but always displayed as this is not a signaling transaction
-    &ux_htlc_creation_flow_redeem_address_step,
-    &ux_htlc_creation_flow_refund_address_step, // optional
-    &ux_htlc_creation_flow_hash_root_step,
-    &ux_htlc_creation_flow_hash_algorithm_step, // optional
-    &ux_htlc_creation_flow_hash_count_step, // optional
-    &ux_htlc_creation_flow_timeout_step, // optional
-    &ux_transaction_generic_flow_fee_step, // optional
-    &ux_transaction_generic_flow_network_step,
-    &ux_transaction_generic_flow_approve_step,
-    &ux_transaction_generic_flow_reject_step
-);
-
-//////////////////////////////////////////////////////////////////////
-
-// Vesting Contract Creation specific UI steps and flow
-
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_owner_address_step,
-    paging,
-    ux_transaction_vesting_creation_has_owner_address_entry(),
-    {
-        "Vesting Owner",
-        PARSED_TX_VESTING_CREATION.owner_address,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_single_vesting_block_step, // simplified ui for step_count == 1 case
-    paging,
-    ux_transaction_vesting_creation_has_single_vesting_block_entry(),
-    {
-        "Vested at Block",
-        PARSED_TX_VESTING_CREATION.first_step_block,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_start_block_step,
-    paging,
-    ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries(),
-    {
-        "Vesting Start Block",
-        PARSED_TX_VESTING_CREATION.start_block,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_period_step,
-    paging,
-    ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries(),
-    {
-        "Vesting Period",
-        PARSED_TX_VESTING_CREATION.period,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_step_count_step,
-    paging,
-    ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries(),
-    {
-        "Vesting Steps",
-        PARSED_TX_VESTING_CREATION.step_count,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_step_block_count_step,
-    paging,
-    ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries(),
-    {
-        "Blocks Per Step",
-        PARSED_TX_VESTING_CREATION.step_block_count,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_first_step_block_count_step,
-    paging,
-    ux_transaction_vesting_creation_has_first_step_duration_entry(),
-    {
-        "First Step",
-        PARSED_TX_VESTING_CREATION.first_step_block_count,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_step_amount_step,
-    paging,
-    ux_transaction_vesting_creation_has_step_amount_entry(),
-    {
-        "Vested per Step",
-        PARSED_TX_VESTING_CREATION.step_amount,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_first_step_amount_step,
-    paging,
-    ux_transaction_vesting_creation_has_first_step_amount_entry(),
-    {
-        "First Step",
-        PARSED_TX_VESTING_CREATION.first_step_amount,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_last_step_amount_step,
-    paging,
-    ux_transaction_vesting_creation_has_last_step_amount_entry(),
-    {
-        "Last Step",
-        PARSED_TX_VESTING_CREATION.last_step_amount,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_vesting_creation_flow_pre_vested_amount_step,
-    paging,
-    ux_transaction_vesting_creation_has_pre_vested_amount_entry(),
-    {
-        "Pre-Vested",
-        PARSED_TX_VESTING_CREATION.pre_vested_amount,
-    });
-
-UX_FLOW(ux_transaction_vesting_creation_flow,
-    &ux_transaction_generic_flow_transaction_type_step,
-    &ux_transaction_generic_flow_amount_step, // optional, but always displayed as this is not a signaling transaction
-    &ux_vesting_creation_flow_owner_address_step, // optional
-    &ux_vesting_creation_flow_single_vesting_block_step, // optional
-    &ux_vesting_creation_flow_start_block_step, // optional
-    &ux_vesting_creation_flow_period_step, // optional
-    &ux_vesting_creation_flow_step_count_step, // optional
-    &ux_vesting_creation_flow_step_block_count_step, // optional
-    &ux_vesting_creation_flow_first_step_block_count_step, // optional
-    &ux_vesting_creation_flow_step_amount_step, // optional
-    &ux_vesting_creation_flow_first_step_amount_step, // optional
-    &ux_vesting_creation_flow_last_step_amount_step, // optional
-    &ux_vesting_creation_flow_pre_vested_amount_step, // optional
-    &ux_transaction_generic_flow_fee_step, // optional
-    &ux_transaction_generic_flow_network_step,
-    &ux_transaction_generic_flow_approve_step,
-    &ux_transaction_generic_flow_reject_step
-);
 
-//////////////////////////////////////////////////////////////////////
-
-// Incoming staking transaction (transactions to the staking contract) specific UI steps and flow
-
-UX_OPTIONAL_STEP_NOCB(
-    ux_staking_incoming_flow_set_active_stake_or_retire_stake_amount_step,
-    paging,
-    ux_transaction_staking_incoming_has_set_active_stake_or_retire_stake_amount_entry(),
-    {
-        "Amount",
-        PARSED_TX_STAKING_INCOMING.set_active_stake_or_retire_stake.amount,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_staking_incoming_flow_staker_address_step,
-    paging,
-    ux_transaction_staking_incoming_has_staker_address_entry(),
-    {
-        "Staker",
-        PARSED_TX_STAKING_INCOMING.validator_or_staker_address,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_staking_incoming_flow_create_staker_or_update_staker_delegation_step,
-    paging,
-    ux_transaction_staking_incoming_has_create_staker_or_update_staker_delegation_entry(),
-    {
-        "Delegation",
-        PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker.delegation,
-    });
-UX_OPTIONAL_STEP_NOCB(
-    ux_staking_incoming_flow_update_staker_reactivate_all_stake_step,
-    paging,
-    ux_transaction_staking_incoming_has_update_staker_reactivate_all_stake_entry(),
-    {
-        "Reactivate all Stake",
-        PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker
-            .update_staker_reactivate_all_stake,
-    });
-
-UX_FLOW(ux_transaction_staking_incoming_flow,
+UX_FLOW(ux_transaction_flow,
     &ux_transaction_generic_flow_transaction_type_step,
-    &ux_transaction_generic_flow_amount_step, // optional, not shown for signaling tx
-    &ux_staking_incoming_flow_set_active_stake_or_retire_stake_amount_step, // optional, for amount in signaling data
-    &ux_staking_incoming_flow_staker_address_step, // optional
-    &ux_staking_incoming_flow_create_staker_or_update_staker_delegation_step, // optional
-    &ux_staking_incoming_flow_update_staker_reactivate_all_stake_step, // optional
-    &ux_transaction_generic_flow_fee_step, // optional
-    &ux_transaction_generic_flow_network_step,
+    &ux_transaction_flow_entries_start_step,
+    &ux_transaction_flow_entry_step,
+    &ux_transaction_flow_entries_end_step,
     &ux_transaction_generic_flow_approve_step,
     &ux_transaction_generic_flow_reject_step
 );
@@ -440,28 +349,43 @@ UX_STEP_NOCB(
 UX_STEP_NOCB_INIT(
     ux_message_flow_message_length_step,
     paging,
-    {
-        // note: not %lu (for unsigned long int) because int is already 32bit on ledgers (see "Memory Alignment" in
-        // Ledger docu), additionally Ledger's own implementation of sprintf does not support %lu (see os_printf.c)
-        snprintf(ctx.req.msg.confirm.printedMessage, sizeof(ctx.req.msg.confirm.printedMessage), "%u",
-            ctx.req.msg.messageLength);
-    },
+    ux_message_signing_print_message_length(),
     {
         "Message Length",
-        ctx.req.msg.confirm.printedMessage,
+        REQUEST_ARENA_START(messageSigningContext_t),
     });
-UX_STEP_NOCB_INIT(
-    ux_message_flow_message_step,
+// Separate steps for the different display types, such that the labels can be constant strings.
+UX_OPTIONAL_STEP_NOCB_INIT(
+    ux_message_flow_message_ascii_step,
     paging,
-    ux_message_signing_prepare_printed_message(),
+    ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_ASCII,
+    ux_message_signing_print_message(),
     {
-        ctx.req.msg.confirm.printedMessageLabel,
-        ctx.req.msg.confirm.printedMessage,
+        "Message",
+        REQUEST_ARENA_START(messageSigningContext_t),
+    });
+UX_OPTIONAL_STEP_NOCB_INIT(
+    ux_message_flow_message_hex_step,
+    paging,
+    ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_HEX,
+    ux_message_signing_print_message(),
+    {
+        "Message Hex",
+        REQUEST_ARENA_START(messageSigningContext_t),
+    });
+UX_OPTIONAL_STEP_NOCB_INIT(
+    ux_message_flow_message_hash_step,
+    paging,
+    ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_HASH,
+    ux_message_signing_print_message(),
+    {
+        "Message Hash",
+        REQUEST_ARENA_START(messageSigningContext_t),
     });
 UX_OPTIONAL_STEP_CB(
     ux_message_flow_display_ascii_step,
     pbb,
-    ctx.req.msg.isPrintableAscii && ctx.req.msg.confirm.displayType != MESSAGE_DISPLAY_TYPE_ASCII,
+    ctx.req.msg.isPrintableAscii && ctx.req.msg.displayType != MESSAGE_DISPLAY_TYPE_ASCII,
     ui_message_signing(MESSAGE_DISPLAY_TYPE_ASCII, true),
     {
         &C_icon_certificate,
@@ -472,7 +396,7 @@ UX_OPTIONAL_STEP_CB(
     ux_message_flow_display_hex_step,
     pbb,
     ctx.req.msg.messageLength <= MAX_PRINTABLE_MESSAGE_LENGTH
-        && ctx.req.msg.confirm.displayType != MESSAGE_DISPLAY_TYPE_HEX,
+        && ctx.req.msg.displayType != MESSAGE_DISPLAY_TYPE_HEX,
     ui_message_signing(MESSAGE_DISPLAY_TYPE_HEX, true),
     {
         &C_icon_certificate,
@@ -482,7 +406,7 @@ UX_OPTIONAL_STEP_CB(
 UX_OPTIONAL_STEP_CB(
     ux_message_flow_display_hash_step,
     pbb,
-    ctx.req.msg.confirm.displayType != MESSAGE_DISPLAY_TYPE_HASH,
+    ctx.req.msg.displayType != MESSAGE_DISPLAY_TYPE_HASH,
     ui_message_signing(MESSAGE_DISPLAY_TYPE_HASH, true),
     {
         &C_icon_certificate,
@@ -516,7 +440,9 @@ UX_STEP_CB(
 UX_FLOW(ux_message_flow,
     &ux_message_flow_intro_step,
     &ux_message_flow_message_length_step,
-    &ux_message_flow_message_step,
+    &ux_message_flow_message_ascii_step, // optional
+    &ux_message_flow_message_hex_step, // optional
+    &ux_message_flow_message_hash_step, // optional
     &ux_message_flow_display_ascii_step,
     &ux_message_flow_display_hex_step,
     &ux_message_flow_display_hash_step,
@@ -540,75 +466,17 @@ void ui_public_key() {
 }
 
 void ui_transaction_signing() {
-    // The complete title will be "Confirm <PARSED_TX.transaction_label>"
-    switch (PARSED_TX.transaction_label_type) {
-        case TRANSACTION_LABEL_TYPE_REGULAR_TRANSACTION:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Transaction");
-            break;
-        case TRANSACTION_LABEL_TYPE_CASHLINK:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Cashlink");
-            break;
-        case TRANSACTION_LABEL_TYPE_VESTING_CREATION:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Vesting");
-            break;
-        case TRANSACTION_LABEL_TYPE_HTLC_CREATION:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "HTLC / Swap");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_CREATE_STAKER:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Create Staker");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_ADD_STAKE:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Add Stake");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_UPDATE_STAKER:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Update Staker");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_SET_ACTIVE_STAKE:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Set Active Stake");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_RETIRE_STAKE:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Retire Stake");
-            break;
-        case TRANSACTION_LABEL_TYPE_STAKING_REMOVE_STAKE:
-            COPY_FIXED_SIZE(PARSED_TX.transaction_label, "Unstake");
-            break;
-        default:
-            // This should not happen, as the transaction parser should have set a valid transaction label type.
-            LEDGER_ASSERT(
-                false,
-                "Invalid transaction label type"
-            );
-    }
-
-    const ux_flow_step_t* const * transaction_flow;
-    switch (PARSED_TX.transaction_type) {
-        case TRANSACTION_TYPE_NORMAL:
-        case TRANSACTION_TYPE_STAKING_OUTGOING:
-            transaction_flow = ux_transaction_normal_or_staking_outgoing_flow;
-            break;
-        case TRANSACTION_TYPE_VESTING_CREATION:
-            transaction_flow = ux_transaction_vesting_creation_flow;
-            break;
-        case TRANSACTION_TYPE_HTLC_CREATION:
-            transaction_flow = ux_transaction_htlc_creation_flow;
-            break;
-        case TRANSACTION_TYPE_STAKING_INCOMING:
-            transaction_flow = ux_transaction_staking_incoming_flow;
-            break;
-        default:
-            // This should not happen, as the transaction parser should have set a valid transaction type.
-            LEDGER_ASSERT(
-                false,
-                "Invalid transaction type"
-            );
-    }
-
-    ux_flow_init(0, transaction_flow, NULL);
+    ux_flow_init(0, ux_transaction_flow, NULL);
 }
 
 void ui_message_signing(message_display_type_t messageDisplayType, bool startAtMessageDisplay) {
-    ctx.req.msg.confirm.displayType = messageDisplayType;
-    ux_flow_init(0, ux_message_flow, startAtMessageDisplay ? &ux_message_flow_message_step : NULL);
+    ctx.req.msg.displayType = messageDisplayType;
+    const ux_flow_step_t *message_step = messageDisplayType == MESSAGE_DISPLAY_TYPE_ASCII
+        ? &ux_message_flow_message_ascii_step
+        : messageDisplayType == MESSAGE_DISPLAY_TYPE_HEX
+            ? &ux_message_flow_message_hex_step
+            : &ux_message_flow_message_hash_step;
+    ux_flow_init(0, ux_message_flow, startAtMessageDisplay ? message_step : NULL);
 }
 
 // resolve io_seproxyhal_display as io_seproxyhal_display_default
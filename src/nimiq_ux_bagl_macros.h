@@ -23,13 +23,15 @@
 #include "ux.h"
 
 /**
- * Similar to UX_STEP_NOCB defined in ux_flow_engine.h but with a special init method that displays this step only if
- * the given condition is fulfilled and skips it otherwise by automatically going to the next or previous step.
+ * Similar to UX_STEP_NOCB_INIT defined in ux_flow_engine.h but with a special init method that displays this step only
+ * if the given condition is fulfilled and skips it otherwise by automatically going to the next or previous step. The
+ * preinit code is only run if the step is displayed, for example to print the displayed value on demand.
  */
 // Code inspired by UX_STEP_NOCB_INIT
-#define UX_OPTIONAL_STEP_NOCB(stepname, layoutkind, display_condition, ...) \
+#define UX_OPTIONAL_STEP_NOCB_INIT(stepname, layoutkind, display_condition, preinit, ...) \
     void stepname ##_init (unsigned int stack_slot) { \
         if (display_condition) { \
+            preinit; \
             ux_layout_ ## layoutkind ## _init(stack_slot); \
         } else { \
             if ( \
@@ -52,6 +54,13 @@
         NULL, \
     }
 
+/**
+ * Similar to UX_STEP_NOCB defined in ux_flow_engine.h but with a special init method that displays this step only if
+ * the given condition is fulfilled and skips it otherwise by automatically going to the next or previous step.
+ */
+#define UX_OPTIONAL_STEP_NOCB(stepname, layoutkind, display_condition, ...) \
+    UX_OPTIONAL_STEP_NOCB_INIT(stepname, layoutkind, display_condition, {}, __VA_ARGS__)
+
 /**
  * Similar to UX_STEP_CB defined in ux_flow_engine.h but with a special init method that displays this step only if
  * the given condition is fulfilled and skips it otherwise by automatically going to the next or previous step.
@@ -26,6 +26,7 @@
 #include "globals.h"
 #include "nimiq_ux_utils_transaction_signing.h"
 #include "nimiq_ux_utils_message_signing.h"
+#include "printing.h"
 
 // These are declared in main.c
 void on_rejected();
@@ -98,148 +99,163 @@ void ui_public_key() {
 //////////////////////////////////////////////////////////////////////
 
 // NBGL review utils
-
-// The review with the most potential entries is the vesting creation flow. The maximum entries it can display are:
-// amount, owner address, start, period, step count, step duration, first step duration, step amount, first step amount,
-// last step amount, fee, network. Note that the single-block block entry and the multi-block vesting entries can not
-// appear at the same time, same for the entry for the pre-vested amount and first step amount.
-#define REVIEW_ENTRIES_MAX_COUNT 12
+// Reviews use the streaming review use case of the SDK. Instead of preparing all entries of a review up front, they are
+// streamed in batches, of which only the current batch is kept in memory and its values printed in the request arena.
+// The entries of a review are added by its add_entries function, which is called once per batch and adds all entries
+// of the review in order, of which only those of the current batch are kept. This way, the entries don't need to be
+// addressable by index, and the conditions for optional entries are simply evaluated again, which is cheap as they're
+// precomputed, see parsed_tx_t.display_plan. Note that the streaming review does not allow navigating back to the
+// pages of previous batches. Once all entries have been reviewed, the review's optional on_entries_reviewed function
+// can show further pages, before it finishes the review via review_finish.
+
+// Maximum entries per batch. Once the batch is full, the remaining entries are streamed in the next batch. Sized such
+// that the entries of the common transactions, e.g. up to 9 for HTLC creations, fit a single batch, which keeps all
+// their pages navigable, and only long vesting schedules are streamed.
+#define REVIEW_BATCH_MAX_COUNT 10
 static struct {
-    nbgl_contentTagValue_t entries[REVIEW_ENTRIES_MAX_COUNT];
-    uint8_t count;
-} review_entries;
-
-static void review_entries_initialize() {
-    // Initialize the structure with zeroes, including setting the count to 0, and the entries' .forcePageStart (don't
-    // enforce a new page by default), .centeredInfo (don't center entry vertically) and .aliasValue (display full
-    // values and no alias) to 0 / false.
-    memset(&review_entries, 0, sizeof(review_entries));
+    nbgl_contentTagValue_t entries[REVIEW_BATCH_MAX_COUNT];
+    nbgl_contentTagValueList_t tag_value_list;
+    void (*add_entries)();
+    void (*on_entries_reviewed)();
+    nbgl_choiceCallback_t choice_callback;
+    const char *finish_title;
+    uint16_t printed_length; // length of the values of the current batch printed into the arena
+    uint8_t count; // number of entries in the current batch
+    uint8_t batch_start; // index of the first entry of the current batch among all entries of the review
+    uint8_t next_index; // index of the next added entry among all entries of the review
+    bool is_batch_full;
+} review;
+
+static bool review_entries_is_in_batch(uint16_t printed_length) {
+    uint8_t index = review.next_index++;
+    if (index < review.batch_start || review.is_batch_full) return false;
+    // Close the batch once it's full or the printed value might not fit the arena budget anymore, see globals.h.
+    review.is_batch_full = review.count >= REVIEW_BATCH_MAX_COUNT
+        || review.printed_length + printed_length > REVIEW_BATCH_ARENA_BUDGET;
+    return !review.is_batch_full;
 }
 
 static void review_entries_add(const char *item, const char *value) {
-    LEDGER_ASSERT(
-        review_entries.count < REVIEW_ENTRIES_MAX_COUNT,
-        "Too many nbgl ui entries"
-    );
-    review_entries.entries[review_entries.count].item = item;
-    review_entries.entries[review_entries.count].value = value;
-    review_entries.count++;
+    if (!review_entries_is_in_batch(0)) return;
+    review.entries[review.count].item = item;
+    review.entries[review.count].value = value;
+    review.count++;
+}
+
+// Add an entry of the current batch, of which the value has been printed into the request arena. As all values of a
+// batch are referenced at the same time, each value is allocated separately, and they are all only freed when the next
+// batch is prepared.
+static void review_entries_add_printed(const char *item, const char *value) {
+    review.entries[review.count].item = item;
+    review.entries[review.count].value = value;
+    review.count++;
+    review.printed_length += strlen(value) + /* string terminator */ 1;
+}
+
+// Transaction values are mostly much shorter than REVIEW_ENTRY_MAX_PRINTED_LENGTH, which is why they're checked against
+// the batch budget by their actual length. The value is printed into the arena first, and only allocated if it fits
+// the budget. Otherwise, the batch is closed, and the value is printed again for the next batch. The arena therefore
+// holds one value more than the budget, see globals.h.
+static void review_entries_add_printed_transaction_entry(const char *item, ux_transaction_entry_t entry,
+    bool condition) {
+    if (!condition || !review_entries_is_in_batch(0)) return;
+    uint16_t available_length;
+    char *value = request_arena_print_begin(&available_length);
+    ux_transaction_print_entry(entry, value, available_length);
+    if (review.printed_length + strlen(value) + /* string terminator */ 1 > REVIEW_BATCH_ARENA_BUDGET) {
+        review.is_batch_full = true;
+        return;
+    }
+    review_entries_add_printed(item, request_arena_print_end());
 }
-#undef REVIEW_ENTRIES_MAX_COUNT
 
-static void review_entries_add_optional(const char *item, const char *value, bool condition) {
-    if (!condition) return;
-    review_entries_add(item, value);
+static void review_finish() {
+    nbgl_useCaseReviewStreamingFinish(review.finish_title, review.choice_callback);
 }
 
-static void review_entries_launch_use_case_review(
+static void review_on_batch_reviewed(bool confirmed) {
+    if (!confirmed) {
+        review.choice_callback(false);
+        return;
+    }
+
+    // Prepare the next batch. Initialize the entries with zeroes, including their .forcePageStart (don't enforce a new
+    // page by default), .centeredInfo (don't center entry vertically) and .aliasValue (display full values and no
+    // alias) to 0 / false.
+    request_arena_free_all();
+    memset(review.entries, 0, sizeof(review.entries));
+    review.batch_start += review.count;
+    review.count = 0;
+    review.printed_length = 0;
+    review.next_index = 0;
+    review.is_batch_full = false;
+    review.add_entries();
+
+    if (!review.count) {
+        // All entries have been reviewed.
+        if (review.on_entries_reviewed) {
+            review.on_entries_reviewed();
+        } else {
+            review_finish();
+        }
+        return;
+    }
+    review.tag_value_list.pairs = review.entries;
+    review.tag_value_list.nbPairs = review.count;
+    nbgl_useCaseReviewStreamingContinue(&review.tag_value_list, review_on_batch_reviewed);
+}
+
+static void review_start(
     nbgl_operationType_t operation_type,
     const nbgl_icon_details_t *icon,
     const char *review_title,
     const char *review_subtitle,
     const char *finish_title,
+    void (*add_entries)(),
+    void (*on_entries_reviewed)(),
     nbgl_choiceCallback_t choice_callback,
     bool use_small_font
 ) {
-    // The tagValueList gets copied in nbgl_useCaseReview, therefore it's sufficient to initialize it only in temporary
-    // memory. We use G_io_apdu buffer as temporary buffer, to save some stack space. Note that the review entries are
-    // not copied, and we therefore have them in global memory.
-    DECLARE_TEMPORARY_G_IO_APDU_BUFFER_POINTER(nbgl_contentTagValueList_t *, temporary_tag_value_list_pointer);
-    // Initialize list with zeroes, including .nbMaxLinesForValue (no limit of lines to display).
-    memset(temporary_tag_value_list_pointer, 0, sizeof(*temporary_tag_value_list_pointer));
-    temporary_tag_value_list_pointer->wrapping = true; // Prefer wrapping on spaces, e.g. for nicer address formatting.
-    temporary_tag_value_list_pointer->smallCaseForValue = use_small_font;
-    temporary_tag_value_list_pointer->pairs = review_entries.entries;
-    temporary_tag_value_list_pointer->nbPairs = review_entries.count;
-
-    nbgl_useCaseReview(
+    // Initialize the review with zeroes, including the tag value list's .nbMaxLinesForValue (no limit of lines to
+    // display).
+    memset(&review, 0, sizeof(review));
+    review.tag_value_list.wrapping = true; // Prefer wrapping on spaces, e.g. for nicer address formatting.
+    review.tag_value_list.smallCaseForValue = use_small_font;
+    review.add_entries = add_entries;
+    review.on_entries_reviewed = on_entries_reviewed;
+    review.choice_callback = choice_callback;
+    review.finish_title = finish_title;
+
+    // The first batch is prepared once the user starts the review, see review_on_batch_reviewed.
+    nbgl_useCaseReviewStreamingStart(
         operation_type,
-        temporary_tag_value_list_pointer,
         icon,
         review_title,
         review_subtitle,
-        finish_title,
-        choice_callback
+        review_on_batch_reviewed
     );
-
-    // Make sure that the list was in fact copied, to detect if that ever changes internally in nbgl_useCaseReview.
-    // Unfortunately, we can't easily memcmp via a pointer to where the data is copied to, as the data is copied to a
-    // static variable in nbgl_use_case.c and there's also no non-static method that exposes pointers to it. Instead, we
-    // reset the temporary buffer, to make it immediately noticeable via Ragger end-to-end tests if the data was not
-    // copied. Use explicit_bzero instead of memset to avoid this being optimized away.
-    explicit_bzero(temporary_tag_value_list_pointer, sizeof(*temporary_tag_value_list_pointer));
 }
 
 //////////////////////////////////////////////////////////////////////
 
 // Transaction signing UI
 
-static void ui_transaction_prepare_review_entries_normal_or_staking_outgoing() {
-    review_entries_initialize();
-    review_entries_add_optional(
-        "Amount",
-        PARSED_TX.value,
-        ux_transaction_generic_has_amount_entry()
-    );
-    review_entries_add(
-        "Recipient",
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.recipient
-    );
-    review_entries_add_optional(
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_label,
-        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data,
-        ux_transaction_normal_or_staking_outgoing_has_data_entry()
-    );
-    review_entries_add_optional(
-        "Fee",
-        PARSED_TX.fee,
-        ux_transaction_generic_has_fee_entry()
-    );
-    review_entries_add(
-        "Network",
-        PARSED_TX.network
-    );
-}
-
-static void ui_transaction_prepare_review_entries_staking_incoming() {
-    review_entries_initialize();
-    // Amount for non-signaling transactions
-    review_entries_add_optional(
-        "Amount",
-        PARSED_TX.value,
-        ux_transaction_generic_has_amount_entry()
-    );
-    // Amount in incoming staking data for signaling transactions
-    review_entries_add_optional(
-        "Amount",
-        PARSED_TX_STAKING_INCOMING.set_active_stake_or_retire_stake.amount,
-        ux_transaction_staking_incoming_has_set_active_stake_or_retire_stake_amount_entry()
-    );
-    review_entries_add_optional(
-        "Staker",
-        PARSED_TX_STAKING_INCOMING.validator_or_staker_address,
-        ux_transaction_staking_incoming_has_staker_address_entry()
-    );
-    review_entries_add_optional(
-        "Delegation",
-        PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker.delegation,
-        ux_transaction_staking_incoming_has_create_staker_or_update_staker_delegation_entry()
-    );
-    review_entries_add_optional(
-        "Reactivate all Stake",
-        PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker
-            .update_staker_reactivate_all_stake,
-        ux_transaction_staking_incoming_has_update_staker_reactivate_all_stake_entry()
-    );
-    review_entries_add_optional(
-        "Fee",
-        PARSED_TX.fee,
-        ux_transaction_generic_has_fee_entry()
-    );
-    review_entries_add(
-        "Network",
-        PARSED_TX.network
-    );
+static void ui_transaction_add_review_entries() {
+    uint8_t row_count;
+    const ux_transaction_entry_row_t *rows = ux_transaction_get_entry_rows(&row_count);
+    for (uint8_t row_index = 0; row_index < row_count; row_index++) {
+        const ux_transaction_entry_row_t *row = &rows[row_index];
+        if (row->value == UX_TRANSACTION_ENTRY_NETWORK) {
+            // The network name is a constant string, which does not need to be printed.
+            review_entries_add(row->label, PARSED_TX.network);
+            continue;
+        }
+        review_entries_add_printed_transaction_entry(
+            row->label,
+            row->value,
+            ux_transaction_is_entry_row_displayed(row)
+        );
+    }
 }
 
 static void on_transaction_reviewed(bool approved) {
@@ -307,38 +323,51 @@ void ui_transaction_signing() {
             review_title = "Review withrawal\nof previously staked NIM";
             finish_title = "Sign withdrawal\nof previously staked NIM";
             break;
-        default:
-            // This should not happen, as the transaction parser should have set a valid transaction label type.
-            LEDGER_ASSERT(
-                false,
-                "Invalid transaction label type"
-            );
-    }
-
-    switch (PARSED_TX.transaction_type) {
-        case TRANSACTION_TYPE_NORMAL:
-        case TRANSACTION_TYPE_STAKING_OUTGOING:
-            ui_transaction_prepare_review_entries_normal_or_staking_outgoing();
+        case TRANSACTION_LABEL_TYPE_STAKING_CREATE_VALIDATOR:
+            review_title = "Review\nvalidator creation";
+            finish_title = "Sign\nvalidator creation";
+            review_subtitle = "This transaction creates a validator and locks the amount as its deposit.";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_UPDATE_VALIDATOR:
+            review_title = "Review\nvalidator update";
+            finish_title = "Sign\nvalidator update";
+            review_subtitle = "This transaction updates your validator with the following changes.";
             break;
-        case TRANSACTION_TYPE_STAKING_INCOMING:
-            ui_transaction_prepare_review_entries_staking_incoming();
+        case TRANSACTION_LABEL_TYPE_STAKING_DEACTIVATE_VALIDATOR:
+            review_title = "Review\nvalidator deactivation";
+            finish_title = "Sign\nvalidator deactivation";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_REACTIVATE_VALIDATOR:
+            review_title = "Review\nvalidator reactivation";
+            finish_title = "Sign\nvalidator reactivation";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_RETIRE_VALIDATOR:
+            review_title = "Review\nvalidator retirement";
+            finish_title = "Sign\nvalidator retirement";
+            review_subtitle = "This transaction retires your validator. This needs to be done first, if you want to "
+                "later delete it and withdraw its deposit.";
+            break;
+        case TRANSACTION_LABEL_TYPE_STAKING_DELETE_VALIDATOR:
+            review_title = "Review deletion\nof retired validator";
+            finish_title = "Sign deletion\nof retired validator";
+            review_subtitle = "This transaction withdraws the deposit of your retired validator.";
             break;
-        case TRANSACTION_TYPE_VESTING_CREATION:
-        case TRANSACTION_TYPE_HTLC_CREATION:
         default:
-            // This should not happen, as the transaction parser should have set a valid transaction type.
+            // This should not happen, as the transaction parser should have set a valid transaction label type.
             LEDGER_ASSERT(
                 false,
-                "Invalid transaction type"
+                "Invalid transaction label type"
             );
     }
 
-    review_entries_launch_use_case_review(
+    review_start(
         /* operation_type */ TYPE_TRANSACTION,
         /* icon */ &ICON_APP_NIMIQ,
         /* review_title */ review_title,
         /* review_subtitle */ review_subtitle,
         /* finish_title */ finish_title,
+        /* add_entries */ ui_transaction_add_review_entries,
+        /* on_entries_reviewed */ NULL,
         /* choice_callback */ on_transaction_reviewed,
         /* use_small_font */ false
     );
@@ -348,17 +377,107 @@ void ui_transaction_signing() {
 
 // Message signing UI
 
-static void ui_message_prepare_review_entries(message_display_type_t messageDisplayType) {
-    review_entries_initialize();
-    ctx.req.msg.confirm.displayType = messageDisplayType; // used in ux_message_signing_prepare_printed_message
-    ux_message_signing_prepare_printed_message();
-    review_entries_add(
-        ctx.req.msg.confirm.printedMessageLabel,
-        ctx.req.msg.confirm.printedMessage
+// Messages are printed as single values of up to the batch budget, such that each batch holds one part. Ascii messages
+// always fit a single part, only longer messages displayed as hex are split.
+_Static_assert(
+    MAX_PRINTABLE_MESSAGE_LENGTH + /* string terminator */ 1 <= REVIEW_BATCH_ARENA_BUDGET,
+    "Printable ascii messages don't fit a single review batch"
+);
+
+// Number the label of message parts, e.g. "Message Hex (2/2)", if the message is split into multiple parts.
+static const char *ui_message_print_part_label(const char *label, uint8_t part_index, uint8_t part_count) {
+    if (part_count == 1) return label;
+    uint16_t available_length;
+    char *out = request_arena_print_begin(&available_length);
+    LEDGER_ASSERT(available_length >= STRING_LENGTH_MESSAGE_PART_LABEL, "Message part label does not fit");
+    uint16_t length = strlen(label);
+    memcpy(out, label, length);
+    out[length++] = ' ';
+    out[length++] = '(';
+    LEDGER_ASSERT(print_u32(part_index + 1, &out[length], available_length - length) == ERROR_NONE,
+        "Failed to print message part label");
+    length += strlen(&out[length]);
+    out[length++] = '/';
+    LEDGER_ASSERT(print_u32(part_count, &out[length], available_length - length) == ERROR_NONE,
+        "Failed to print message part label");
+    length += strlen(&out[length]);
+    out[length++] = ')';
+    out[length] = '\0';
+    return request_arena_print_end();
+}
+
+static void ui_message_add_review_entries() {
+    // Instead of printing the whole message at once, which takes twice the message length for display as hex, it's
+    // printed per batch straight from the printable message or message hash.
+    const char *label = ux_message_signing_get_message_label();
+    uint8_t part_count = ux_message_signing_get_message_part_count(REVIEW_BATCH_ARENA_BUDGET);
+    for (uint8_t part_index = 0; part_index < part_count; part_index++) {
+        if (!review_entries_is_in_batch(REVIEW_BATCH_ARENA_BUDGET)) continue;
+        const char *part_label = ui_message_print_part_label(label, part_index, part_count);
+        review_entries_add_printed(
+            part_label,
+            ux_message_signing_print_message_part(part_index, REVIEW_BATCH_ARENA_BUDGET)
+        );
+    }
+}
+
+static bool ui_message_is_display_type_available(message_display_type_t display_type) {
+    switch (display_type) {
+        case MESSAGE_DISPLAY_TYPE_ASCII:
+            return ctx.req.msg.isPrintableAscii;
+        case MESSAGE_DISPLAY_TYPE_HEX:
+            return ctx.req.msg.messageLength <= MAX_PRINTABLE_MESSAGE_LENGTH;
+        default:
+            return true;
+    }
+}
+
+// The display type offered for switching to, cycling through the available display types in the order ascii, hex,
+// hash. Returns the current display type, if no other display type is available.
+static message_display_type_t ui_message_get_next_display_type() {
+    message_display_type_t display_type = ctx.req.msg.displayType;
+    do {
+        display_type = display_type == MESSAGE_DISPLAY_TYPE_ASCII
+            ? MESSAGE_DISPLAY_TYPE_HEX
+            : display_type == MESSAGE_DISPLAY_TYPE_HEX
+                ? MESSAGE_DISPLAY_TYPE_HASH
+                : MESSAGE_DISPLAY_TYPE_ASCII;
+    } while (!ui_message_is_display_type_available(display_type)); // terminates as hash display is always available
+    return display_type;
+}
+
+static void ui_message_on_display_type_choice(bool switch_display_type) {
+    if (!switch_display_type) {
+        review_finish();
+        return;
+    }
+    // Restart the review with the other display type. As the message is printed on demand, nothing needs to be
+    // prepared for switching.
+    ui_message_signing(ui_message_get_next_display_type(), true);
+}
+
+static void ui_message_on_entries_reviewed() {
+    // Offer to switch the display type after the message, like the BAGL message flow.
+    message_display_type_t next_display_type = ui_message_get_next_display_type();
+    if (next_display_type == ctx.req.msg.displayType) {
+        review_finish();
+        return;
+    }
+    nbgl_useCaseChoice(
+        /* icon */ &ICON_APP_REVIEW,
+        /* message */ "Display the message\nin another format?",
+        /* sub message */ NULL,
+        /* confirm text */ next_display_type == MESSAGE_DISPLAY_TYPE_ASCII
+            ? "Display as Text"
+            : next_display_type == MESSAGE_DISPLAY_TYPE_HEX
+                ? "Display as Hex"
+                : "Display as Hash",
+        /* reject text */ "Continue",
+        /* callback */ ui_message_on_display_type_choice
     );
 }
 
-// Called when long press button on 3rd page is long-touched or when reject footer is touched.
+// Called when long press button on the last page is long-touched or when reject footer is touched.
 static void on_message_reviewed(bool approved) {
     if (approved) {
         on_message_approved(),
@@ -370,6 +489,7 @@ static void on_message_reviewed(bool approved) {
 }
 
 void ui_message_signing(message_display_type_t messageDisplayType, bool startAtMessageDisplay) {
+    // The streaming review always starts at its intro page, which also names the display type in its subtitle.
     UNUSED(startAtMessageDisplay);
 
     // Pointer to pre-existing const strings in read-only data segment / flash memory. Not meant to be written to.
@@ -391,14 +511,16 @@ void ui_message_signing(message_display_type_t messageDisplayType, bool startAtM
                 "Invalid message display type"
             );
     }
-    ui_message_prepare_review_entries(messageDisplayType);
+    ctx.req.msg.displayType = messageDisplayType; // used in ux_message_signing_print_message
 
-    review_entries_launch_use_case_review(
+    review_start(
         /* operation_type */ TYPE_MESSAGE,
         /* icon */ &ICON_APP_REVIEW, // provided by ledger-secure-sdk
         /* review_title */ "Review message",
         /* review_subtitle */ review_subtitle,
         /* finish_title */ "Sign message",
+        /* add_entries */ ui_message_add_review_entries,
+        /* on_entries_reviewed */ ui_message_on_entries_reviewed,
         /* choice_callback */ on_message_reviewed,
         /* use_small_font */ true
     );
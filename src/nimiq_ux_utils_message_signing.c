@@ -15,32 +15,101 @@
  *  limitations under the License.
  ********************************************************************************/
 
+#include <string.h>
+
 #include "nimiq_ux_utils_message_signing.h"
 #include "globals.h"
 
-void ux_message_signing_prepare_printed_message() {
+const char *ux_message_signing_get_message_label() {
+    // Pointers to constant strings in read-only data segment / flash memory.
+    return ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_ASCII
+        ? "Message"
+        : ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_HEX
+            ? "Message Hex"
+            : "Message Hash";
+}
+
+// Number of message bytes printed per part, for the current display type.
+static uint16_t get_message_part_byte_count(uint16_t max_printed_length) {
+    LEDGER_ASSERT(
+        max_printed_length > 2 * sizeof(ctx.req.msg.messageHash),
+        "Message part too short"
+    );
+    switch (ctx.req.msg.displayType) {
+        case MESSAGE_DISPLAY_TYPE_ASCII:
+            return max_printed_length - /* string terminator */ 1;
+        case MESSAGE_DISPLAY_TYPE_HEX:
+            return (max_printed_length - /* string terminator */ 1) / 2;
+        default:
+            // The hash is always printed as a single part.
+            return sizeof(ctx.req.msg.messageHash);
+    }
+}
+
+uint8_t ux_message_signing_get_message_part_count(uint16_t max_printed_length) {
+    if (ctx.req.msg.displayType == MESSAGE_DISPLAY_TYPE_HASH) return 1;
+    uint16_t part_byte_count = get_message_part_byte_count(max_printed_length);
+    // The message length is at most MAX_PRINTABLE_MESSAGE_LENGTH for display as ascii or hex, see handle_sign_message.
+    // An empty message is printed as a single empty part.
+    uint32_t part_count = MAX((ctx.req.msg.messageLength + part_byte_count - 1) / part_byte_count, 1);
+    LEDGER_ASSERT(
+        part_count <= UINT8_MAX,
+        "Too many message parts"
+    );
+    return (uint8_t) part_count;
+}
+
+char *ux_message_signing_print_message_part(uint8_t part_index, uint16_t max_printed_length) {
     // No errors are expected here, as all data has already been verified in handleSignMessage
-    switch (ctx.req.msg.confirm.displayType) {
+    uint16_t part_byte_count = get_message_part_byte_count(max_printed_length);
+    uint32_t part_offset = (uint32_t) part_index * part_byte_count;
+    LEDGER_ASSERT(
+        part_index < ux_message_signing_get_message_part_count(max_printed_length),
+        "Invalid message part"
+    );
+    part_byte_count = MIN(part_byte_count, ctx.req.msg.messageLength - part_offset);
+    uint16_t printed_message_length;
+    char *printed_message = request_arena_print_begin(&printed_message_length);
+    switch (ctx.req.msg.displayType) {
         case MESSAGE_DISPLAY_TYPE_ASCII:
-            COPY_FIXED_SIZE(ctx.req.msg.confirm.printedMessageLabel, "Message");
-            memmove(ctx.req.msg.confirm.printedMessage, ctx.req.msg.printableMessage, ctx.req.msg.messageLength);
-            ctx.req.msg.confirm.printedMessage[ctx.req.msg.messageLength] = '\0'; // string terminator
+            LEDGER_ASSERT(
+                part_byte_count < printed_message_length,
+                "Failed to print message"
+            );
+            memmove(printed_message, ctx.req.msg.printableMessage + part_offset, part_byte_count);
+            printed_message[part_byte_count] = '\0'; // string terminator
             break;
         case MESSAGE_DISPLAY_TYPE_HEX:
-            COPY_FIXED_SIZE(ctx.req.msg.confirm.printedMessageLabel, "Message Hex");
             LEDGER_ASSERT(
-                print_hex(ctx.req.msg.printableMessage, ctx.req.msg.messageLength, ctx.req.msg.confirm.printedMessage,
-                    sizeof(ctx.req.msg.confirm.printedMessage)) == ERROR_NONE,
+                print_hex(ctx.req.msg.printableMessage + part_offset, part_byte_count, printed_message,
+                    printed_message_length) == ERROR_NONE,
                 "Failed to print message hex"
             );
             break;
         case MESSAGE_DISPLAY_TYPE_HASH:
-            COPY_FIXED_SIZE(ctx.req.msg.confirm.printedMessageLabel, "Message Hash");
             LEDGER_ASSERT(
-                print_hex(ctx.req.msg.confirm.messageHash, sizeof(ctx.req.msg.confirm.messageHash),
-                    ctx.req.msg.confirm.printedMessage, sizeof(ctx.req.msg.confirm.printedMessage)) == ERROR_NONE,
+                print_hex(ctx.req.msg.messageHash, sizeof(ctx.req.msg.messageHash), printed_message,
+                    printed_message_length) == ERROR_NONE,
                 "Failed to print message hash"
             );
             break;
     }
+    return request_arena_print_end();
+}
+
+char *ux_message_signing_print_message() {
+    request_arena_free_all();
+    // The whole message fits a single part of PRINTED_MESSAGE_MAX_LENGTH.
+    return ux_message_signing_print_message_part(0, PRINTED_MESSAGE_MAX_LENGTH);
+}
+
+char *ux_message_signing_print_message_length() {
+    request_arena_free_all();
+    uint16_t printed_length_length;
+    char *printed_length = request_arena_print_begin(&printed_length_length);
+    LEDGER_ASSERT(
+        print_u32(ctx.req.msg.messageLength, printed_length, printed_length_length) == ERROR_NONE,
+        "Failed to print message length"
+    );
+    return request_arena_print_end();
 }
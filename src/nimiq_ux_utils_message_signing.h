@@ -21,6 +21,29 @@
 #include "constants.h"
 #include "error_macros.h"
 
-void ux_message_signing_prepare_printed_message();
+/**
+ * Label of the message entry for the current display type. Returns a pointer to a constant string.
+ */
+const char *ux_message_signing_get_message_label();
+
+/**
+ * Print the message for the current display type, or the message length, into the request arena, after freeing all
+ * previous allocations. The printed string is thus always located at REQUEST_ARENA_START(messageSigningContext_t).
+ */
+char *ux_message_signing_print_message();
+char *ux_message_signing_print_message_length();
+
+/**
+ * Number of parts of at most max_printed_length, including the string terminator, into which the message is split for
+ * the current display type. The hash is always a single part, and max_printed_length must fit it.
+ */
+uint8_t ux_message_signing_get_message_part_count(uint16_t max_printed_length);
+
+/**
+ * Print a part of the message for the current display type into the request arena, straight from the printable message
+ * or message hash. In contrast to ux_message_signing_print_message, previous allocations are kept, such that multiple
+ * parts can be printed and referenced at the same time.
+ */
+char *ux_message_signing_print_message_part(uint8_t part_index, uint16_t max_printed_length);
 
 #endif //_NIMIQ_UX_UTILS_MESSAGE_SIGNING_H_
@@ -21,192 +21,404 @@
 #include "nimiq_ux_utils_transaction_signing.h"
 #include "globals.h"
 
-bool ux_transaction_generic_has_amount_entry() {
-    // The transaction amount can be 0 for signaling transactions, in which case we want to show the amount given in the
-    // IncomingStakingTransactionData instead, if applicable.
-    return strcmp(PARSED_TX.value, "0 NIM") != 0;
-}
+// Printing of transaction entries
+// The parsed transaction is stored in binary form and values are only printed when they are about to be displayed, see
+// parsed_tx_t. All values have already been validated during parsing, such that printing is not expected to fail.
 
-bool ux_transaction_generic_has_fee_entry() {
-    return strcmp(PARSED_TX.fee, "0 NIM") != 0;
+static void print_amount_entry(uint64_t amount, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        out_length >= STRING_LENGTH_NIM_AMOUNT_WITH_TICKER
+            && parse_amount(amount, "NIM", out) == ERROR_NONE,
+        "Failed to print amount"
+    );
 }
 
-bool ux_transaction_normal_or_staking_outgoing_has_data_entry() {
-    return strlen(PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data);
+static void print_address_entry(uint8_t *address, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        out_length >= STRING_LENGTH_USER_FRIENDLY_ADDRESS
+            && print_address(address, out) == ERROR_NONE,
+        "Failed to print address"
+    );
 }
 
-// HTLC creation specific UI steps and flow
-// As HTLCs are quite technical, we try to not display the less relevant information to the user.
-// Considerations for which data can be safely skipped under which circumstances:
-// - transaction recipient address (not to be confused with the htlc recipient address, also called redeem address):
-//   The recipient address for the contract creation must be the contract address which is deterministically calculated
-//   from the other transaction parameters. Any transaction with a different recipient address than the expected address
-//   is rejected by the Nimiq network which does therefore not need to be displayed or checked.
-// - htlc refund address (also called htlc sender; not to be confused with the transaction sender):
-//   If the refund address equals the transaction sender, we omit display because then the funds can be refunded to
-//   where they came from, which is an address of a BasicAccount or MultiSig under (partial) control of this Ledger.
-//   Note that any other address under the control of this Ledger could also be whitelisted, but currently the refund
-//   address being equal to the transaction sender is the normal case in our current use cases and whitelisting other
-//   Ledger addresses would require transmitting the refund address key path with the request, such that we can verify
-//   that the address is one under control of this Ledger.
-// - hash algorithm:
-//   As the user confirms the hash root, an attacker trying to let the user create a htlc with the wrong hash algorithm
-//   would need to know the pre-image for the hash root for the specified algorithm to be able to gain access to the
-//   funds which is close to impossible unless he's the legitimate recipient anyways who specified the confirmed hash
-//   root. The worst that can happen, is that the funds are locked until the timeout at which point they can be redeemed
-//   by the refund address owner. To avoid that the refund address owner as attacker could take advantage of making it
-//   impossible for the redeem address owner to redeem the funds, we skip the hash algorithm display only if the refund
-//   address is our address (see above). As an additional restriction, we also skip the display of the hash algorithm
-//   only if it's sha256 which is the commonly used hash algorithm and if the funds are not locked for a long time.
-// - hash count (here called hash steps):
-//   Specifying a lower hash count than the actual intended hash count allows the htlc redeem address owner as attacker
-//   to redeem more funds per pre-image step than intended. However, if the user's machine creating the manipulated
-//   transaction to be signed on the Ledger is compromised, also usually the htlc secret (unhashed pre-image) which is
-//   usually on the same machine is compromised such that the hash count doesn't matter anymore. I.e. if the htlc secret
-//   is compromised, the hash count yields no protection of the funds anymore.
-//   Specifying a higher hash count than the intended one effectively locks part of the funds for the redeem address
-//   owner until they become available to the refund address owner after the timeout. To avoid that the refund address
-//   owner as attacker could take advantage of blocking funds to the redeem address owner, we skip the display of the
-//   hash count only if the refund address is our address (see above). Additionally, to avoid that funds are potentially
-//   locked via a higher hash count for a long time, we only skip the display for short timeouts. However, as blocking
-//   the funds requires a higher hash count than the actual one, for 1, the lowest possible hash count, we never have to
-//   display it.
-// - timeout (here called htlc expiry block):
-//   The timeout specifies for how long funds will be locked if not redeemed until they are refundable. As short
-//   timeouts (which should be the case for most practically used htlcs) are favorable for the user if the refund
-//   address is his, we don't display short timeouts. To avoid that another refund address owner as attacker could take
-//   advantage of a short or already passed timeout, we skip the timeout display only if the refund address is our
-//   address (see above).
-
-bool ux_transaction_htlc_creation_has_refund_address_entry() {
-    return !PARSED_TX_HTLC_CREATION.is_refund_address_sender_address;
+static void print_hex_entry(uint8_t *data, uint16_t data_length, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        print_hex(data, data_length, out, out_length) == ERROR_NONE,
+        "Failed to print hex"
+    );
 }
 
-bool ux_transaction_htlc_creation_has_hash_algorithm_entry() {
-    return !PARSED_TX_HTLC_CREATION.is_refund_address_sender_address
-        || !PARSED_TX_HTLC_CREATION.is_timing_out_soon
-        || !PARSED_TX_HTLC_CREATION.is_using_sha256;
+static void print_block_count_entry(uint32_t block_count, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        print_block_count(block_count, out, out_length) == ERROR_NONE,
+        "Failed to print block count"
+    );
 }
 
-bool ux_transaction_htlc_creation_has_hash_count_entry() {
-    return strcmp(PARSED_TX_HTLC_CREATION.hash_count, "1") != 0
-        && (!PARSED_TX_HTLC_CREATION.is_refund_address_sender_address || !PARSED_TX_HTLC_CREATION.is_timing_out_soon);
+static void print_u32_entry(uint32_t value, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        print_u32(value, out, out_length) == ERROR_NONE,
+        "Failed to print number"
+    );
 }
 
-bool ux_transaction_htlc_creation_has_timeout_entry() {
-    return !PARSED_TX_HTLC_CREATION.is_refund_address_sender_address
-        || !PARSED_TX_HTLC_CREATION.is_timing_out_soon;
+static void print_string_entry(const char *string, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        print_string(string, out, out_length) == ERROR_NONE,
+        "Failed to print string"
+    );
 }
 
-// Vesting Contract Creation specific UI steps and flow
-// Other than for HTLCs we generally do not try to skip less relevant data as vesting contracts are only rarely created
-// and all parameters are similarly important. However, depending on the specific vesting contract parameters, some data
-// is redundant. Specifically, we have the following optimizations:
-// - vesting owner:
-//   Display of the vesting owner address is skipped if it equals the transaction sender address.
-// - for 0 steps (all funds are pre-vested):
-//   We only show the info about the pre-vested amount and skip all other data.
-// - for 1 step (all funds unlock at a specific block):
-//   We show a special entry with the vesting block. Additionally, the step for a pre-vested amount might be shown. All
-//   other info is redundant and skipped.
-// - for 2 steps:
-//   If first step amount and last step amount differ from regular step amount, do not display what would be the regular
-//   step amount as all steps differ from that.
-
-bool ux_transaction_vesting_creation_has_owner_address_entry() {
-    return !PARSED_TX_VESTING_CREATION.is_owner_address_sender_address;
-}
+char *ux_transaction_print_entry(ux_transaction_entry_t entry, char *out, uint16_t out_length) {
+    LEDGER_ASSERT(
+        out_length > 0,
+        "Empty print buffer"
+    );
+    switch (entry) {
+        case UX_TRANSACTION_ENTRY_AMOUNT:
+            print_amount_entry(PARSED_TX.value, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_FEE:
+            print_amount_entry(PARSED_TX.fee, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_NETWORK:
+            print_string_entry(PARSED_TX.network, out, out_length);
+            break;
 
-bool ux_transaction_vesting_creation_has_single_vesting_block_entry() {
-    // simplified ui for step_count == 1 case
-    return !PARSED_TX_VESTING_CREATION.is_multi_step;
-}
+        case UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_RECIPIENT:
+            print_address_entry(PARSED_TX_NORMAL_OR_STAKING_OUTGOING.recipient, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_DATA:
+            if (PARSED_TX_NORMAL_OR_STAKING_OUTGOING.is_extra_data_hex) {
+                LEDGER_ASSERT(
+                    print_hex(PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data,
+                        PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_length, out, out_length) == ERROR_NONE,
+                    "Failed to print data hex"
+                );
+            } else {
+                // Note that the data is not a \0 terminated string, which is why we add the string terminator manually.
+                LEDGER_ASSERT(
+                    PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_length < out_length,
+                    "Failed to print data"
+                );
+                memmove(out, PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data,
+                    PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_length);
+                out[PARSED_TX_NORMAL_OR_STAKING_OUTGOING.extra_data_length] = '\0';
+            }
+            break;
 
-bool ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries() {
-    return PARSED_TX_VESTING_CREATION.is_multi_step;
-}
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_REDEEM_ADDRESS:
+            print_address_entry(PARSED_TX_HTLC_CREATION.redeem_address, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_REFUND_ADDRESS:
+            print_address_entry(PARSED_TX_HTLC_CREATION.refund_address, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ROOT:
+            LEDGER_ASSERT(
+                print_hex(PARSED_TX_HTLC_CREATION.hash_root,
+                    PARSED_TX_HTLC_CREATION.hash_algorithm == HASH_ALGORITHM_SHA512 ? 64 : 32, out, out_length)
+                    == ERROR_NONE,
+                "Failed to print hash root"
+            );
+            break;
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ALGORITHM:
+            print_string_entry(PARSED_TX_HTLC_CREATION.hash_algorithm == HASH_ALGORITHM_BLAKE2B
+                ? "BLAKE2b"
+                : PARSED_TX_HTLC_CREATION.hash_algorithm == HASH_ALGORITHM_SHA256 ? "SHA-256" : "SHA-512",
+                out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_COUNT:
+            print_u32_entry(PARSED_TX_HTLC_CREATION.hash_count, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_HTLC_CREATION_TIMEOUT:
+            print_u32_entry(PARSED_TX_HTLC_CREATION.timeout, out, out_length);
+            break;
 
-bool ux_transaction_vesting_creation_has_first_step_duration_entry() {
-    return PARSED_TX_VESTING_CREATION.is_multi_step
-        // The first step duration is different from the regular step duration.
-        && strcmp(PARSED_TX_VESTING_CREATION.first_step_block_count, PARSED_TX_VESTING_CREATION.step_block_count) != 0;
-}
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_OWNER_ADDRESS:
+            print_address_entry(PARSED_TX_VESTING_CREATION.owner_address, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_SINGLE_VESTING_BLOCK:
+            // Guaranteed to not overflow as also start_block + period <= UINT32_MAX, see parse_vesting_creation_data.
+            print_u32_entry(PARSED_TX_VESTING_CREATION.start_block + PARSED_TX_VESTING_CREATION.first_step_block_count, out,
+                out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_START_BLOCK:
+            print_u32_entry(PARSED_TX_VESTING_CREATION.start_block, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_PERIOD:
+            print_block_count_entry(PARSED_TX_VESTING_CREATION.period, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_COUNT:
+            print_u32_entry(PARSED_TX_VESTING_CREATION.step_count, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_BLOCK_COUNT:
+            print_block_count_entry(PARSED_TX_VESTING_CREATION.step_block_count, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT:
+            print_block_count_entry(PARSED_TX_VESTING_CREATION.first_step_block_count, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_AMOUNT:
+            print_amount_entry(PARSED_TX_VESTING_CREATION.step_amount, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_AMOUNT:
+            print_amount_entry(PARSED_TX_VESTING_CREATION.first_step_amount, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_LAST_STEP_AMOUNT:
+            print_amount_entry(PARSED_TX_VESTING_CREATION.last_step_amount, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_VESTING_CREATION_PRE_VESTED_AMOUNT:
+            print_amount_entry(PARSED_TX_VESTING_CREATION.pre_vested_amount, out, out_length);
+            break;
 
-bool ux_transaction_vesting_creation_has_step_amount_entry() {
-    return PARSED_TX_VESTING_CREATION.is_multi_step
-        // Skip if step_count == 2 and both steps differ from what would be the regular step amount.
-        && !(
-            strcmp(PARSED_TX_VESTING_CREATION.step_count, "2") == 0
-                && strcmp(PARSED_TX_VESTING_CREATION.first_step_amount, PARSED_TX_VESTING_CREATION.step_amount) != 0
-                && strcmp(PARSED_TX_VESTING_CREATION.last_step_amount, PARSED_TX_VESTING_CREATION.step_amount) != 0
-        );
-}
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT:
+            print_amount_entry(PARSED_TX_STAKING_INCOMING.set_active_stake_or_retire_stake.amount, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_STAKER_ADDRESS:
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_VALIDATOR_ADDRESS:
+            print_address_entry(PARSED_TX_STAKING_INCOMING.validator_or_staker_address, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION:
+            print_address_entry(PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker.delegation, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE:
+            print_string_entry(
+                PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker.update_staker_reactivate_all_stake
+                    ? "Yes"
+                    : "No",
+                out,
+                out_length
+            );
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY:
+            print_hex_entry(PARSED_TX_STAKING_INCOMING.create_validator_or_update_validator.signing_key, 32, out,
+                out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT:
+            print_hex_entry(PARSED_TX_STAKING_INCOMING.create_validator_or_update_validator.voting_key_fingerprint,
+                32, out, out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS:
+            print_address_entry(PARSED_TX_STAKING_INCOMING.create_validator_or_update_validator.reward_address, out,
+                out_length);
+            break;
+        case UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA:
+            if (PARSED_TX_STAKING_INCOMING.create_validator_or_update_validator.signal_data) {
+                print_hex_entry(PARSED_TX_STAKING_INCOMING.create_validator_or_update_validator.signal_data, 32, out,
+                    out_length);
+            } else {
+                // The signal data is cleared by an update.
+                print_string_entry("None", out, out_length);
+            }
+            break;
 
-bool ux_transaction_vesting_creation_has_first_step_amount_entry() {
-    return PARSED_TX_VESTING_CREATION.is_multi_step
-        // The first step amount is different from the regular step amount.
-        && strcmp(PARSED_TX_VESTING_CREATION.first_step_amount, PARSED_TX_VESTING_CREATION.step_amount) != 0;
+        default:
+            LEDGER_ASSERT(
+                false,
+                "Invalid transaction entry"
+            );
+    }
+    return out;
 }
 
-bool ux_transaction_vesting_creation_has_last_step_amount_entry() {
-    return PARSED_TX_VESTING_CREATION.is_multi_step
-        // The last step amount is different from the regular step amount.
-        && strcmp(PARSED_TX_VESTING_CREATION.last_step_amount, PARSED_TX_VESTING_CREATION.step_amount) != 0;
+char *ux_transaction_print_entry_to_arena(ux_transaction_entry_t entry) {
+    uint16_t out_length;
+    char *out = request_arena_print_begin(&out_length);
+    ux_transaction_print_entry(entry, out, out_length);
+    return request_arena_print_end();
 }
 
-bool ux_transaction_vesting_creation_has_pre_vested_amount_entry() {
-    return strcmp(PARSED_TX_VESTING_CREATION.pre_vested_amount, "0 NIM") != 0;
-}
+// Transaction entry rows
+// The displayed values of each transaction type, in display order. The tables are shared by the BAGL and NBGL UIs, such
+// that both display the same values with the same labels, and skip optional values under the same conditions, see
+// compute_tx_display_plan.
 
-// Incoming staking transaction (transactions to the staking contract) specific UI steps and flow
-// Considerations for which data can be safely skipped under which circumstances:
-// - 0 NIM transaction amount for signaling transactions. If the incoming staking data includes an amount, that is shown
-//   instead.
-// - transaction recipient address as this must be the staking contract.
-// - validator address (from validator signature proof): is always displayed as validator management is considered an
-//   advanced feature, where the user probably wants to have a complete overview of the transaction data. It's also not
-//   a very regularly occurring / common transaction.
-// - staker address (from staker signature proof): If the staker address equals the transaction sender, we omit display
-//   because then the staker is under control of the user / this Ledger (in case of multi-sig, partial control). This is
-//   also the most common case. We don't need to check that the sender address actually belongs to the Ledger account as
-//   a signature for a wrong sender address will be rejected by the network. This also covers contracts as sender as the
-//   staker address can't really be the contract address because for the deterministic contract address, no signing key
-//   is known which could create the valid staker signature proof. Also, multi-sig sender addresses are theoretically
-//   covered, i.e. the mutli-sig signed transactions also assume the multi-sig as staker owner by default, however multi
-//   sig staker signature proofs are not currently supported as they'd require a non-empty merkle path. Note that any
-//   other address under the control of this Ledger could also be whitelisted, but currently the staker address being
-//   equal to the transaction sender is the normal case in our current use cases and whitelisting other Ledger addresses
-//   would require transmitting the staker address key path with the request, such that we can verify that the address
-//   is one under control of this Ledger.
-// - no other parts of the signature proof need to be displayed to the user as invalid signature proofs will be rejected
-//   by the network nodes.
-// - delegation addresses: are always displayed as the assumption is that common, non-advanced users would not delegate
-//   to themselves, and advanced users would like to see this information, even if delegating to themselves.
-
-bool ux_transaction_staking_incoming_has_set_active_stake_or_retire_stake_amount_entry() {
-    // Show if it's a data type that specifies an amount in the data. Note that these are signaling transactions. I.e.
-    // the regular transaction amount is 0, and not displayed.
-    return PARSED_TX_STAKING_INCOMING.type == SET_ACTIVE_STAKE
-        || PARSED_TX_STAKING_INCOMING.type == RETIRE_STAKE;
-}
+// Normal, non contract creation transactions and outgoing staking transactions
+static const ux_transaction_entry_row_t ux_transaction_normal_or_staking_outgoing_entries[] = {
+    // optional, but always displayed as this is not a signaling transaction
+    { "Amount", UX_TRANSACTION_ENTRY_AMOUNT, TX_DISPLAY_AMOUNT },
+    { "Recipient", UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_RECIPIENT, 0 },
+    {
+        "Data",
+        UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_DATA,
+        TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_ASCII,
+    },
+    {
+        "Data Hex",
+        UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_DATA,
+        TX_DISPLAY_NORMAL_OR_STAKING_OUTGOING_DATA_HEX,
+    },
+    { "Fee", UX_TRANSACTION_ENTRY_FEE, TX_DISPLAY_FEE },
+    { "Network", UX_TRANSACTION_ENTRY_NETWORK, 0 },
+};
 
-bool ux_transaction_staking_incoming_has_staker_address_entry() {
-    // Show if it's a staker tx, as opposed to a validator tx, and staker address is set (i.e. it's different to sender)
-    return (PARSED_TX_STAKING_INCOMING.type == CREATE_STAKER
-        || PARSED_TX_STAKING_INCOMING.type == ADD_STAKE
-        || PARSED_TX_STAKING_INCOMING.type == UPDATE_STAKER
-        || PARSED_TX_STAKING_INCOMING.type == SET_ACTIVE_STAKE
-        || PARSED_TX_STAKING_INCOMING.type == RETIRE_STAKE
-    ) && strlen(PARSED_TX_STAKING_INCOMING.validator_or_staker_address);
-}
+// HTLC creation
+static const ux_transaction_entry_row_t ux_transaction_htlc_creation_entries[] = {
+    // optional, but always displayed as this is not a signaling transaction
+    { "Amount", UX_TRANSACTION_ENTRY_AMOUNT, TX_DISPLAY_AMOUNT },
+    { "HTLC Recipient", UX_TRANSACTION_ENTRY_HTLC_CREATION_REDEEM_ADDRESS, 0 },
+    {
+        "Refund to",
+        UX_TRANSACTION_ENTRY_HTLC_CREATION_REFUND_ADDRESS,
+        TX_DISPLAY_HTLC_CREATION_REFUND_ADDRESS,
+    },
+    // more user friendly label for hash root
+    { "Hashed Secret", UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ROOT, 0 },
+    {
+        "Hash Algorithm",
+        UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ALGORITHM,
+        TX_DISPLAY_HTLC_CREATION_HASH_ALGORITHM,
+    },
+    // more user friendly label for hash count
+    { "Hash Steps", UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_COUNT, TX_DISPLAY_HTLC_CREATION_HASH_COUNT },
+    // more user friendly label for timeout
+    { "HTLC Expiry Block", UX_TRANSACTION_ENTRY_HTLC_CREATION_TIMEOUT, TX_DISPLAY_HTLC_CREATION_TIMEOUT },
+    { "Fee", UX_TRANSACTION_ENTRY_FEE, TX_DISPLAY_FEE },
+    { "Network", UX_TRANSACTION_ENTRY_NETWORK, 0 },
+};
+
+// Vesting contract creation
+static const ux_transaction_entry_row_t ux_transaction_vesting_creation_entries[] = {
+    // optional, but always displayed as this is not a signaling transaction
+    { "Amount", UX_TRANSACTION_ENTRY_AMOUNT, TX_DISPLAY_AMOUNT },
+    {
+        "Vesting Owner",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_OWNER_ADDRESS,
+        TX_DISPLAY_VESTING_CREATION_OWNER_ADDRESS,
+    },
+    {
+        // simplified ui for step_count == 1 case
+        "Vested at Block",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_SINGLE_VESTING_BLOCK,
+        TX_DISPLAY_VESTING_CREATION_SINGLE_VESTING_BLOCK,
+    },
+    {
+        "Vesting Start Block",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_START_BLOCK,
+        TX_DISPLAY_VESTING_CREATION_SCHEDULE,
+    },
+    {
+        "Vesting Period",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_PERIOD,
+        TX_DISPLAY_VESTING_CREATION_SCHEDULE,
+    },
+    {
+        "Vesting Steps",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_COUNT,
+        TX_DISPLAY_VESTING_CREATION_SCHEDULE,
+    },
+    {
+        "Blocks Per Step",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_BLOCK_COUNT,
+        TX_DISPLAY_VESTING_CREATION_SCHEDULE,
+    },
+    {
+        "First Step",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT,
+        TX_DISPLAY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT,
+    },
+    {
+        "Vested per Step",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_AMOUNT,
+        TX_DISPLAY_VESTING_CREATION_STEP_AMOUNT,
+    },
+    {
+        "First Step",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_AMOUNT,
+        TX_DISPLAY_VESTING_CREATION_FIRST_STEP_AMOUNT,
+    },
+    {
+        "Last Step",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_LAST_STEP_AMOUNT,
+        TX_DISPLAY_VESTING_CREATION_LAST_STEP_AMOUNT,
+    },
+    {
+        "Pre-Vested",
+        UX_TRANSACTION_ENTRY_VESTING_CREATION_PRE_VESTED_AMOUNT,
+        TX_DISPLAY_VESTING_CREATION_PRE_VESTED_AMOUNT,
+    },
+    { "Fee", UX_TRANSACTION_ENTRY_FEE, TX_DISPLAY_FEE },
+    { "Network", UX_TRANSACTION_ENTRY_NETWORK, 0 },
+};
+
+// Incoming staking transactions (transactions to the staking contract)
+static const ux_transaction_entry_row_t ux_transaction_staking_incoming_entries[] = {
+    // not shown for signaling transactions
+    { "Amount", UX_TRANSACTION_ENTRY_AMOUNT, TX_DISPLAY_AMOUNT },
+    {
+        // for amount in signaling data
+        "Amount",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT,
+        TX_DISPLAY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT,
+    },
+    {
+        "Staker",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_STAKER_ADDRESS,
+        TX_DISPLAY_STAKING_INCOMING_STAKER_ADDRESS,
+    },
+    {
+        "Delegation",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION,
+        TX_DISPLAY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION,
+    },
+    {
+        "Reactivate all Stake",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE,
+        TX_DISPLAY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE,
+    },
+    {
+        "Validator",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_VALIDATOR_ADDRESS,
+        TX_DISPLAY_STAKING_INCOMING_VALIDATOR_ADDRESS,
+    },
+    {
+        "Signing Key",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY,
+        TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY,
+    },
+    {
+        "Voting Key Hash",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT,
+        TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT,
+    },
+    {
+        "Reward Address",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS,
+        TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS,
+    },
+    {
+        "Signal Data",
+        UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA,
+        TX_DISPLAY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA,
+    },
+    { "Fee", UX_TRANSACTION_ENTRY_FEE, TX_DISPLAY_FEE },
+    { "Network", UX_TRANSACTION_ENTRY_NETWORK, 0 },
+};
 
-bool ux_transaction_staking_incoming_has_create_staker_or_update_staker_delegation_entry() {
-    // Show if it's a data type that potentially specifies a delegation address, and it is set.
-    return (PARSED_TX_STAKING_INCOMING.type == CREATE_STAKER || PARSED_TX_STAKING_INCOMING.type == UPDATE_STAKER)
-        && strlen(PARSED_TX_STAKING_INCOMING.create_staker_or_update_staker.delegation);
+const ux_transaction_entry_row_t *ux_transaction_get_entry_rows(uint8_t *out_row_count) {
+    switch (PARSED_TX.transaction_type) {
+        case TRANSACTION_TYPE_NORMAL:
+        case TRANSACTION_TYPE_STAKING_OUTGOING:
+            *out_row_count = ARRAY_LENGTH(ux_transaction_normal_or_staking_outgoing_entries);
+            return ux_transaction_normal_or_staking_outgoing_entries;
+        case TRANSACTION_TYPE_VESTING_CREATION:
+            *out_row_count = ARRAY_LENGTH(ux_transaction_vesting_creation_entries);
+            return ux_transaction_vesting_creation_entries;
+        case TRANSACTION_TYPE_HTLC_CREATION:
+            *out_row_count = ARRAY_LENGTH(ux_transaction_htlc_creation_entries);
+            return ux_transaction_htlc_creation_entries;
+        case TRANSACTION_TYPE_STAKING_INCOMING:
+            *out_row_count = ARRAY_LENGTH(ux_transaction_staking_incoming_entries);
+            return ux_transaction_staking_incoming_entries;
+        default:
+            // This should not happen, as the transaction parser should have set a valid transaction type.
+            LEDGER_ASSERT(
+                false,
+                "Invalid transaction type"
+            );
+            return NULL;
+    }
 }
 
-bool ux_transaction_staking_incoming_has_update_staker_reactivate_all_stake_entry() {
-    // Show reactivate_all_stake for data type UPDATE_STAKER.
-    return PARSED_TX_STAKING_INCOMING.type == UPDATE_STAKER;
+bool ux_transaction_is_entry_row_displayed(const ux_transaction_entry_row_t *row) {
+    return !row->display_flag || (PARSED_TX.display_plan & row->display_flag);
 }
@@ -19,29 +19,76 @@
 #define _NIMIQ_UX_UTILS_TRANSACTION_SIGNING_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
-bool ux_transaction_generic_has_amount_entry();
-bool ux_transaction_generic_has_fee_entry();
-
-bool ux_transaction_normal_or_staking_outgoing_has_data_entry();
-
-bool ux_transaction_htlc_creation_has_refund_address_entry();
-bool ux_transaction_htlc_creation_has_hash_algorithm_entry();
-bool ux_transaction_htlc_creation_has_hash_count_entry();
-bool ux_transaction_htlc_creation_has_timeout_entry();
-
-bool ux_transaction_vesting_creation_has_owner_address_entry();
-bool ux_transaction_vesting_creation_has_single_vesting_block_entry();
-bool ux_transaction_vesting_creation_has_start_and_period_and_step_count_and_step_duration_entries();
-bool ux_transaction_vesting_creation_has_first_step_duration_entry();
-bool ux_transaction_vesting_creation_has_step_amount_entry();
-bool ux_transaction_vesting_creation_has_first_step_amount_entry();
-bool ux_transaction_vesting_creation_has_last_step_amount_entry();
-bool ux_transaction_vesting_creation_has_pre_vested_amount_entry();
-
-bool ux_transaction_staking_incoming_has_set_active_stake_or_retire_stake_amount_entry();
-bool ux_transaction_staking_incoming_has_staker_address_entry();
-bool ux_transaction_staking_incoming_has_create_staker_or_update_staker_delegation_entry();
-bool ux_transaction_staking_incoming_has_update_staker_reactivate_all_stake_entry();
+// Transaction values that can be printed for display via ux_transaction_print_entry.
+typedef enum {
+    UX_TRANSACTION_ENTRY_AMOUNT,
+    UX_TRANSACTION_ENTRY_FEE,
+    UX_TRANSACTION_ENTRY_NETWORK,
+
+    UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_RECIPIENT,
+    UX_TRANSACTION_ENTRY_NORMAL_OR_STAKING_OUTGOING_DATA, // printed as ascii or hex, see is_extra_data_hex
+
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_REDEEM_ADDRESS,
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_REFUND_ADDRESS,
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ROOT,
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_ALGORITHM,
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_HASH_COUNT,
+    UX_TRANSACTION_ENTRY_HTLC_CREATION_TIMEOUT,
+
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_OWNER_ADDRESS,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_SINGLE_VESTING_BLOCK,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_START_BLOCK,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_PERIOD,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_COUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_BLOCK_COUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_BLOCK_COUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_STEP_AMOUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_FIRST_STEP_AMOUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_LAST_STEP_AMOUNT,
+    UX_TRANSACTION_ENTRY_VESTING_CREATION_PRE_VESTED_AMOUNT,
+
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_SET_ACTIVE_STAKE_OR_RETIRE_STAKE_AMOUNT,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_STAKER_ADDRESS,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_STAKER_OR_UPDATE_STAKER_DELEGATION,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_UPDATE_STAKER_REACTIVATE_ALL_STAKE,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_VALIDATOR_ADDRESS,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNING_KEY,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_VOTING_KEY_FINGERPRINT,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_REWARD_ADDRESS,
+    UX_TRANSACTION_ENTRY_STAKING_INCOMING_CREATE_VALIDATOR_OR_UPDATE_VALIDATOR_SIGNAL_DATA, // printed as hex or "None"
+} ux_transaction_entry_t;
+
+/**
+ * Print a value of the parsed transaction for display. out must be large enough for the printed entry, see the
+ * TX_ARENA_* entry sizes in globals.h. Returns out for convenience.
+ */
+char *ux_transaction_print_entry(ux_transaction_entry_t entry, char *out, uint16_t out_length);
+
+/**
+ * Print a value of the parsed transaction into the request arena, allocating exactly the printed length.
+ */
+char *ux_transaction_print_entry_to_arena(ux_transaction_entry_t entry);
+
+/**
+ * A displayed value of a transaction review. Instead of describing the displayed values separately in the BAGL and NBGL
+ * UIs, the values of each transaction type are described by a table of rows in flash, from which both UIs render their
+ * reviews. Adding a new transaction type or value thus only costs a table row.
+ */
+typedef struct {
+    const char *label;
+    ux_transaction_entry_t value;
+    // Displayed only if this tx_display_flag_t is set in the display plan of the parsed transaction, or always if 0.
+    uint32_t display_flag;
+} ux_transaction_entry_row_t;
+
+/**
+ * Get the entry rows of the parsed transaction's type, in display order, including those which are not displayed for
+ * the parsed transaction, see ux_transaction_is_entry_row_displayed.
+ */
+const ux_transaction_entry_row_t *ux_transaction_get_entry_rows(uint8_t *out_row_count);
+
+bool ux_transaction_is_entry_row_displayed(const ux_transaction_entry_row_t *row);
 
 #endif // _NIMIQ_UX_UTILS_TRANSACTION_SIGNING_H_
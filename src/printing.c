@@ -0,0 +1,201 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "printing.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_PRINTING
+
+// Number of decimal digits of the largest uint64 18446744073709551615.
+#define MAX_DECIMAL_DIGITS_UINT64 20
+
+#define TEN_POW_9 1000000000
+#define LUNA_PER_NIM 100000
+#define LUNA_DECIMALS 5
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The word-wise hex printing assumes little endian byte order"
+#endif
+
+#define WORD_ALIGNMENT_OFFSET(pointer) (((uintptr_t) (pointer)) % sizeof(uint32_t))
+
+#define IS_PRINTABLE_ASCII_CHAR(byte) ((byte) >= /* space */ 32 && (byte) <= /* tilde */ 126)
+
+// Lookup table of the two uppercase hex chars of each byte value, in memory order for little endian.
+#define HEX_CHAR(nibble) ((nibble) < 10 ? '0' + (nibble) : 'A' - 10 + (nibble))
+#define HEX_PAIR(byte) ((uint16_t) (HEX_CHAR((byte) >> 4) | (HEX_CHAR((byte) & 0x0f) << 8)))
+#define HEX_PAIRS_4(byte) HEX_PAIR(byte), HEX_PAIR(byte + 1), HEX_PAIR(byte + 2), HEX_PAIR(byte + 3)
+#define HEX_PAIRS_16(byte) HEX_PAIRS_4(byte), HEX_PAIRS_4(byte + 4), HEX_PAIRS_4(byte + 8), HEX_PAIRS_4(byte + 12)
+#define HEX_PAIRS_64(byte) HEX_PAIRS_16(byte), HEX_PAIRS_16(byte + 16), HEX_PAIRS_16(byte + 32), HEX_PAIRS_16(byte + 48)
+static const uint16_t HEX_PAIRS[256] = {
+    HEX_PAIRS_64(0), HEX_PAIRS_64(64), HEX_PAIRS_64(128), HEX_PAIRS_64(192),
+};
+
+// Write the decimal digits of value right-aligned, ending before end, with at least min_digits digits, padded with
+// leading zeros. Returns the number of written digits. Only 32 bit divisions by constants are used, which compilers
+// implement as multiplications.
+static uint8_t write_u32_digits(uint32_t value, uint8_t min_digits, char *end) {
+    uint8_t digit_count = 0;
+    do {
+        *--end = '0' + value % 10;
+        value /= 10;
+        digit_count++;
+    } while (value || digit_count < min_digits);
+    return digit_count;
+}
+
+// Write the decimal digits of value right-aligned, ending before end. end must be preceded by at least
+// MAX_DECIMAL_DIGITS_UINT64 chars. Returns the number of written digits.
+static uint8_t write_u64_digits(uint64_t value, char *end) {
+    uint8_t digit_count = 0;
+    while (value > UINT32_MAX) {
+        digit_count += write_u32_digits(value % TEN_POW_9, /* min_digits */ 9, end - digit_count);
+        value /= TEN_POW_9;
+    }
+    return digit_count + write_u32_digits(value, /* min_digits */ 0, end - digit_count);
+}
+
+// Copy a string of given length and append the string terminator.
+WARN_UNUSED_RESULT
+static error_t print_chars(const char *chars, uint16_t length, char *out, uint16_t out_length) {
+    RETURN_ON_ERROR(
+        length >= out_length,
+        ERROR_INVALID_LENGTH,
+        "Out buffer too small\n"
+    );
+    memmove(out, chars, length);
+    out[length] = '\0';
+    return ERROR_NONE;
+}
+
+WARN_UNUSED_RESULT
+error_t print_u32(uint32_t value, char *out, uint16_t out_length) {
+    char digits[STRING_LENGTH_UINT32 - /* string terminator */ 1];
+    uint8_t digit_count = write_u32_digits(value, /* min_digits */ 0, digits + sizeof(digits));
+    return print_chars(digits + sizeof(digits) - digit_count, digit_count, out, out_length);
+}
+
+WARN_UNUSED_RESULT
+error_t print_u64(uint64_t value, char *out, uint16_t out_length) {
+    char digits[MAX_DECIMAL_DIGITS_UINT64];
+    uint8_t digit_count = write_u64_digits(value, digits + sizeof(digits));
+    return print_chars(digits + sizeof(digits) - digit_count, digit_count, out, out_length);
+}
+
+WARN_UNUSED_RESULT
+error_t print_amount(uint64_t amount, const char *ticker, char *out, uint16_t out_length) {
+    // Integer part, decimal separator and decimals. The amount is split into NIM and luna by a single 64 bit division.
+    char printed[MAX_DECIMAL_DIGITS_UINT64 + /* decimal separator */ 1 + LUNA_DECIMALS];
+    char *end = printed + sizeof(printed);
+    uint32_t luna = amount % LUNA_PER_NIM;
+    uint8_t length = 0;
+    if (luna) {
+        length = write_u32_digits(luna, /* min_digits */ LUNA_DECIMALS, end);
+        // Strip trailing zeros.
+        for (; end[-1] == '0'; end--, length--);
+        printed[sizeof(printed) - 1 - LUNA_DECIMALS] = '.';
+        length += /* decimal separator */ 1 + write_u64_digits(amount / LUNA_PER_NIM,
+            printed + sizeof(printed) - 1 - LUNA_DECIMALS);
+    } else {
+        length = write_u64_digits(amount / LUNA_PER_NIM, end);
+    }
+    char *start = end - length;
+    if (!ticker) {
+        return print_chars(start, length, out, out_length);
+    }
+    uint16_t ticker_length = strlen(ticker);
+    RETURN_ON_ERROR(
+        length + /* space */ 1 + ticker_length >= out_length,
+        ERROR_INVALID_LENGTH,
+        "Out buffer too small for amount\n"
+    );
+    memmove(out, start, length);
+    out[length] = ' ';
+    memcpy(out + length + 1, ticker, ticker_length);
+    out[length + 1 + ticker_length] = '\0';
+    return ERROR_NONE;
+}
+
+WARN_UNUSED_RESULT
+error_t print_block_count(uint32_t block_count, char *out, uint16_t out_length) {
+    char printed[STRING_LENGTH_WITH_SUFFIX(STRING_LENGTH_UINT32, " blocks")];
+    char *end = printed + sizeof(printed) - sizeof(" blocks");
+    uint8_t digit_count = write_u32_digits(block_count, /* min_digits */ 0, end);
+    memcpy(end, " blocks", sizeof(" blocks"));
+    // Singular "block" for a single block, by omitting the "s" and its string terminator.
+    uint16_t suffix_length = block_count != 1 ? sizeof(" blocks") - 1 : sizeof(" block") - 1;
+    return print_chars(end - digit_count, digit_count + suffix_length, out, out_length);
+}
+
+WARN_UNUSED_RESULT
+error_t print_hex(const uint8_t *data, uint16_t data_length, char *out, uint16_t out_length) {
+    RETURN_ON_ERROR(
+        // Check that it fits 2 hex chars per byte + string terminator.
+        out_length < data_length * 2 + 1,
+        ERROR_INVALID_LENGTH,
+        "Out buffer too small to fit hex\n"
+    );
+    // not using Ledger's proprietary %.*H snprintf format, as it's non-standard
+    // (see https://github.com/LedgerHQ/app-bitcoin/pull/200/files)
+    uint16_t i = 0;
+    // Word writes are only possible, if out can become aligned by writing 2 chars per byte, i.e. if it's 16 bit aligned.
+    if (!((uintptr_t) out % sizeof(uint16_t))) {
+        // Prologue: print single bytes until out is aligned.
+        for (; i < data_length && WORD_ALIGNMENT_OFFSET(out + i * 2); i++) {
+            memcpy(out + i * 2, &HEX_PAIRS[data[i]], sizeof(HEX_PAIRS[0]));
+        }
+        // Print two bytes as a single aligned word.
+        for (; i + 2 <= data_length; i += 2) {
+            uint32_t word = HEX_PAIRS[data[i]] | ((uint32_t) HEX_PAIRS[data[i + 1]] << 16);
+            memcpy(__builtin_assume_aligned(out + i * 2, sizeof(uint32_t)), &word, sizeof(word));
+        }
+    }
+    // Epilogue: print the remaining bytes, or all bytes, if out is not 16 bit aligned.
+    for (; i < data_length; i++) {
+        memcpy(out + i * 2, &HEX_PAIRS[data[i]], sizeof(HEX_PAIRS[0]));
+    }
+    out[data_length * 2] = '\0';
+    return ERROR_NONE;
+}
+
+bool is_printable_ascii(const uint8_t *data, uint16_t data_length) {
+    uint16_t i = 0;
+    // Prologue: check single bytes until data is aligned.
+    for (; i < data_length && WORD_ALIGNMENT_OFFSET(data + i); i++) {
+        if (!IS_PRINTABLE_ASCII_CHAR(data[i])) return false;
+    }
+    // Check four bytes at a time. The high bit of each byte of the masked word is cleared, such that the additions can
+    // not carry over into the neighboring byte. A byte is not printable, if its high bit is set, or it's below space,
+    // i.e. adding 0x80 - 0x20 does not set the high bit, or it's 0x7f, i.e. adding 0x01 sets the high bit.
+    for (; i + sizeof(uint32_t) <= data_length; i += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, __builtin_assume_aligned(data + i, sizeof(uint32_t)), sizeof(word));
+        uint32_t low_bits = word & 0x7f7f7f7f;
+        if ((word | ~(low_bits + 0x60606060) | (low_bits + 0x01010101)) & 0x80808080) return false;
+    }
+    // Epilogue: check the remaining bytes.
+    for (; i < data_length; i++) {
+        if (!IS_PRINTABLE_ASCII_CHAR(data[i])) return false;
+    }
+    return true;
+}
+
+WARN_UNUSED_RESULT
+error_t print_string(const char *string, char *out, uint16_t out_length) {
+    return print_chars(string, strlen(string), out, out_length);
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_PRINTING_H_
+#define _NIMIQ_PRINTING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "constants.h"
+#include "error_macros.h"
+
+// Printing of numbers, amounts, hex and strings for display, as a lightweight replacement of snprintf. All functions
+// write a \0 terminated string to out, and fail with ERROR_INVALID_LENGTH without writing a partial result, if the
+// string including its terminator does not fit out_length.
+
+WARN_UNUSED_RESULT
+error_t print_u32(uint32_t value, char *out, uint16_t out_length);
+
+/**
+ * Print a uint64 as decimal. The value is split into parts of 9 decimal digits, such that at most two 64 bit divisions
+ * are needed, which are implemented in software on Ledger devices, and the digits are calculated with 32 bit
+ * arithmetic.
+ */
+WARN_UNUSED_RESULT
+error_t print_u64(uint64_t value, char *out, uint16_t out_length);
+
+/**
+ * Print an amount of luna as NIM, where 1 NIM = 100 000 luna, with up to 5 decimals without trailing zeros, followed by
+ * a space and the ticker, if it is not NULL.
+ */
+WARN_UNUSED_RESULT
+error_t print_amount(uint64_t amount, const char *ticker, char *out, uint16_t out_length);
+
+/**
+ * Print a number of blocks as "1 block" or "<block_count> blocks".
+ */
+WARN_UNUSED_RESULT
+error_t print_block_count(uint32_t block_count, char *out, uint16_t out_length);
+
+/**
+ * Print data as uppercase hex with 2 chars per byte. Once out is 32 bit aligned, two bytes are expanded at a time via a
+ * lookup table of hex char pairs, and written as a single word.
+ */
+WARN_UNUSED_RESULT
+error_t print_hex(const uint8_t *data, uint16_t data_length, char *out, uint16_t out_length);
+
+WARN_UNUSED_RESULT
+error_t print_string(const char *string, char *out, uint16_t out_length);
+
+/**
+ * Check whether data consists only of printable ascii chars, from space to tilde. Once data is 32 bit aligned, the check
+ * is performed for four bytes at a time.
+ */
+bool is_printable_ascii(const uint8_t *data, uint16_t data_length);
+
+#endif // _NIMIQ_PRINTING_H_
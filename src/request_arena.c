@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "request_arena.h"
+#include "globals.h"
+
+// Check at compile time that the worst case memory usage of each request type fits the memory behind its context.
+#define REQUEST_ARENA_SIZE(context_type) (sizeof(ctx.req) - REQUEST_ARENA_ALIGN(sizeof(context_type)))
+_Static_assert(REQUEST_ARENA_ALIGN(sizeof(ctx.req)) == sizeof(ctx.req), "Request memory is not aligned\n");
+_Static_assert(sizeof(ctx.req) <= UINT16_MAX, "Request memory exceeds arena offsets\n");
+_Static_assert(
+    TX_ARENA_BUDGET_NORMAL_OR_STAKING_OUTGOING <= REQUEST_ARENA_SIZE(transactionContext_t)
+        && TX_ARENA_BUDGET_STAKING_INCOMING <= REQUEST_ARENA_SIZE(transactionContext_t)
+        && TX_ARENA_BUDGET_HTLC_CREATION <= REQUEST_ARENA_SIZE(transactionContext_t)
+        && TX_ARENA_BUDGET_VESTING_CREATION <= REQUEST_ARENA_SIZE(transactionContext_t),
+    "Request arena too small for printed transaction values\n"
+);
+_Static_assert(
+    TX_ARENA_BUDGET_STREAMED_SIGNING <= REQUEST_ARENA_SIZE(transactionContext_t),
+    "Request arena too small for streamed signing hash contexts\n"
+);
+_Static_assert(
+    MESSAGE_ARENA_BUDGET <= REQUEST_ARENA_SIZE(messageSigningContext_t),
+    "Request arena too small for message hash contexts or printed message\n"
+);
+#undef REQUEST_ARENA_SIZE
+
+void request_arena_reset(uint8_t request_type, uint16_t request_context_size) {
+    LEDGER_ASSERT(
+        (uint32_t) REQUEST_ARENA_ALIGN(request_context_size) <= sizeof(ctx.req),
+        "Request context exceeds request memory"
+    );
+    ctx.arena.start = REQUEST_ARENA_ALIGN(request_context_size);
+    ctx.arena.end = ctx.arena.start;
+    ctx.arena.request_type = request_type;
+}
+
+bool request_arena_belongs_to(uint8_t request_type) {
+    // A zeroed arena has an empty start offset, and belongs to no request.
+    return ctx.arena.start != 0 && ctx.arena.request_type == request_type;
+}
+
+static void *request_arena_alloc_at(uint16_t offset, uint16_t size) {
+    LEDGER_ASSERT(
+        ctx.arena.start != 0 && offset >= ctx.arena.end && (uint32_t) offset + size <= sizeof(ctx.req),
+        "Request arena exhausted"
+    );
+    ctx.arena.end = offset + size;
+    return ctx.req.memory + offset;
+}
+
+void *request_arena_alloc(uint16_t size) {
+    return request_arena_alloc_at(REQUEST_ARENA_ALIGN(ctx.arena.end), size);
+}
+
+void request_arena_free_all() {
+    ctx.arena.end = ctx.arena.start;
+}
+
+char *request_arena_print_begin(uint16_t *out_available_length) {
+    LEDGER_ASSERT(
+        ctx.arena.start != 0 && ctx.arena.end < sizeof(ctx.req),
+        "Request arena exhausted"
+    );
+    *out_available_length = sizeof(ctx.req) - ctx.arena.end;
+    // Make sure that the memory is always a valid string, even if nothing gets printed.
+    ctx.req.memory[ctx.arena.end] = '\0';
+    return (char *) ctx.req.memory + ctx.arena.end;
+}
+
+char *request_arena_print_end() {
+    // Strings do not need to be aligned, and are therefore allocated without padding.
+    char *string = (char *) ctx.req.memory + ctx.arena.end;
+    return request_arena_alloc_at(
+        ctx.arena.end,
+        strnlen(string, sizeof(ctx.req) - ctx.arena.end - 1) + /* string terminator */ 1
+    );
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_REQUEST_ARENA_H_
+#define _NIMIQ_REQUEST_ARENA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Allocations are aligned to 4 bytes, such that the arena can also hold structs like hash contexts. Printed strings are
+// not aligned, see request_arena_print_begin.
+#define REQUEST_ARENA_ALIGNMENT 4
+#define REQUEST_ARENA_ALIGN(size) (((size) + REQUEST_ARENA_ALIGNMENT - 1) & ~(REQUEST_ARENA_ALIGNMENT - 1))
+
+/**
+ * Bump allocator over the memory of the request context union in globals.h which is not used by the context of the
+ * current request. Instead of reserving worst case sized buffers for data like printed strings in each request context,
+ * the data is allocated with its exact size when it's needed. Memory is not freed individually, but all at once, for
+ * example when the next value to display is printed. The arena is reset at the start of each request, which also
+ * records which request it belongs to, such that follow-up chunks of a request can detect if the request context has
+ * been overwritten or wiped in the meantime. Note that a zeroed arena, e.g. after the wipe of ctx on errors, has no
+ * memory, and belongs to no request.
+ */
+typedef struct {
+    uint16_t start; // offset in the request context union at which the arena starts
+    uint16_t end; // offset of the first unallocated byte
+    uint8_t request_type; // instruction code of the request the arena belongs to
+} request_arena_t;
+
+/**
+ * Reset the arena at the start of a request, with the arena starting after the request's context.
+ */
+void request_arena_reset(uint8_t request_type, uint16_t request_context_size);
+
+bool request_arena_belongs_to(uint8_t request_type);
+
+/**
+ * Allocate memory from the arena. Running out of memory is a programming error, as the arena is dimensioned for the
+ * worst case usage of each request type, and is therefore asserted.
+ */
+void *request_arena_alloc(uint16_t size);
+
+/**
+ * Free all memory allocated in the arena since its reset.
+ */
+void request_arena_free_all();
+
+/**
+ * Printing of a string of a priori unknown length into the arena. The string can be printed into the returned memory,
+ * which spans the entire remaining arena, and is then allocated with its exact length by request_arena_print_end. As
+ * strings do not require any alignment, they are packed without padding.
+ */
+char *request_arena_print_begin(uint16_t *out_available_length);
+char *request_arena_print_end();
+
+#endif // _NIMIQ_REQUEST_ARENA_H_
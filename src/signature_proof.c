@@ -15,34 +15,63 @@
  *  limitations under the License.
  ********************************************************************************/
 
+#include <string.h>
+
 #include "signature_proof.h"
 #include "nimiq_utils.h"
 
+#define ERROR_SITE_FILE ERROR_SITE_FILE_SIGNATURE_PROOF
+
 /**
  * Read a signature proof from a buffer. Note that all pointers in the returned signature proof are to the original
  * buffer. No copy of the data is created.
  */
 WARN_UNUSED_RESULT
-bool read_signature_proof(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length,
-    signature_proof_t *out_signature_proof) {
+bool read_signature_proof(buffer_reader_t *reader, signature_proof_t *out_signature_proof) {
     // See Serde::Serialize for SignatureProof in primitives/transaction/src/signature_proof.rs in core-rs-albatross.
+    out_signature_proof->type_and_flags = reader_read_u8(reader);
+    out_signature_proof->public_key_length = ED25519_PUBLIC_KEY_LENGTH;
+    // Plain ed25519 signature proofs without flags are the common case, for which the type field is 0, such that the
+    // decoding of the algorithm and flags is skipped.
+    if (out_signature_proof->type_and_flags != 0) {
+        uint8_t algorithm = out_signature_proof->type_and_flags & 0x0f;
+        RETURN_ON_ERROR(
+            (algorithm != SIGNATURE_PROOF_ALGORITHM_ED25519 && algorithm != SIGNATURE_PROOF_ALGORITHM_ES256)
+                || (out_signature_proof->type_and_flags & 0xf0 & ~SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS),
+            false,
+            "Unsupported signature proof algorithm or flags\n"
+        );
+        if (algorithm == SIGNATURE_PROOF_ALGORITHM_ES256) {
+            out_signature_proof->public_key_length = ES256_PUBLIC_KEY_LENGTH;
+        }
+    }
+    out_signature_proof->public_key = reader_read_sub_buffer(reader, out_signature_proof->public_key_length);
+    // The merkle path consists of the u8 number of nodes, the bits specifying for each node whether it's the left node,
+    // compressed into bytes, and the node hashes, see Serialize for MerklePath in utils/src/merkle/mod.rs.
+    out_signature_proof->merkle_path_length = reader_read_u8(reader);
+    out_signature_proof->merkle_path_left_bits =
+        reader_read_sub_buffer(reader, (out_signature_proof->merkle_path_length + 7) / 8);
+    out_signature_proof->merkle_path_node_hashes =
+        reader_read_sub_buffer(reader, out_signature_proof->merkle_path_length * 32);
+    // Ed25519 and ES256 signatures are both 64 bytes long.
+    out_signature_proof->signature = reader_read_sub_buffer(reader, 64);
+    if (out_signature_proof->type_and_flags & SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS) {
+        // See WebauthnExtraFields in primitives/transaction/src/signature_proof.rs. Strings are serialized like a
+        // Vec<u8> of their utf-8 bytes.
+        webauthn_extra_fields_t *webauthn_fields = &out_signature_proof->webauthn_fields;
+        webauthn_fields->origin_json = reader_read_serde_vec_u8(reader, &webauthn_fields->origin_json_length);
+        webauthn_fields->has_cross_origin_field = reader_read_bool(reader);
+        webauthn_fields->client_data_extra_json =
+            reader_read_serde_vec_u8(reader, &webauthn_fields->client_data_extra_json_length);
+        webauthn_fields->authenticator_data_suffix =
+            reader_read_serde_vec_u8(reader, &webauthn_fields->authenticator_data_suffix_length);
+    } else {
+        memset(&out_signature_proof->webauthn_fields, 0, sizeof(out_signature_proof->webauthn_fields));
+    }
     RETURN_ON_ERROR(
-        !read_u8(in_out_buffer, in_out_buffer_length, &out_signature_proof->type_and_flags)
-        || !read_sub_buffer(32, in_out_buffer, in_out_buffer_length, &out_signature_proof->public_key)
-        || !read_u8(in_out_buffer, in_out_buffer_length, &out_signature_proof->merkle_path_length)
-        || !read_sub_buffer(64, in_out_buffer, in_out_buffer_length, &out_signature_proof->signature),
+        reader->has_error,
         false
     );
-    RETURN_ON_ERROR(
-        out_signature_proof->type_and_flags != 0,
-        false,
-        "Only ed25519 signature proofs without flags supported\n"
-    );
-    RETURN_ON_ERROR(
-        out_signature_proof->merkle_path_length != 0,
-        false,
-        "Only signature proofs with empty merkle path supported\n"
-    );
     return true;
 }
 
@@ -65,3 +94,25 @@ bool is_empty_default_signature_proof(signature_proof_t signature_proof) {
     }
     return true;
 }
+
+WARN_UNUSED_RESULT
+error_t compute_signature_proof_signer(const signature_proof_t *signature_proof, uint8_t out_address[static 20]) {
+    // The leaf is the hash of the public key. Going up the path, each node hash is combined with the hash so far, on
+    // its left or right side, to the next hash. See compute_root for MerklePath in utils/src/merkle/mod.rs and
+    // compute_signer for SignatureProof in primitives/transaction/src/signature_proof.rs in core-rs-albatross.
+    uint8_t hash[32];
+    uint8_t node_pair[64];
+    RETURN_ON_ERROR(
+        blake2b_256(signature_proof->public_key, signature_proof->public_key_length, hash)
+    );
+    for (uint8_t i = 0; i < signature_proof->merkle_path_length; i++) {
+        bool is_left_node = signature_proof->merkle_path_left_bits[i / 8] & (0x80 >> (i % 8));
+        memcpy(node_pair + (is_left_node ? 32 : 0), hash, 32);
+        memcpy(node_pair + (is_left_node ? 0 : 32), signature_proof->merkle_path_node_hashes + i * 32, 32);
+        RETURN_ON_ERROR(
+            blake2b_256(node_pair, sizeof(node_pair), hash)
+        );
+    }
+    memcpy(out_address, hash, 20); // the first 20 bytes of the root hash are the address
+    return ERROR_NONE;
+}
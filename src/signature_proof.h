@@ -22,24 +22,54 @@
 #include <stdbool.h>
 
 #include "error_macros.h"
+#include "buffer_reader.h"
+
+// The type field of a signature proof holds the algorithm in the lower and flags in the upper 4 bits, see
+// make_type_field for SignatureProof in primitives/transaction/src/signature_proof.rs in core-rs-albatross.
+#define SIGNATURE_PROOF_ALGORITHM_ED25519 0
+#define SIGNATURE_PROOF_ALGORITHM_ES256 1
+#define SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS (0x1 << 4)
+
+#define ED25519_PUBLIC_KEY_LENGTH 32
+#define ES256_PUBLIC_KEY_LENGTH 33 // compressed P-256 public key
+
+typedef struct {
+    // Only set if the SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS flag is set. The strings are not \0 terminated. All pointers
+    // are NULL for empty fields.
+    uint8_t *origin_json; // the JSON encoded origin string
+    uint8_t *client_data_extra_json; // additional JSON fields of the client data
+    uint8_t *authenticator_data_suffix; // authenticator data after the relying party id hash
+    uint16_t origin_json_length;
+    uint16_t client_data_extra_json_length;
+    uint16_t authenticator_data_suffix_length;
+    bool has_cross_origin_field;
+} webauthn_extra_fields_t;
 
 typedef struct {
-    // Currently only ed25519 without flags and only empty merkle paths are supported, therefore:
-    // - the public key is an ed25519 public key and the signature an ed25519 signature
-    // - no WebauthnExtraFields are present
-    // - no merkle path compressed vector or node hashes are present.
-    uint8_t *public_key; // pointer to a 32 byte ed25519 public key
-    // uint8_t *merkle_path_compressed; // NULL or a pointer to a VecU8
-    // uint8_t *merkle_path_node_hashes; // NULL or a pointer to a VecU8
-    uint8_t *signature; // pointer to a 64 byte ed25519 signature
+    // All pointers point into the original buffer.
+    uint8_t *public_key; // pointer to a 32 byte ed25519 or 33 byte compressed ES256 public key, see public_key_length
+    // The merkle path is non-empty for signature proofs of multisig addresses, see compute_signature_proof_signer.
+    uint8_t *merkle_path_left_bits; // NULL or a pointer to the (merkle_path_length + 7) / 8 bytes of compressed flags
+    uint8_t *merkle_path_node_hashes; // NULL or a pointer to merkle_path_length 32 byte Blake2b hashes
+    uint8_t *signature; // pointer to a 64 byte ed25519 or ES256 signature
+    webauthn_extra_fields_t webauthn_fields; // only used if SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS is set
     uint8_t type_and_flags;
+    uint8_t public_key_length;
     uint8_t merkle_path_length;
 } signature_proof_t;
 
 WARN_UNUSED_RESULT
-bool read_signature_proof(uint8_t **in_out_buffer, uint16_t *in_out_buffer_length,
-    signature_proof_t *out_signature_proof);
+bool read_signature_proof(buffer_reader_t *reader, signature_proof_t *out_signature_proof);
 
 bool is_empty_default_signature_proof(signature_proof_t signature_proof);
 
+/**
+ * Compute the address of the signer of a signature proof, which is the root of its merkle path, computed over the
+ * public key as leaf. For an empty merkle path, this is the address of the public key. For a multisig address, the
+ * public key is the aggregated public key of the signers, and the merkle path leads to the root over all possible
+ * signer combinations.
+ */
+WARN_UNUSED_RESULT
+error_t compute_signature_proof_signer(const signature_proof_t *signature_proof, uint8_t out_address[static 20]);
+
 #endif // _NIMIQ_SIGNATURE_PROOF_H_
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "stack_usage.h"
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+
+#include <stdint.h>
+
+#include "utility_macros.h"
+
+// Bounds of the stack, from the SDK's linker scripts. The stack grows downwards from _estack, towards the stack canary,
+// which is the lowest word of the stack and is not painted.
+extern uint32_t app_stack_canary;
+extern uint32_t _estack;
+#define STACK_BOTTOM (&app_stack_canary + 1)
+#define STACK_TOP (&_estack)
+
+#define STACK_USAGE_PATTERN 0xa5a5a5a5
+// Bytes directly below the frame of stack_usage_paint, which are not painted, as they might be used by the function's
+// own spilled registers.
+#define STACK_USAGE_PAINT_MARGIN 64
+// Maximum nesting of measured sections. Deeper sections are not measured separately, but accounted to their parents.
+#define STACK_USAGE_MAX_NESTING 4
+
+static uint16_t peaks[STACK_USAGE_SLOT_COUNT];
+static stack_usage_slot_t active_slots[STACK_USAGE_MAX_NESTING];
+static uint8_t active_count;
+
+static const uint32_t *find_deepest_used_word() {
+    const uint32_t *word = STACK_BOTTOM;
+    while (word < STACK_TOP && *word == STACK_USAGE_PATTERN) {
+        word++;
+    }
+    return word;
+}
+
+/**
+ * Paint the stack from the given word up to below the frame of this function. Not inlined, such that its frame is
+ * located below the caller's frame, which is therefore not painted.
+ */
+__attribute__((noinline))
+static void stack_usage_paint(uint32_t *from) {
+    uint32_t *to = (uint32_t *) (((uintptr_t) __builtin_frame_address(0) - STACK_USAGE_PAINT_MARGIN) & ~0x3);
+    for (uint32_t *word = from; word < to; word++) {
+        *word = STACK_USAGE_PATTERN;
+    }
+}
+
+static void update_active_peaks() {
+    uint16_t depth = (uint16_t) ((STACK_TOP - find_deepest_used_word()) * sizeof(uint32_t));
+    for (uint8_t i = 0; i < MIN(active_count, STACK_USAGE_MAX_NESTING); i++) {
+        peaks[active_slots[i]] = MAX(peaks[active_slots[i]], depth);
+    }
+}
+
+void stack_usage_init() {
+    active_count = 0;
+    stack_usage_reset_peaks();
+    stack_usage_paint(STACK_BOTTOM);
+}
+
+void stack_usage_begin(stack_usage_slot_t slot) {
+    // The parent sections' usage up to now has to be recorded before the stack is repainted. Only the part of the stack
+    // which is not painted anymore needs to be repainted.
+    update_active_peaks();
+    stack_usage_paint((uint32_t *) find_deepest_used_word());
+    if (active_count < STACK_USAGE_MAX_NESTING) {
+        active_slots[active_count] = slot;
+    }
+    active_count++;
+}
+
+void stack_usage_end() {
+    if (!active_count) return;
+    update_active_peaks();
+    active_count--;
+}
+
+uint16_t stack_usage_get_stack_size() {
+    return (uint16_t) ((STACK_TOP - STACK_BOTTOM) * sizeof(uint32_t));
+}
+
+uint16_t stack_usage_get_peak(stack_usage_slot_t slot) {
+    return slot < STACK_USAGE_SLOT_COUNT ? peaks[slot] : 0;
+}
+
+void stack_usage_reset_peaks() {
+    for (uint8_t i = 0; i < STACK_USAGE_SLOT_COUNT; i++) {
+        peaks[i] = 0;
+    }
+}
+
+#endif // NIMIQ_DEBUG
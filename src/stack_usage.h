@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_STACK_USAGE_H_
+#define _NIMIQ_STACK_USAGE_H_
+
+#include <stdint.h>
+
+/**
+ * Stack high-water marks for debug builds. The free stack is painted with a known pattern, and the peak stack depth
+ * reached during a measured section of code is then determined as the deepest word, which does not hold the pattern
+ * anymore. Peaks are recorded per slot, i.e. per APDU handler and per UX callback, and can be queried by the host via
+ * INS_GET_STACK_USAGE, such that the stack budget can be checked for each request type in the ragger tests. The depths
+ * are the total stack depths from the top of the stack, including the frames of the SDK's io and ux code calling into
+ * the measured code, as that's what has to fit into the stack.
+ *
+ * In production builds, all of this compiles to nothing.
+ */
+
+/**
+ * The measured sections. The values define the order of the peaks reported to the host, and new slots are appended.
+ */
+typedef enum {
+    STACK_USAGE_SLOT_GET_PUBLIC_KEY,
+    STACK_USAGE_SLOT_SIGN_TX,
+    STACK_USAGE_SLOT_SIGN_MESSAGE,
+    STACK_USAGE_SLOT_OTHER_INSTRUCTIONS,
+    STACK_USAGE_SLOT_ON_ADDRESS_APPROVED,
+    STACK_USAGE_SLOT_ON_TRANSACTION_APPROVED,
+    STACK_USAGE_SLOT_ON_MESSAGE_APPROVED,
+    STACK_USAGE_SLOT_ON_REJECTED,
+    // All io events, which includes the rendering of the ui, and the UX callbacks above, which are called from within.
+    STACK_USAGE_SLOT_IO_EVENT,
+    STACK_USAGE_SLOT_COUNT,
+} stack_usage_slot_t;
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+
+/**
+ * Paint the entire free stack. Called once at startup.
+ */
+void stack_usage_init();
+
+/**
+ * Start measuring a section of code, by repainting the stack below the caller's frame. Sections can be nested, e.g. a
+ * UX callback within an io event, in which case the inner section's usage is also accounted to the outer sections.
+ */
+void stack_usage_begin(stack_usage_slot_t slot);
+
+/**
+ * Finish measuring the innermost section, and update the peaks of all sections it is part of.
+ */
+void stack_usage_end();
+
+/**
+ * Total size of the stack in bytes, excluding the stack canary.
+ */
+uint16_t stack_usage_get_stack_size();
+
+/**
+ * Peak stack depth in bytes of a slot since startup or the last stack_usage_reset_peaks.
+ */
+uint16_t stack_usage_get_peak(stack_usage_slot_t slot);
+
+void stack_usage_reset_peaks();
+
+#define STACK_USAGE_INIT() stack_usage_init()
+#define STACK_USAGE_BEGIN(slot) stack_usage_begin(slot)
+#define STACK_USAGE_END() stack_usage_end()
+
+#else // NIMIQ_DEBUG
+
+#define STACK_USAGE_INIT() do {} while (0)
+#define STACK_USAGE_BEGIN(slot) do {} while (0)
+#define STACK_USAGE_END() do {} while (0)
+
+#endif // NIMIQ_DEBUG
+
+#endif // _NIMIQ_STACK_USAGE_H_
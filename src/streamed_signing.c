@@ -0,0 +1,346 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <string.h>
+
+// From Ledger SDK
+#include "os.h"
+#include "cx.h"
+
+#include "streamed_signing.h"
+#include "request_arena.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_STREAMED_SIGNING
+
+// Order L of the ed25519 base point, 2^252 + 27742317777372353535851937790883648493, big endian.
+static const uint8_t ED25519_ORDER[32] = {
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x14, 0xde, 0xf9, 0xde, 0xa2, 0xf7, 0x9c, 0xd6, 0x58, 0x12, 0x63, 0x1a, 0x5c, 0xf5, 0xd3, 0xed,
+};
+
+// The ed25519 base point B, uncompressed as 0x04 || x || y with big endian coordinates, as expected by
+// cx_ecfp_scalar_mult_no_throw.
+static const uint8_t ED25519_BASE_POINT[65] = {
+    0x04,
+    0x21, 0x69, 0x36, 0xd3, 0xcd, 0x6e, 0x53, 0xfe, 0xc0, 0xa4, 0xe2, 0x31, 0xfd, 0xd6, 0xdc, 0x5c,
+    0x69, 0x2c, 0xc7, 0x60, 0x95, 0x25, 0xa7, 0xb2, 0xc9, 0x56, 0x2d, 0x60, 0x8f, 0x25, 0xd5, 0x1a,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x58,
+};
+
+/**
+ * Encode an uncompressed point as specified in rfc8032 section 5.1.2, i.e. as little endian y coordinate, with the
+ * least significant bit of the x coordinate as most significant bit.
+ */
+static void encode_point(const uint8_t *point, uint8_t *out) {
+    for (uint8_t i = 0; i < 32; i++) {
+        out[i] = point[64 - i];
+    }
+    if (point[32] & 1) {
+        out[31] |= 0x80;
+    }
+}
+
+/**
+ * Interpret a 64 byte SHA-512 hash as little endian integer, and reduce it modulo the group order into a big endian
+ * scalar. The hash is overwritten in the process.
+ */
+WARN_UNUSED_RESULT
+static error_t reduce_hash(uint8_t *hash, uint8_t *out_scalar) {
+    for (uint8_t i = 0; i < 32; i++) {
+        uint8_t byte = hash[i];
+        hash[i] = hash[63 - i];
+        hash[63 - i] = byte;
+    }
+    RETURN_ON_ERROR(
+        cx_math_modm_no_throw(hash, 64, ED25519_ORDER, sizeof(ED25519_ORDER)),
+        ERROR_CRYPTOGRAPHY,
+        "Failed to reduce hash\n"
+    );
+    // The remainder is stored in the last bytes of the reduced value.
+    memmove(out_scalar, hash + 32, 32);
+    return ERROR_NONE;
+}
+
+/**
+ * Derive the secret scalar a as big endian integer, the prefix and the encoded public key A from the private key, see
+ * rfc8032 section 5.1.5. out_prefix and out_public_key are optional.
+ */
+WARN_UNUSED_RESULT
+static error_t derive_key(const uint32_t *bip32_path, uint8_t bip32_path_length, uint8_t *out_scalar,
+    uint8_t *out_prefix, uint8_t *out_public_key) {
+    error_t result = ERROR_NONE;
+    uint8_t private_key_data[64]; // the private key is only 32 bytes, but os_derive_bip32_with_seed_no_throw expects 64
+    uint8_t expanded_private_key[64];
+    uint8_t point[sizeof(ED25519_BASE_POINT)];
+
+    GOTO_ON_ERROR(
+        os_derive_bip32_with_seed_no_throw(
+            /* derivation mode */ HDW_ED25519_SLIP10,
+            /* curve */ CX_CURVE_Ed25519,
+            /* path */ (uint32_t *) bip32_path,
+            /* path length */ bip32_path_length,
+            /* out */ private_key_data,
+            /* chain code */ NULL,
+            /* seed key */ NULL, // use the default for HDW_ED25519_SLIP10, which is "ed25519 seed"
+            /* seed key length */ 0
+        )
+        || cx_hash_sha512(private_key_data, 32, expanded_private_key, sizeof(expanded_private_key))
+            != sizeof(expanded_private_key),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to derive private key\n"
+    );
+
+    // Prune the lower half of the hash as little endian scalar, and convert it to big endian. The reduction modulo the
+    // group order does not change the public key or signatures, as the base point's order is the group order.
+    expanded_private_key[0] &= 248;
+    expanded_private_key[31] &= 127;
+    expanded_private_key[31] |= 64;
+    for (uint8_t i = 0; i < 32; i++) {
+        out_scalar[i] = expanded_private_key[31 - i];
+    }
+    GOTO_ON_ERROR(
+        cx_math_modm_no_throw(out_scalar, 32, ED25519_ORDER, sizeof(ED25519_ORDER)),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to reduce private key\n"
+    );
+    if (out_prefix) {
+        memmove(out_prefix, expanded_private_key + 32, 32);
+    }
+
+    if (out_public_key) {
+        memmove(point, ED25519_BASE_POINT, sizeof(point));
+        GOTO_ON_ERROR(
+            cx_ecfp_scalar_mult_no_throw(CX_CURVE_Ed25519, point, out_scalar, 32),
+            end,
+            result,
+            ERROR_CRYPTOGRAPHY,
+            "Failed to calculate public key\n"
+        );
+        encode_point(point, out_public_key);
+    }
+
+end:
+    explicit_bzero(private_key_data, sizeof(private_key_data));
+    explicit_bzero(expanded_private_key, sizeof(expanded_private_key));
+    return result;
+}
+
+/**
+ * Allocate and initialize the hash contexts of a pass, with the signature hash starting with the given prefix.
+ */
+WARN_UNUSED_RESULT
+static error_t start_pass(streamed_signing_state_t *state, const uint8_t *prefix, uint8_t prefix_length) {
+    state->signature_hash_context = request_arena_alloc(sizeof(cx_sha512_t));
+    state->message_hash_context = request_arena_alloc(sizeof(cx_blake2b_t));
+    RETURN_ON_ERROR(
+        cx_sha512_init_no_throw(state->signature_hash_context)
+        || cx_blake2b_init_no_throw(state->message_hash_context, /* hash length in bits */ 256)
+        || cx_hash_update(&state->signature_hash_context->header, prefix, prefix_length),
+        ERROR_CRYPTOGRAPHY,
+        "Failed to initialize hashes\n"
+    );
+    return ERROR_NONE;
+}
+
+/**
+ * Wipe the hash contexts, of which the signature hash context depends on secret data.
+ */
+static void end_pass(streamed_signing_state_t *state) {
+    if (state->signature_hash_context) {
+        explicit_bzero(state->signature_hash_context, sizeof(cx_sha512_t));
+    }
+    if (state->message_hash_context) {
+        explicit_bzero(state->message_hash_context, sizeof(cx_blake2b_t));
+    }
+    state->signature_hash_context = NULL;
+    state->message_hash_context = NULL;
+}
+
+WARN_UNUSED_RESULT
+error_t streamed_signing_start_first_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length) {
+    error_t result = ERROR_NONE;
+    uint8_t scalar[32];
+    uint8_t prefix[32];
+    GOTO_ON_ERROR(
+        derive_key(bip32_path, bip32_path_length, scalar, prefix, NULL),
+        end,
+        result
+    );
+    GOTO_ON_ERROR(
+        start_pass(state, prefix, sizeof(prefix)),
+        end,
+        result
+    );
+    state->stage = STREAMED_SIGNING_STAGE_FIRST_PASS;
+
+end:
+    explicit_bzero(scalar, sizeof(scalar));
+    explicit_bzero(prefix, sizeof(prefix));
+    return result;
+}
+
+WARN_UNUSED_RESULT
+error_t streamed_signing_update(streamed_signing_state_t *state, const uint8_t *data, uint16_t data_length) {
+    LEDGER_ASSERT(
+        state->signature_hash_context && state->message_hash_context,
+        "Streamed signing pass not started"
+    );
+    RETURN_ON_ERROR(
+        cx_hash_update(&state->signature_hash_context->header, data, data_length)
+        || cx_hash_update(&state->message_hash_context->header, data, data_length),
+        ERROR_CRYPTOGRAPHY,
+        "Failed to update hashes\n"
+    );
+    return ERROR_NONE;
+}
+
+WARN_UNUSED_RESULT
+error_t streamed_signing_finish_first_pass(streamed_signing_state_t *state) {
+    error_t result = ERROR_NONE;
+    uint8_t hash[64];
+    uint8_t point[sizeof(ED25519_BASE_POINT)];
+
+    // r = SHA-512(prefix || M) mod L, and R = r * B
+    GOTO_ON_ERROR(
+        cx_hash_final(&state->signature_hash_context->header, hash)
+        || cx_hash_final(&state->message_hash_context->header, state->message_hash),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to finalize hashes\n"
+    );
+    GOTO_ON_ERROR(
+        reduce_hash(hash, state->nonce),
+        end,
+        result
+    );
+    memmove(point, ED25519_BASE_POINT, sizeof(point));
+    GOTO_ON_ERROR(
+        cx_ecfp_scalar_mult_no_throw(CX_CURVE_Ed25519, point, state->nonce, sizeof(state->nonce)),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to calculate nonce point\n"
+    );
+    encode_point(point, state->encoded_nonce_point);
+    state->stage = STREAMED_SIGNING_STAGE_REVIEW;
+
+end:
+    explicit_bzero(hash, sizeof(hash));
+    end_pass(state);
+    return result;
+}
+
+WARN_UNUSED_RESULT
+error_t streamed_signing_start_second_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length) {
+    error_t result = ERROR_NONE;
+    uint8_t scalar[32];
+    // R || A, with which the challenge hash starts.
+    uint8_t encoded_nonce_point_and_public_key[64];
+    memmove(encoded_nonce_point_and_public_key, state->encoded_nonce_point, 32);
+    GOTO_ON_ERROR(
+        derive_key(bip32_path, bip32_path_length, scalar, NULL, encoded_nonce_point_and_public_key + 32),
+        end,
+        result
+    );
+    GOTO_ON_ERROR(
+        start_pass(state, encoded_nonce_point_and_public_key, sizeof(encoded_nonce_point_and_public_key)),
+        end,
+        result
+    );
+    state->stage = STREAMED_SIGNING_STAGE_SECOND_PASS;
+
+end:
+    explicit_bzero(scalar, sizeof(scalar));
+    return result;
+}
+
+WARN_UNUSED_RESULT
+error_t streamed_signing_finish_second_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length, uint8_t *out_signature) {
+    error_t result = ERROR_NONE;
+    uint8_t hash[64];
+    uint8_t challenge[32];
+    uint8_t scalar[32];
+    uint8_t product[32];
+    uint8_t s[32];
+
+    GOTO_ON_ERROR(
+        cx_hash_final(&state->message_hash_context->header, hash),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to finalize message hash\n"
+    );
+    GOTO_ON_ERROR(
+        memcmp(hash, state->message_hash, sizeof(state->message_hash)) != 0,
+        end,
+        result,
+        ERROR_INCORRECT_DATA,
+        "Message differs from first pass\n"
+    );
+
+    // k = SHA-512(R || A || M) mod L, and S = (r + k * a) mod L
+    GOTO_ON_ERROR(
+        cx_hash_final(&state->signature_hash_context->header, hash),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to finalize challenge hash\n"
+    );
+    GOTO_ON_ERROR(
+        reduce_hash(hash, challenge),
+        end,
+        result
+    );
+    GOTO_ON_ERROR(
+        derive_key(bip32_path, bip32_path_length, scalar, NULL, NULL),
+        end,
+        result
+    );
+    GOTO_ON_ERROR(
+        cx_math_multm_no_throw(product, challenge, scalar, ED25519_ORDER, sizeof(ED25519_ORDER))
+        || cx_math_addm_no_throw(s, product, state->nonce, ED25519_ORDER, sizeof(ED25519_ORDER)),
+        end,
+        result,
+        ERROR_CRYPTOGRAPHY,
+        "Failed to calculate signature\n"
+    );
+
+    // The signature is R || S, with S encoded as little endian integer.
+    memmove(out_signature, state->encoded_nonce_point, 32);
+    for (uint8_t i = 0; i < 32; i++) {
+        out_signature[32 + i] = s[31 - i];
+    }
+
+end:
+    explicit_bzero(scalar, sizeof(scalar));
+    explicit_bzero(product, sizeof(product));
+    explicit_bzero(s, sizeof(s));
+    // Wipe the nonce, such that it can not be used for another signature.
+    explicit_bzero(state->nonce, sizeof(state->nonce));
+    end_pass(state);
+    state->stage = STREAMED_SIGNING_STAGE_NONE;
+    return result;
+}
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_STREAMED_SIGNING_H_
+#define _NIMIQ_STREAMED_SIGNING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// From Ledger SDK
+#include "cx.h"
+
+#include "error_macros.h"
+#include "request_arena.h"
+
+typedef enum {
+    // The initial stage has value 0, such that a zeroed state is a regular, non-streamed transaction signing.
+    STREAMED_SIGNING_STAGE_NONE = 0,
+    STREAMED_SIGNING_STAGE_FIRST_PASS,
+    STREAMED_SIGNING_STAGE_REVIEW, // the first pass is complete, and the transaction is being reviewed by the user
+    STREAMED_SIGNING_STAGE_APPROVED, // approved by the user, and waiting for the second pass
+    STREAMED_SIGNING_STAGE_SECOND_PASS,
+} streamed_signing_stage_t;
+
+/**
+ * Ed25519 signing of a message which is sent twice, instead of being held in memory in its entirety, see
+ * https://datatracker.ietf.org/doc/html/rfc8032#section-5.1.6. The message is only needed for two hashes, which are
+ * calculated one after the other: SHA-512(prefix || M) for the nonce r in the first pass, and SHA-512(R || A || M) for
+ * the challenge k in the second pass. The resulting signature is identical to a signature created by
+ * cx_eddsa_sign_no_throw over the entire message.
+ * Both passes additionally calculate a Blake2b hash of the message, to ensure that the second pass carried exactly the
+ * same message as the first pass, which the user reviewed. Signing different messages with the same nonce would leak
+ * the private key.
+ */
+typedef struct {
+    streamed_signing_stage_t stage;
+    uint8_t nonce[32]; // r, big endian and reduced modulo the group order; secret
+    uint8_t encoded_nonce_point[32]; // R, encoded as specified in rfc8032
+    uint8_t message_hash[32]; // Blake2b hash of the message of the first pass
+    // The hash contexts are only needed while the message is received, and are allocated in the request arena, which is
+    // reused for printing the values to display during the review between both passes.
+    cx_sha512_t *signature_hash_context;
+    cx_blake2b_t *message_hash_context;
+} streamed_signing_state_t;
+
+// Request arena memory needed during each pass, see streamed_signing_start_first_pass.
+#define STREAMED_SIGNING_ARENA_BUDGET (REQUEST_ARENA_ALIGN(sizeof(cx_sha512_t)) \
+    + REQUEST_ARENA_ALIGN(sizeof(cx_blake2b_t)))
+
+/**
+ * Start the first pass, which derives the nonce from the private key's prefix and the message. The hash contexts are
+ * allocated in the request arena.
+ */
+WARN_UNUSED_RESULT
+error_t streamed_signing_start_first_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length);
+
+/**
+ * Hash the next part of the message, in the first or second pass.
+ */
+WARN_UNUSED_RESULT
+error_t streamed_signing_update(streamed_signing_state_t *state, const uint8_t *data, uint16_t data_length);
+
+/**
+ * Finish the first pass by calculating the nonce r and the nonce point R. The hash contexts are wiped
+ * afterwards, such that their arena memory can be reused.
+ */
+WARN_UNUSED_RESULT
+error_t streamed_signing_finish_first_pass(streamed_signing_state_t *state);
+
+/**
+ * Start the second pass, which calculates the challenge from the nonce point, the public key and the message.
+ */
+WARN_UNUSED_RESULT
+error_t streamed_signing_start_second_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length);
+
+/**
+ * Finish the second pass and write the 64 byte signature R || S to out_signature, after checking that the message was
+ * the same in both passes. The secret nonce is wiped afterwards, such that a signature can only be created once.
+ */
+WARN_UNUSED_RESULT
+error_t streamed_signing_finish_second_pass(streamed_signing_state_t *state, const uint32_t *bip32_path,
+    uint8_t bip32_path_length, uint8_t *out_signature);
+
+#endif // _NIMIQ_STREAMED_SIGNING_H_
@@ -0,0 +1,211 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "timing.h"
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// From Ledger SDK
+#include "os.h"
+#include "os_io_seproxyhal.h" // for G_io_apdu_buffer
+#include "cx.h"
+
+#include "nimiq_utils.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_TIMING
+
+#if defined(NIMIQ_CYCLE_COUNTER) && NIMIQ_CYCLE_COUNTER
+// Registers of the ARMv7-M / ARMv8-M debug and trace units.
+#define DEMCR (*(volatile uint32_t *) 0xE000EDFC)
+#define DEMCR_TRCENA (1 << 24)
+#define DWT_CTRL (*(volatile uint32_t *) 0xE0001000)
+#define DWT_CTRL_CYCCNTENA (1 << 0)
+#define DWT_CYCCNT (*(volatile uint32_t *) 0xE0001004)
+#endif // NIMIQ_CYCLE_COUNTER
+
+#define TICKER_INTERVAL_MS 100
+// Length of the data hashed by TIMING_BENCHMARK_BLAKE2B, similar to a transaction.
+#define BENCHMARK_HASH_INPUT_LENGTH 160
+// Length of the data signed by TIMING_BENCHMARK_SIGN, like the prefixed hash signed for messages.
+#define BENCHMARK_SIGN_INPUT_LENGTH 32
+
+static uint32_t milliseconds;
+static uint32_t review_start;
+static timing_stats_t stats[TIMING_STAGE_COUNT];
+
+void timing_init() {
+    milliseconds = 0;
+    review_start = 0;
+    timing_reset();
+#if defined(NIMIQ_CYCLE_COUNTER) && NIMIQ_CYCLE_COUNTER
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif // NIMIQ_CYCLE_COUNTER
+}
+
+void timing_tick() {
+    milliseconds += TICKER_INTERVAL_MS;
+}
+
+uint32_t timing_now() {
+#if defined(NIMIQ_CYCLE_COUNTER) && NIMIQ_CYCLE_COUNTER
+    return DWT_CYCCNT;
+#else
+    return milliseconds;
+#endif // NIMIQ_CYCLE_COUNTER
+}
+
+timing_unit_t timing_get_unit() {
+#if defined(NIMIQ_CYCLE_COUNTER) && NIMIQ_CYCLE_COUNTER
+    return TIMING_UNIT_CYCLES;
+#else
+    return TIMING_UNIT_MILLISECONDS;
+#endif // NIMIQ_CYCLE_COUNTER
+}
+
+void timing_record(timing_stage_t stage, uint32_t start) {
+    if (stage >= TIMING_STAGE_COUNT) return;
+    // Unsigned subtraction handles a single wrap around of the counter.
+    uint32_t duration = timing_now() - start;
+    stats[stage].count++;
+    stats[stage].total += duration;
+    stats[stage].max = MAX(stats[stage].max, duration);
+}
+
+void timing_review_start() {
+    review_start = timing_now();
+}
+
+void timing_review_end() {
+    timing_record(TIMING_STAGE_REVIEW, review_start);
+}
+
+const timing_stats_t *timing_get_stats(timing_stage_t stage) {
+    LEDGER_ASSERT(stage < TIMING_STAGE_COUNT, "Invalid timing stage");
+    return &stats[stage];
+}
+
+void timing_reset() {
+    memset(stats, 0, sizeof(stats));
+}
+
+WARN_UNUSED_RESULT
+error_t timing_benchmark(timing_benchmark_operation_t operation, uint16_t iteration_count, uint32_t *out_mean,
+    uint32_t *out_max) {
+    error_t result = ERROR_NONE;
+    // 44'/242'/0'/0', the first Nimiq account.
+    uint32_t bip32Path[] = { 0x8000002c, 0x800000f2, 0x80000000, 0x80000000 };
+    uint8_t privateKeyData[64]; // the private key is only 32 bytes, but os_derive_bip32_with_seed_no_throw expects 64
+    cx_ecfp_256_private_key_t privateKey;
+    cx_ecfp_256_public_key_t publicKey;
+    uint8_t output[64];
+    uint64_t total = 0;
+    uint32_t max = 0;
+
+    GOTO_ON_ERROR(
+        operation > TIMING_BENCHMARK_BLAKE2B || iteration_count == 0,
+        end,
+        result,
+        ERROR_INCORRECT_DATA,
+        "Invalid benchmark operation or iteration count\n"
+    );
+
+    for (uint16_t i = 0; i <= iteration_count; i++) {
+        // The first run derives the key, which is used by the following runs, and is not measured.
+        bool is_measured = i > 0;
+        uint32_t start = timing_now();
+        if (!is_measured || operation == TIMING_BENCHMARK_DERIVE_KEY) {
+            GOTO_ON_ERROR(
+                os_derive_bip32_with_seed_no_throw(
+                    /* derivation mode */ HDW_ED25519_SLIP10,
+                    /* curve */ CX_CURVE_Ed25519,
+                    /* path */ bip32Path,
+                    /* path length */ ARRAY_LENGTH(bip32Path),
+                    /* out */ privateKeyData,
+                    /* chain code */ NULL,
+                    /* seed key */ NULL, // use the default for HDW_ED25519_SLIP10, which is "ed25519 seed"
+                    /* seed key length */ 0
+                )
+                || cx_ecfp_init_private_key_no_throw(
+                    /* curve */ CX_CURVE_Ed25519,
+                    /* raw key */ privateKeyData,
+                    /* key length */ 32,
+                    /* out */ &privateKey
+                ),
+                end,
+                result,
+                ERROR_CRYPTOGRAPHY,
+                "Failed to derive private key\n"
+            );
+        } else if (operation == TIMING_BENCHMARK_GENERATE_PUBLIC_KEY) {
+            GOTO_ON_ERROR(
+                cx_ecfp_generate_pair_no_throw(
+                    /* curve */ CX_CURVE_Ed25519,
+                    /* out */ &publicKey,
+                    /* private key */ &privateKey,
+                    /* keep private key */ true
+                ),
+                end,
+                result,
+                ERROR_CRYPTOGRAPHY,
+                "Failed to generate public key\n"
+            );
+        } else if (operation == TIMING_BENCHMARK_SIGN) {
+            GOTO_ON_ERROR(
+                cx_eddsa_sign_no_throw(
+                    /* private key */ &privateKey,
+                    /* hash id */ CX_SHA512,
+                    /* hash */ G_io_apdu_buffer,
+                    /* hash length */ BENCHMARK_SIGN_INPUT_LENGTH,
+                    /* out */ output,
+                    /* out length */ sizeof(output)
+                ),
+                end,
+                result,
+                ERROR_CRYPTOGRAPHY,
+                "Failed to sign\n"
+            );
+        } else {
+            _Static_assert(BENCHMARK_HASH_INPUT_LENGTH <= sizeof(G_io_apdu_buffer), "Benchmark hash input too long\n");
+            GOTO_ON_ERROR(
+                blake2b_256(G_io_apdu_buffer, BENCHMARK_HASH_INPUT_LENGTH, output),
+                end,
+                result,
+                ERROR_CRYPTOGRAPHY,
+                "Failed to hash\n"
+            );
+        }
+        if (!is_measured) continue;
+        uint32_t duration = timing_now() - start;
+        total += duration;
+        max = MAX(max, duration);
+    }
+    *out_mean = (uint32_t) (total / iteration_count);
+    *out_max = max;
+
+end:
+    explicit_bzero(privateKeyData, sizeof(privateKeyData));
+    explicit_bzero(&privateKey, sizeof(privateKey));
+    return result;
+}
+
+#endif // NIMIQ_DEBUG
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_TIMING_H_
+#define _NIMIQ_TIMING_H_
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "error_macros.h"
+
+/**
+ * Latency probes for debug builds. Probes around the stages of a request record the count, total and maximum duration
+ * per stage, which can be queried by the host via INS_GET_TIMINGS. Additionally, INS_BENCHMARK runs the cryptographic
+ * operations repeatedly on the device, to compare their cost between device models.
+ *
+ * Durations are measured with the DWT cycle counter if the app is built with CYCLE_COUNTER=1, which requires a setup in
+ * which the cycle counter is accessible to the app, like development hardware. Otherwise, they are measured in
+ * milliseconds via the 100 ms ticker events of the SDK, which are only processed while the app waits for io. This is
+ * sufficient for stages spanning user interaction like the review, but stages without io in between measure as 0 ms,
+ * and their time has to be measured by the host instead, e.g. as the round trip time of INS_BENCHMARK requests.
+ *
+ * In production builds, all of this compiles to nothing.
+ */
+
+typedef enum {
+    TIMING_UNIT_MILLISECONDS = 0,
+    TIMING_UNIT_CYCLES = 1,
+} timing_unit_t;
+
+/**
+ * The measured stages. The values define the order of the stages reported to the host, and new stages are appended.
+ */
+typedef enum {
+    // The entire handling of a request APDU, excluding user interaction which is performed asynchronously.
+    TIMING_STAGE_HANDLE_APDU,
+    // Parsing of a transaction chunk in parse_tx_chunk, which includes parse_tx for the last chunk.
+    TIMING_STAGE_PARSE_TX,
+    // Key derivation via os_derive_bip32_with_seed_no_throw and cx_ecfp_init_private_key_no_throw.
+    TIMING_STAGE_DERIVE_KEY,
+    TIMING_STAGE_GENERATE_PUBLIC_KEY,
+    TIMING_STAGE_SIGN,
+    // Initialization of the ui for a review.
+    TIMING_STAGE_UI_INIT,
+    // The user's review, from the start of the async reply until approval or rejection.
+    TIMING_STAGE_REVIEW,
+    // The on_*_approved and on_rejected callbacks, including the transmission of the response.
+    TIMING_STAGE_UX_CALLBACK,
+    TIMING_STAGE_COUNT,
+} timing_stage_t;
+
+/**
+ * Operations run by timing_benchmark.
+ */
+typedef enum {
+    TIMING_BENCHMARK_DERIVE_KEY = 0,
+    TIMING_BENCHMARK_GENERATE_PUBLIC_KEY = 1,
+    TIMING_BENCHMARK_SIGN = 2,
+    TIMING_BENCHMARK_BLAKE2B = 3,
+} timing_benchmark_operation_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t total;
+    uint32_t max;
+} timing_stats_t;
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+
+void timing_init();
+
+/**
+ * Advance the millisecond clock, on each ticker event.
+ */
+void timing_tick();
+
+/**
+ * Current time in the unit returned by timing_get_unit.
+ */
+uint32_t timing_now();
+
+timing_unit_t timing_get_unit();
+
+/**
+ * Record the duration of a stage which started at the given time.
+ */
+void timing_record(timing_stage_t stage, uint32_t start);
+
+/**
+ * Start or finish the REVIEW stage, which starts and ends in different functions.
+ */
+void timing_review_start();
+void timing_review_end();
+
+/**
+ * Stats of a stage since startup or the last timing_reset.
+ */
+const timing_stats_t *timing_get_stats(timing_stage_t stage);
+
+void timing_reset();
+
+/**
+ * Run an operation repeatedly and determine the mean and maximum duration of a single run.
+ */
+WARN_UNUSED_RESULT
+error_t timing_benchmark(timing_benchmark_operation_t operation, uint16_t iteration_count, uint32_t *out_mean,
+    uint32_t *out_max);
+
+#define TIMING_INIT() timing_init()
+#define TIMING_TICK() timing_tick()
+// Start a probe, storing the start time in a local variable of the given name, which is only declared in debug builds.
+#define TIMING_START(start_variable) uint32_t start_variable = timing_now()
+#define TIMING_RECORD(stage, start_variable) timing_record(stage, start_variable)
+#define TIMING_REVIEW_START() timing_review_start()
+#define TIMING_REVIEW_END() timing_review_end()
+
+#else // NIMIQ_DEBUG
+
+#define TIMING_INIT() do {} while (0)
+#define TIMING_TICK() do {} while (0)
+#define TIMING_START(start_variable) do {} while (0)
+#define TIMING_RECORD(stage, start_variable) do {} while (0)
+#define TIMING_REVIEW_START() do {} while (0)
+#define TIMING_REVIEW_END() do {} while (0)
+
+#endif // NIMIQ_DEBUG
+
+#endif // _NIMIQ_TIMING_H_
@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "trace.h"
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG && !(defined(TEST) && TEST)
+
+#include <stddef.h>
+
+#include "timing.h"
+#include "utility_macros.h"
+
+_Static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of 2\n");
+
+static trace_entry_t entries[TRACE_CAPACITY];
+static uint16_t event_count;
+
+void trace_record(trace_event_t event, uint8_t arg, uint16_t error_site, uint32_t payload) {
+    trace_entry_t *entry = &entries[event_count & (TRACE_CAPACITY - 1)];
+    entry->timestamp = timing_now();
+    entry->payload = payload;
+    entry->error_site = error_site;
+    entry->event = event;
+    entry->arg = arg;
+    event_count++;
+}
+
+uint16_t trace_get_event_count() {
+    return event_count;
+}
+
+uint8_t trace_get_entry_count() {
+    // Once the event count wrapped around, the buffer has been filled in any case.
+    return event_count < TRACE_CAPACITY && !entries[TRACE_CAPACITY - 1].event ? event_count : TRACE_CAPACITY;
+}
+
+const trace_entry_t *trace_get_entry(uint8_t index) {
+    uint8_t entry_count = trace_get_entry_count();
+    if (index >= entry_count) return NULL;
+    // The oldest retained entry is the one which will be overwritten next, or the first entry if not filled yet.
+    return &entries[(uint16_t) (event_count - entry_count + index) & (TRACE_CAPACITY - 1)];
+}
+
+#endif // NIMIQ_DEBUG && !TEST
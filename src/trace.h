@@ -0,0 +1,92 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_TRACE_H_
+#define _NIMIQ_TRACE_H_
+
+#include <stdint.h>
+
+/**
+ * Binary trace of debug builds. Instead of PRINTing diagnostics, which is slow over semihosting and speculos, events
+ * are recorded as compact fixed size entries in a ring buffer in RAM, which costs only a few tens of cycles per event.
+ * The trace can be dumped by the host via INS_GET_TRACE and decoded with tests/trace_decoder.py. The verbose PRINTs of
+ * the error macros and of each APDU can still be enabled via DEBUG_VERBOSE=1.
+ *
+ * In production builds and unit tests, all of this compiles to nothing.
+ */
+
+/**
+ * The traced events. The values are part of the dumped trace and must therefore not be reassigned. New events are
+ * appended at the end.
+ */
+typedef enum: uint8_t {
+    // A command APDU was received. arg: INS, payload: CLA, P1, P2 and Lc, in that byte order.
+    TRACE_EVENT_APDU_COMMAND = 1,
+    // A request was handled, or an async reply is sent. arg: 0 for a response sent right away, 1 if an async reply was
+    // started instead, 2 for the response of an async reply. payload: status word, error_site: the G_error_site.
+    TRACE_EVENT_APDU_RESPONSE = 2,
+    // An error macro handled an error. payload: the error, or the custom error like a status word if one was passed to
+    // the macro, error_site: the macro's ERROR_SITE_ID.
+    TRACE_EVENT_ERROR = 3,
+    TRACE_EVENT_ON_ADDRESS_APPROVED = 4,
+    TRACE_EVENT_ON_TRANSACTION_APPROVED = 5,
+    TRACE_EVENT_ON_MESSAGE_APPROVED = 6,
+    TRACE_EVENT_ON_REJECTED = 7,
+    TRACE_EVENT_KEEP_ALIVE_SENT = 8,
+    // The app was reset after an exception. payload: the exception.
+    TRACE_EVENT_APP_RESET = 9,
+} trace_event_t;
+
+/**
+ * A trace entry. The timestamp is in the unit of timing.h.
+ */
+typedef struct {
+    uint32_t timestamp;
+    uint32_t payload;
+    uint16_t error_site;
+    trace_event_t event;
+    uint8_t arg;
+} trace_entry_t;
+
+// Number of retained entries. Must be a power of 2.
+#define TRACE_CAPACITY 32
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG && !(defined(TEST) && TEST)
+
+void trace_record(trace_event_t event, uint8_t arg, uint16_t error_site, uint32_t payload);
+
+/**
+ * Total number of recorded events, including those which have been overwritten already. Wraps around at 2^16.
+ */
+uint16_t trace_get_event_count();
+
+/**
+ * Get a retained entry, by its index among the retained entries, from oldest to newest. Returns NULL if out of range.
+ */
+const trace_entry_t *trace_get_entry(uint8_t index);
+
+uint8_t trace_get_entry_count();
+
+#define TRACE(event, arg, error_site, payload) trace_record(event, arg, error_site, payload)
+
+#else // NIMIQ_DEBUG && !TEST
+
+#define TRACE(event, arg, error_site, payload) do {} while (0)
+
+#endif // NIMIQ_DEBUG && !TEST
+
+#endif // _NIMIQ_TRACE_H_
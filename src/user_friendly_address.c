@@ -0,0 +1,256 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "user_friendly_address.h"
+#include "base32.h"
+
+#define ERROR_SITE_FILE ERROR_SITE_FILE_USER_FRIENDLY_ADDRESS
+
+// Values of the chars of Nimiq's base32 alphabet "0123456789ABCDEFGHJKLMNPQRSTUVXY" in the IBAN check, in which digits
+// have their decimal value and letters A to Z have values 10 to 35. Note that the alphabet skips I, O, W and Z.
+static const uint8_t IBAN_VALUES[32] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, // 0 - 9
+    10, 11, 12, 13, 14, 15, 16, 17, // A - H
+    19, 20, 21, 22, 23, // J - N
+    25, 26, 27, 28, 29, 30, 31, // P - V
+    33, 34, // X, Y
+};
+
+// Reduce a value below 1024 modulo 97, without division, which is not available in hardware on all Ledger devices.
+// (value * 675) >> 16 underestimates value / 97 by at most one, which is corrected by a single subtraction.
+static inline uint8_t reduce_mod_97(uint16_t value) {
+    uint16_t remainder = value - 97 * ((uint32_t) value * 675 >> 16);
+    return remainder >= 97 ? remainder - 97 : remainder;
+}
+
+// Append the value of a base32 char to the IBAN checksum, which is the remainder of the decimal number of the
+// concatenated char values modulo 97. Digits append one decimal digit and letters two, i.e. multiply the previous
+// remainder by 10 or 100, where 100 mod 97 = 3.
+static inline uint8_t iban_checksum_append(uint8_t checksum, uint8_t base32_index) {
+    uint8_t value = IBAN_VALUES[base32_index];
+    return reduce_mod_97(value < 10 ? checksum * 10 + value : checksum * 3 + value);
+}
+
+// Encode an address in the user friendly format, see print_address.
+static void encode_address(uint8_t *in, char *out) {
+    static const char ALPHABET[32] = "0123456789ABCDEFGHJKLMNPQRSTUVXY";
+    uint8_t checksum = 0;
+    // The 20 bytes of the address are encoded as 4 groups of 5 bytes, each encoded as 8 base32 chars, which are printed
+    // as 2 blocks of 4 chars, each preceded by a space. The first block starts after "NQ" and the check digits.
+    char *block = out + 4;
+    for (uint8_t group = 0; group < 4; group++, in += 5) {
+        uint8_t indices[8] = {
+            in[0] >> 3,
+            (in[0] & 0x07) << 2 | in[1] >> 6,
+            (in[1] >> 1) & 0x1f,
+            (in[1] & 0x01) << 4 | in[2] >> 4,
+            (in[2] & 0x0f) << 1 | in[3] >> 7,
+            (in[3] >> 2) & 0x1f,
+            (in[3] & 0x03) << 3 | in[4] >> 5,
+            in[4] & 0x1f,
+        };
+        for (uint8_t i = 0; i < 8; i++) {
+            if (i % 4 == 0) {
+                *block++ = ' ';
+            }
+            *block++ = ALPHABET[indices[i]];
+            checksum = iban_checksum_append(checksum, indices[i]);
+        }
+    }
+    *block = '\0';
+
+    // According to the IBAN standard, the country code "NQ" and check digits "00", here given as indices in the base32
+    // alphabet, are appended to the address for calculating the checksum. The check digits are 98 minus the checksum.
+    checksum = iban_checksum_append(checksum, /* N */ 22);
+    checksum = iban_checksum_append(checksum, /* Q */ 24);
+    checksum = iban_checksum_append(checksum, /* 0 */ 0);
+    checksum = iban_checksum_append(checksum, /* 0 */ 0);
+    uint8_t check_digits = 98 - checksum;
+    out[0] = 'N';
+    out[1] = 'Q';
+    out[2] = '0' + check_digits / 10;
+    out[3] = '0' + check_digits % 10;
+}
+
+// Memo of the most recently printed addresses, as a review often prints the same address multiple times, e.g. a sender
+// which is also the HTLC refund address or the staker address, or a delegation repeated across transactions. Entries
+// are replaced in round robin order. The staking contract address, which is checked by is_staking_contract, is
+// additionally available as constant in flash.
+#define ADDRESS_CACHE_SIZE 2
+#define ADDRESS_LENGTH 20
+typedef struct {
+    uint8_t address[ADDRESS_LENGTH];
+    char printed[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
+} address_cache_entry_t;
+static const address_cache_entry_t ADDRESS_CACHE_STAKING_CONTRACT = {
+    .address = { [ADDRESS_LENGTH - 1] = 1 },
+    .printed = "NQ77 0000 0000 0000 0000 0000 0000 0000 0001",
+};
+static struct {
+    address_cache_entry_t entries[ADDRESS_CACHE_SIZE];
+    uint8_t entry_count;
+    uint8_t next_entry;
+    DEBUG_EMIT(address_cache_stats_t stats;)
+} address_cache;
+
+// Get the printed address from the memo, or NULL if it's not memoized.
+static const char *address_cache_get(uint8_t *address) {
+    if (memcmp(address, ADDRESS_CACHE_STAKING_CONTRACT.address, ADDRESS_LENGTH) == 0) {
+        return ADDRESS_CACHE_STAKING_CONTRACT.printed;
+    }
+    for (uint8_t i = 0; i < address_cache.entry_count; i++) {
+        if (memcmp(address, address_cache.entries[i].address, ADDRESS_LENGTH) == 0) {
+            return address_cache.entries[i].printed;
+        }
+    }
+    return NULL;
+}
+
+WARN_UNUSED_RESULT
+error_t print_address(uint8_t *in, char *out) {
+    const char *memoized = address_cache_get(in);
+    if (memoized) {
+        DEBUG_EMIT(address_cache.stats.hits++;)
+        memcpy(out, memoized, STRING_LENGTH_USER_FRIENDLY_ADDRESS);
+        return ERROR_NONE;
+    }
+    DEBUG_EMIT(address_cache.stats.misses++;)
+    encode_address(in, out);
+    address_cache_entry_t *entry = &address_cache.entries[address_cache.next_entry];
+    memcpy(entry->address, in, ADDRESS_LENGTH);
+    memcpy(entry->printed, out, STRING_LENGTH_USER_FRIENDLY_ADDRESS);
+    address_cache.next_entry = (address_cache.next_entry + 1) % ADDRESS_CACHE_SIZE;
+    if (address_cache.entry_count < ADDRESS_CACHE_SIZE) {
+        address_cache.entry_count++;
+    }
+    return ERROR_NONE;
+}
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+address_cache_stats_t address_cache_get_stats() {
+    return address_cache.stats;
+}
+
+void address_cache_reset_stats() {
+    address_cache.stats = (address_cache_stats_t) { 0 };
+}
+#endif // NIMIQ_DEBUG
+
+WARN_UNUSED_RESULT
+static error_t iban_check(char base32[static 32], char *check) {
+    unsigned int counter = 0;
+    unsigned int offset = 0;
+    unsigned int modulo = 0;
+
+    int partial_uint = 0;
+
+    char address[36] = { 0 };
+    char total_number[71] = { 0 };
+    char partial_number[10] = { 0 };
+
+    // According to IBAN standard, "NQ00" needs to be appended to the original address to calculate the checksum
+    // Note: the input base32 is not required to be \0 terminated. We only look at the ascii chars before a potential
+    // string terminator here. Check that it's indeed valid base32 chars happens below.
+    memmove(address, base32, MIN(sizeof(address), 32));
+    address[32] = 'N';
+    address[33] = 'Q';
+    address[34] = '0';
+    address[35] = '0';
+
+    // Convert the address to a number-only string
+    for (unsigned int i = 0; i < 36; i++) {
+        LEDGER_ASSERT(
+            // This assertion should hold, given the number of iterations and the fact that at least two address chars
+            // are digits, which increase the counter only by one.
+            counter < 70,
+            "Overflow in iban check"
+        );
+        if (address[i] >= 48 && address[i] <= 57) {
+            total_number[counter++] = address[i];
+        } else if (address[i] >= 65 && address[i] <= 90) {
+            // Letters convert to a two digit number.
+            total_number[counter++] = '0' + (address[i] - 55) / 10;
+            total_number[counter++] = '0' + (address[i] - 55) % 10;
+        } else if (address[i] >= 97 && address[i] <= 122) {
+            // Letters convert to a two digit number.
+            total_number[counter++] = '0' + (address[i] - 87) / 10;
+            total_number[counter++] = '0' + (address[i] - 87) % 10;
+        } else {
+            RETURN_ERROR(
+                ERROR_INCORRECT_DATA,
+                "Invalid ascii code in iban check\n"
+            );
+        }
+    }
+
+    // Compute modulo-97 on the resulting number (do it in 32-bit pieces)
+    counter = 0;
+    for (unsigned int i = 0; i < 10; i++) {
+        memmove(&partial_number[offset], &total_number[counter], 9 - offset);
+        counter += 9 - offset;
+        for (unsigned int j = 0; j < 9; j++) {
+            if (partial_number[j] != '\0') {
+                partial_uint = 10 * partial_uint + (partial_number[j] - '0');
+            } else {
+                break;
+            }
+        }
+
+        modulo = partial_uint % 97;
+        partial_number[0] = '0' + modulo / 10;
+        partial_number[1] = '0' + modulo % 10;
+        partial_number[2] = '\0';
+        partial_uint = 0;
+        offset = 2;
+    }
+
+    check[0] = '0' + (98 - modulo) / 10;
+    check[1] = '0' + (98 - modulo) % 10;
+    check[2] = '\0';
+
+    return ERROR_NONE;
+}
+
+WARN_UNUSED_RESULT
+error_t print_address_reference(uint8_t *in, char *out) {
+    unsigned int counter = 4;
+    char after_base32[33] = { 0 }; // includes one extra byte for the string terminator
+
+    RETURN_ON_ERROR(
+        base32_encode(in, 20, after_base32, sizeof(after_base32))
+    );
+    RETURN_ON_ERROR(
+        iban_check(after_base32, &out[2])
+    );
+
+    out[0] = 'N';
+    out[1] = 'Q';
+
+    // Insert spaces for readability
+    for (unsigned int i = 0; i < 8; i++) {
+        out[counter++] = ' ';
+        memcpy(&out[counter], &after_base32[i*4], 4);
+        counter += 4;
+    }
+
+    // Make sure that the address string is always null-terminated
+    out[44] = '\0';
+
+    return ERROR_NONE;
+}
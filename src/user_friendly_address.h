@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_USER_FRIENDLY_ADDRESS_H_
+#define _NIMIQ_USER_FRIENDLY_ADDRESS_H_
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "error_macros.h"
+
+/**
+ * Print a 20 byte address in the user friendly format "NQ07 0000 0000 0000 0000 0000 0000 0000 0000", consisting of
+ * the country code, the IBAN check digits and the base32 encoded address in groups of four characters. The base32
+ * conversion is unrolled for the fixed address length, and the IBAN check digits are calculated incrementally from the
+ * values of the base32 characters, within a single pass over the address. The most recently printed addresses and the
+ * staking contract address are memoized. out must hold STRING_LENGTH_USER_FRIENDLY_ADDRESS chars.
+ */
+WARN_UNUSED_RESULT
+error_t print_address(uint8_t *in, char *out);
+
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+} address_cache_stats_t;
+
+/**
+ * Get the number of print_address calls, which were served from the memo of recently printed addresses, or not, since
+ * startup or the last address_cache_reset_stats. Reported to the host via INS_GET_TIMINGS.
+ */
+address_cache_stats_t address_cache_get_stats();
+
+void address_cache_reset_stats();
+#endif // NIMIQ_DEBUG
+
+/**
+ * Reference implementation of print_address, via the generic base32_encode and the IBAN check on a decimal string. Not
+ * used by the app, such that it's removed by the linker, but kept for cross-checking and benchmarking print_address in
+ * unit-tests/addresstest.c.
+ */
+WARN_UNUSED_RESULT
+error_t print_address_reference(uint8_t *in, char *out);
+
+#endif // _NIMIQ_USER_FRIENDLY_ADDRESS_H_
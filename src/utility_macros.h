@@ -19,6 +19,8 @@
 #define _NIMIQ_UTILITY_MACROS_H_
 
 #if defined(TEST) && TEST
+#include <stdio.h>
+#include <assert.h>
 #define PRINTF(...) printf(__VA_ARGS__)
 #define LEDGER_ASSERT(test, ...) assert(test)
 #define PIC(code) code
@@ -31,6 +33,17 @@
 #define DEBUG_EMIT(...) /* drop contents */
 #endif // NIMIQ_DEBUG
 
+/**
+ * Verbose debug messages, like those of the error macros and of each APDU. On the device, these are only PRINTed in
+ * verbose debug builds, as printing is slow over semihosting or speculos. Otherwise, the events are recorded in the
+ * binary trace instead, see trace.h. In unit tests, they are always printed.
+ */
+#if (defined(NIMIQ_DEBUG_VERBOSE) && NIMIQ_DEBUG_VERBOSE) || (defined(TEST) && TEST)
+#define VERBOSE_PRINTF(...) PRINTF(__VA_ARGS__)
+#else
+#define VERBOSE_PRINTF(...) do {} while (0)
+#endif // NIMIQ_DEBUG_VERBOSE || TEST
+
 #define VA_ARGS(...) __VA_ARGS__
 #define VA_ARGS_DROP(...) /* drop contents */
 #define VA_ARGS_PICK_FIRST(first, ...) first
@@ -54,6 +67,11 @@
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif // MAX
 
+/**
+ * Number of elements of an array. Must only be used with actual arrays, not with pointers.
+ */
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
 #define STRING_LENGTH_WITH_SUFFIX(length_a, suffix) (length_a - /* string terminator of string a */ 1 + sizeof(suffix))
 
 #define STRUCT_MEMBER_SIZE(struct_type, member) (sizeof(((struct_type *) NULL)->member))
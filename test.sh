@@ -6,3 +6,13 @@ gcc test/extparsertest.c src/nimiq_utils.c src/base32.c src/blake2b.c test/test_
 ./obj/extparsertest test/extendedTx.hex
 gcc test/utilstest.c src/nimiq_utils.c src/base32.c src/blake2b.c test/test_utils.c -o obj/utilstest -I src/ -I test/ -D TEST
 ./obj/utilstest
+gcc unit-tests/varinttest.c src/buffer_reader.c -o obj/varinttest -I src/ -std=gnu2x -fshort-enums -O2 -D TEST
+./obj/varinttest
+gcc unit-tests/printingtest.c src/printing.c -o obj/printingtest -I src/ -std=gnu2x -fshort-enums -O2 -D TEST
+./obj/printingtest
+gcc unit-tests/addresstest.c src/user_friendly_address.c src/base32.c -o obj/addresstest -I src/ -std=gnu2x -fshort-enums -O2 -D TEST -D NIMIQ_DEBUG=1
+./obj/addresstest
+gcc unit-tests/signatureprooftest.c src/signature_proof.c src/buffer_reader.c -o obj/signatureprooftest -I src/ -std=gnu2x -fshort-enums -O1 -fsanitize=address,undefined -D TEST
+./obj/signatureprooftest
+gcc unit-tests/clienttest.c client/nimiq_client.c -o obj/clienttest -I src/ -I client/ -std=c2x -D_DEFAULT_SOURCE -O1 -fsanitize=address,undefined -pthread -D TEST
+./obj/clienttest
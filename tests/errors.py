@@ -2,6 +2,8 @@ from enum import IntEnum
 
 class Errors(IntEnum):
     SW_DENY                    = 0x6985
+    SW_INCORRECT_DATA          = 0x6A80
+    SW_NOT_SUPPORTED           = 0x6A82
     SW_WRONG_P1P2              = 0x6A86
     SW_WRONG_DATA_LENGTH       = 0x6A87
     SW_INS_NOT_SUPPORTED       = 0x6D00
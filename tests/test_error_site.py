@@ -0,0 +1,39 @@
+import pytest
+from ragger.error import ExceptionRAPDU
+
+from .errors import Errors
+from .test_get_public_key import APDUS as GET_PUBLIC_KEY_APDUS
+
+# Source file id of main.c in the upper bits of error site ids, see error_site_file_t in src/error_macros.h
+ERROR_SITE_FILE_MAIN = 2
+ERROR_SITE_LINE_BITS = 11
+
+def get_error_site(backend) -> int:
+    response = backend.exchange_raw(bytes.fromhex("e00c000000"))
+    assert response.status == 0x9000
+    assert len(response.data) == 2
+    return int.from_bytes(response.data, "big")
+
+def test_error_site(backend):
+    GET_PUBLIC_KEY_APDUS["no_confirm"].exchange(backend)
+    assert get_error_site(backend) == 0
+    # Get public key with invalid P1, which fails in handle_apdu.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e002020011048000002c800000f28000000080000000"))
+    assert e.value.status == Errors.SW_WRONG_P1P2
+    invalid_p1_error_site = get_error_site(backend)
+    assert invalid_p1_error_site >> ERROR_SITE_LINE_BITS == ERROR_SITE_FILE_MAIN
+    # The query doesn't reset the error site it reports.
+    assert get_error_site(backend) == invalid_p1_error_site
+
+    # An APDU of which the length doesn't match its Lc is rejected before handle_apdu, but still records its own error
+    # site, instead of reporting the one of the previous request.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e002000011048000002c800000f2"))
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+    wrong_length_error_site = get_error_site(backend)
+    assert wrong_length_error_site >> ERROR_SITE_LINE_BITS == ERROR_SITE_FILE_MAIN
+    assert wrong_length_error_site != invalid_p1_error_site
+
+    GET_PUBLIC_KEY_APDUS["no_confirm"].exchange(backend)
+    assert get_error_site(backend) == 0
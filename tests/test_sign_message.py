@@ -5,6 +5,10 @@ from ragger.navigator import NavInsID
 
 from .raw_apdu_exchange import RawApduExchange
 from .errors import Errors
+from .utils import max_printable_message_length
+
+# Text of the NBGL page offering to switch the message display type, see ui_message_on_entries_reviewed
+DISPLAY_TYPE_CHOICE_TEXT = "another format"
 
 APDUS = {
     # Message (ascii): 'Hello world.'
@@ -23,16 +27,6 @@ APDUS = {
         "e8eccbdcf7fa33d031269ec16ba53ce9d28eee91773a864dceca077980bd15e7f9543543cce06bf33525db01a49eddaca4227d17890434"
             "97a444f8399a774f0b",
     ),
-    # Message (ascii): 'Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt
-    # ut labore et dolore magna aliquyam erat, sed diam voluptua. End...'
-    "ascii_overlong": RawApduExchange(
-        "e00a0000b8048000002c800000f2800000008000000000000000a24c6f72656d20697073756d20646f6c6f722073697420616d65742c20"
-            "636f6e736574657475722073616469707363696e6720656c6974722c20736564206469616d206e6f6e756d79206569726d6f642074"
-            "656d706f7220696e766964756e74207574206c61626f726520657420646f6c6f7265206d61676e6120616c69717579616d20657261"
-            "742c20736564206469616d20766f6c75707475612e20456e642e2e2e",
-        "f01eb0776c988edc723a563acc1351789de922866d769f780c68cd4f88e739281ee0d74dc97f268ee065ccea45870104884d44156bf001"
-            "63796dd9d153f21a03",
-    ),
     # Message (hex): 'cafecafe'
     "hex": RawApduExchange(
         "e00a00001a048000002c800000f280000000800000000000000004cafecafe",
@@ -41,6 +35,58 @@ APDUS = {
     ),
 }
 
+# Text from which the ascii messages at and beyond MAX_PRINTABLE_MESSAGE_LENGTH are built, by repeating it up to the
+# desired length, see limit_message_apdus.
+LIMIT_MESSAGE_TEXT = (
+    "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt ut labore et "
+    "dolore magna aliquyam erat, sed diam voluptua. "
+)
+# Signatures of the limit messages by message length, for MAX_PRINTABLE_MESSAGE_LENGTH of Nano X, Nano S+ and of Stax,
+# Flex and Apex P, and one byte more.
+LIMIT_MESSAGE_SIGNATURES = {
+    160: (
+        "92da9fb39271b6eb332ba141be5c264381acdab2185e7957d41cf75268cc2cdb828d171eea82a54f4c82b59c51162292a4190612dabe37"
+        "cfb2da967d6829db08"
+    ),
+    161: (
+        "d0b9c8d928dd537d5291f72ef0ef8188f7e8bdf44c5394a9105b58b2cf678b94d7a0d334facb279bb62bdf38fd980fdf41af5ab9a1bd85"
+        "3200b4dc29518a3e0a"
+    ),
+    320: (
+        "a29dc541b6c737c5139848c5066509b611744675807f1ee544cde75f8028eb092cbe97a7ea340df6a2f84815fd69c6281778c00f8f995f"
+        "755024eef3b56b6b0d"
+    ),
+    321: (
+        "a5020a376581f27d319db43496b310c4f6d95783c3d17b505bd27deb6be5954a25f7774fb196767816945af42314dc0a0d57167447f305"
+        "90dbc5a7b594c83605"
+    ),
+    1024: (
+        "1a19d242e46a04c83a4137a0f04a5607fb922fad047b5db700a84604f62ed389c9254c7fd99911686198c6e9e8848f47087736d81891d0"
+        "3a75fd532ee8703501"
+    ),
+    1025: (
+        "33a847971d0bd52ea039c7ad9f8db0aad09d1d7d387328defacbaaaac8e2e43cb816c5f73545c821c19f678e9dbccecd9cd0aa7d30b846"
+        "e6897d21b4adea050f"
+    ),
+}
+
+def limit_message_apdus(length: int) -> RawApduExchange:
+    """Sign message APDUs of an ascii message of the given length, built from LIMIT_MESSAGE_TEXT, and split into chunks
+    of at most 255 bytes of APDU data.
+    """
+    message = (LIMIT_MESSAGE_TEXT * (length // len(LIMIT_MESSAGE_TEXT) + 1))[:length].encode()
+    # Bip32 path 44'/242'/0'/0', no flags, and the message length, followed by the message
+    data = bytes.fromhex("048000002c800000f28000000080000000" "00") + length.to_bytes(4, "big") + message
+    chunks = [data[i:i + 255] for i in range(0, len(data), 255)]
+    return RawApduExchange(
+        [
+            bytes([0xe0, 0x0a, 0x00 if i == 0 else 0x80, 0x00 if i == len(chunks) - 1 else 0x80, len(chunk)]).hex()
+                + chunk.hex()
+            for i, chunk in enumerate(chunks)
+        ],
+        LIMIT_MESSAGE_SIGNATURES[length],
+    )
+
 def test_sign_message_approve(device: Device, backend, navigator, default_screenshot_path, test_name):
     for name, apdus in APDUS.items():
         screenshot_folder = test_name + f"_{name}"
@@ -57,15 +103,68 @@ def test_sign_message_approve(device: Device, backend, navigator, default_screen
                     screen_change_before_first_instruction = False,
                 )
             else:
-                navigator.navigate_until_text_and_compare(
+                # The NBGL message review is checked for the displayed text, like in the tests below. After the
+                # message, continue without switching the display type.
+                navigator.navigate_until_text(
+                    NavInsID.USE_CASE_REVIEW_TAP,
+                    [NavInsID.USE_CASE_CHOICE_REJECT],
+                    DISPLAY_TYPE_CHOICE_TEXT,
+                )
+                navigator.navigate_until_text(
                     NavInsID.USE_CASE_REVIEW_TAP,
                     [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
                     "Hold to sign",
-                    default_screenshot_path,
-                    screenshot_folder,
+                    screen_change_before_first_instruction = False,
                 )
         apdus.check_async_response(backend)
 
+@pytest.mark.parametrize("length_offset", [0, 1], ids=["at_limit", "overlong"])
+def test_sign_message_approve_printable_limit(device: Device, backend, navigator, length_offset: int):
+    # The display of messages at and beyond MAX_PRINTABLE_MESSAGE_LENGTH depends on the device, which is why the review
+    # is checked for the displayed text instead of snapshots. A message at the limit is displayed as ascii text,
+    # starting with the beginning of LIMIT_MESSAGE_TEXT, while a longer message can only be displayed as message hash.
+    apdus = limit_message_apdus(max_printable_message_length(device) + length_offset)
+    expected_text = "Lorem" if length_offset == 0 else "Message Hash"
+    with apdus.exchange_async(backend):
+        if device.is_nano:
+            # Manually skip the first page which also contains the word "Sign"
+            navigator.navigate([NavInsID.RIGHT_CLICK])
+            navigator.navigate_until_text(
+                NavInsID.RIGHT_CLICK,
+                [],
+                expected_text,
+                screen_change_before_first_instruction = False,
+                screen_change_after_last_instruction = False,
+            )
+            navigator.navigate_until_text(
+                NavInsID.RIGHT_CLICK,
+                [NavInsID.BOTH_CLICK],
+                "Sign",
+                screen_change_before_first_instruction = False,
+            )
+        else:
+            navigator.navigate_until_text(
+                NavInsID.USE_CASE_REVIEW_TAP,
+                [],
+                expected_text,
+                screen_change_after_last_instruction = False,
+            )
+            if length_offset == 0:
+                # The choice to switch the display type is only offered if another display type is available.
+                navigator.navigate_until_text(
+                    NavInsID.USE_CASE_REVIEW_TAP,
+                    [NavInsID.USE_CASE_CHOICE_REJECT],
+                    DISPLAY_TYPE_CHOICE_TEXT,
+                    screen_change_before_first_instruction = False,
+                )
+            navigator.navigate_until_text(
+                NavInsID.USE_CASE_REVIEW_TAP,
+                [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+                "Hold to sign",
+                screen_change_before_first_instruction = False,
+            )
+    apdus.check_async_response(backend)
+
 def test_sign_message_reject(device: Device, backend, navigator, default_screenshot_path, test_name):
     # As the reject flow is the same for all different message types, and is handled mostly by the SDK, we test it only
     # for one of the messages, the basic ascii message.
@@ -82,10 +181,12 @@ def test_sign_message_reject(device: Device, backend, navigator, default_screens
         assert e.value.status == Errors.SW_DENY
         assert len(e.value.data) == 0
     else:
-        # Test the reject button on the three pages of the ascii message flow.
-        for i in range(3):
-            instructions = [NavInsID.USE_CASE_REVIEW_TAP] * i
-            instructions += [
+        # Test the reject button on the intro and message pages of the ascii message flow.
+        for i, instructions in enumerate([
+            [],
+            [NavInsID.USE_CASE_REVIEW_TAP],
+        ]):
+            instructions = instructions + [
                 NavInsID.USE_CASE_REVIEW_REJECT,
                 NavInsID.USE_CASE_CHOICE_CONFIRM,
                 NavInsID.USE_CASE_STATUS_DISMISS,
@@ -98,3 +199,57 @@ def test_sign_message_reject(device: Device, backend, navigator, default_screens
                 )
             assert e.value.status == Errors.SW_DENY
             assert len(e.value.data) == 0
+        # The sign page follows the choice to switch the display type, and is checked for its text.
+        with pytest.raises(ExceptionRAPDU) as e, apdus.exchange_async(backend):
+            navigator.navigate_until_text(
+                NavInsID.USE_CASE_REVIEW_TAP,
+                [NavInsID.USE_CASE_CHOICE_REJECT],
+                DISPLAY_TYPE_CHOICE_TEXT,
+            )
+            navigator.navigate_until_text(
+                NavInsID.USE_CASE_REVIEW_TAP,
+                [NavInsID.USE_CASE_REVIEW_REJECT, NavInsID.USE_CASE_CHOICE_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+                "Hold to sign",
+                screen_change_before_first_instruction = False,
+            )
+        assert e.value.status == Errors.SW_DENY
+        assert len(e.value.data) == 0
+
+def test_sign_message_switch_display_type(device: Device, backend, navigator):
+    if device.is_nano:
+        pytest.skip("Nano devices offer the display types as regular steps of the message flow")
+    apdus = APDUS["ascii"]
+    with apdus.exchange_async(backend):
+        # Switch from ascii to hex display, which restarts the review, and then sign without switching again.
+        navigator.navigate_until_text(
+            NavInsID.USE_CASE_REVIEW_TAP,
+            [NavInsID.USE_CASE_CHOICE_CONFIRM],
+            DISPLAY_TYPE_CHOICE_TEXT,
+        )
+        navigator.navigate_until_text(
+            NavInsID.USE_CASE_REVIEW_TAP,
+            [],
+            "Message Hex",
+            screen_change_after_last_instruction = False,
+        )
+        navigator.navigate_until_text(
+            NavInsID.USE_CASE_REVIEW_TAP,
+            [NavInsID.USE_CASE_CHOICE_REJECT],
+            DISPLAY_TYPE_CHOICE_TEXT,
+            screen_change_before_first_instruction = False,
+        )
+        navigator.navigate_until_text(
+            NavInsID.USE_CASE_REVIEW_TAP,
+            [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+            "Hold to sign",
+            screen_change_before_first_instruction = False,
+        )
+    # The signature does not depend on the display type.
+    apdus.check_async_response(backend)
+
+def test_sign_message_continuation_without_start(backend):
+    # A continuation chunk (P1_MORE) without a preceding first chunk must be rejected, instead of continuing the hashing
+    # in an uninitialized or foreign request context.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e00a800004cafecafe"))
+    assert e.value.status == Errors.SW_BAD_STATE
@@ -5,6 +5,7 @@ from ragger.navigator import NavInsID
 
 from .raw_apdu_exchange import RawApduExchange
 from .errors import Errors
+from .utils import max_raw_tx_length
 
 APDUS = {
     # Basic transactions
@@ -263,6 +264,99 @@ APDUS = {
     ),
 }
 
+# Contract creation transactions, which are only supported for legacy transactions. Their review is tested without
+# screenshots. The recipient is ignored by the app, as it is the deterministically computed contract address.
+CONTRACT_CREATION_APDUS = {
+    # Version: 'legacy',
+    # Sender: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9', Sender Type: '0',
+    # Recipient: 'NQ07 0000 0000 0000 0000 0000 0000 0000 0000', Recipient Type: '2',
+    # Amount: '100', Fee: '0',
+    # Validity Start Height: '1234', Network: 'test', Flags: '1'
+    # Transaction Data (HTLC Creation): Refund Address: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9' (the sender),
+    # Redeem Address: 'NQ34 248H 248H 248H 248H 248H 248H 248H 248H', Hash Algorithm: 'sha256', Hash Root: '22...22',
+    # Hash Count: '1', Timeout: '201234'
+    "htlc_creation": RawApduExchange(
+        "e0040000a2048000002c800000f2800000008000000000004ee677d153553b84db141148ec9d7e77bb55983a2911111111111111111111"
+            "111111111111111111110322222222222222222222222222222222222222222222222222222222222222220100031212e677d15355"
+            "3b84db141148ec9d7e77bb55983a290000000000000000000000000000000000000000000200000000009896800000000000000000"
+            "000004d20101",
+        "ed65adec0d2189037dee1b34beaf66879a839bb8d86ea80916625ec9f4fd1d2e7a183c30c58fbb7f024c0c291f5af301d2d5ffa6b3627b"
+            "9c709a4c1391fe9a08",
+    ),
+    # Version: 'legacy',
+    # Sender: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9', Sender Type: '0',
+    # Recipient: 'NQ07 0000 0000 0000 0000 0000 0000 0000 0000', Recipient Type: '1',
+    # Amount: '100', Fee: '0',
+    # Validity Start Height: '1234', Network: 'test', Flags: '1'
+    # Transaction Data (Vesting Creation): Owner Address: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9' (the sender),
+    # Step Block Count: '1000', i.e. a single step, in which the entire amount vests at block 1000
+    "vesting_creation": RawApduExchange(
+        "e00400006c048000002c800000f28000000080000000000018e677d153553b84db141148ec9d7e77bb55983a29000003e8e677d153553b"
+            "84db141148ec9d7e77bb55983a29000000000000000000000000000000000000000000010000000000989680000000000000000000"
+            "0004d20101",
+        "9d86c63f576821e14f88664d623007350112cc3bb885ebe724d9513075a411805a19192fa7edb8ac4e47847c835ba26805a785fc7350b4"
+            "e722593f491a71aa0b",
+    ),
+}
+
+# P1 modes of streamed signing mode, see handle_sign_transaction in main.c.
+P1_STREAMED_FIRST_PASS = 0x01
+P1_STREAMED_SECOND_PASS = 0x02
+
+# Version: 'albatross',
+# Sender: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9', Sender Type: '0',
+# Recipient: 'NQ77 0000 0000 0000 0000 0000 0000 0000 0001', Recipient Type: '3',
+# Amount: '10000', Fee: '0',
+# Validity Start Height: '1234', Network: 'test', Flags: '0'
+# Transaction Data (Create Validator): Signing Key: '33...33', Voting Key: bytes 0x00 to 0x1c (285 bytes),
+# Reward Address: 'NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9', Signal Data: '', Proof of Knowledge: '44...44',
+# Signature Proof: ''
+# The serialized transaction of 599 bytes, without Bip32 path and transaction version, exceeds MAX_RAW_TX on Nano X.
+CREATE_VALIDATOR_TX = bytes.fromhex(
+    "0214" "00" + "33" * 32 + (bytes(range(256)) + bytes(range(29))).hex() + "e677d153553b84db141148ec9d7e77bb55983a29"
+    + "00" + "44" * 95 + "00" * 98
+    + "e677d153553b84db141148ec9d7e77bb55983a2900" "000000000000000000000000000000000000000103" "000000003b9aca00"
+    "0000000000000000" "000004d2" "05" "00" "00"
+)
+# The signature of the transaction with the empty signature proof, as returned by the second pass of streamed signing
+# mode, and in regular mode as validator signature, i.e. the second signature, to fill in the signature proof.
+CREATE_VALIDATOR_TX_SIGNATURE = bytes.fromhex(
+    "2ed9f50b90f7aab647ed6eca3afec09ef5c75f792a6c89b09c3ee86dda01a5d7ed003e31f737cba62962ef6f32de050f82aaf2215870aea3"
+    "811fa45fd0764a06"
+)
+
+def transaction_apdus(raw_tx: bytes, p1_mode: int = 0, with_path_and_version: bool = True) -> list[bytes]:
+    """Split a serialized albatross transaction into sign transaction APDUs of up to 255 bytes of data"""
+    data = (bytes.fromhex("048000002c800000f28000000080000000" "01") if with_path_and_version else b"") + raw_tx
+    apdus = []
+    for offset in range(0, len(data), 255):
+        chunk = data[offset:offset + 255]
+        p1 = (0x00 if offset == 0 else 0x80) | p1_mode # P1_FIRST or P1_MORE
+        p2 = 0x80 if offset + 255 < len(data) else 0x00 # P2_MORE or P2_LAST
+        apdus.append(bytes([0xe0, 0x04, p1, p2, len(chunk)]) + chunk)
+    return apdus
+
+def approve_transaction_review(device: Device, navigator) -> None:
+    """Navigate through a transaction review and approve it, without comparing screenshots"""
+    if device.is_nano:
+        navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Accept")
+    else:
+        navigator.navigate_until_text(
+            NavInsID.USE_CASE_REVIEW_TAP,
+            [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+            "Hold to sign",
+        )
+
+def exchange_streamed_first_pass(device: Device, backend, navigator, raw_tx: bytes) -> None:
+    first_pass = transaction_apdus(raw_tx, P1_STREAMED_FIRST_PASS)
+    for apdu in first_pass[:-1]:
+        assert backend.exchange_raw(apdu).status == 0x9000
+    with backend.exchange_async_raw(first_pass[-1]):
+        approve_transaction_review(device, navigator)
+    response = backend.last_async_response
+    assert response.status == 0x9000
+    assert response.data == b""
+
 def test_sign_transaction_approve(device: Device, backend, navigator, default_screenshot_path, test_name):
     for name, apdus in APDUS.items():
         name = name.removesuffix("_legacy") # UI / screenshots are the same for legacy transactions
@@ -286,6 +380,12 @@ def test_sign_transaction_approve(device: Device, backend, navigator, default_sc
                 )
         apdus.check_async_response(backend)
 
+def test_sign_transaction_contract_creation_approve(device: Device, backend, navigator):
+    for apdus in CONTRACT_CREATION_APDUS.values():
+        with apdus.exchange_async(backend):
+            approve_transaction_review(device, navigator)
+        apdus.check_async_response(backend)
+
 def test_sign_transaction_reject(device: Device, backend, navigator, default_screenshot_path, test_name):
     # As the reject flow is the same for all different transaction types, and is handled mostly by the SDK, we test it
     # only for one of the transactions, the basic transaction.
@@ -318,3 +418,102 @@ def test_sign_transaction_reject(device: Device, backend, navigator, default_scr
                 )
             assert e.value.status == Errors.SW_DENY
             assert len(e.value.data) == 0
+
+def test_sign_transaction_validator_invalid_data(device: Device, backend):
+    # Update Validator without any changes, with a trailing byte after the empty signature proof.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex(
+            "e0040000be048000002c800000f28000000080000000010069010000000000000000000000000000000000000000000000000000000000"
+            "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+            "0000000000000000000000000000000000000000e677d153553b84db141148ec9d7e77bb55983a29000000000000000000000000000000"
+            "0000000000010300000000000000000000000000000000000004d2050200"
+        ))
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+    # First chunk of a Create Validator transaction, whose 532 bytes of recipient data including the BLS voting key and
+    # proof of knowledge exceed the supported transaction length on devices with less RAM, which is rejected as soon as
+    # the data length is known. Other devices support the entire transaction.
+    create_validator_first_chunk = bytes.fromhex(
+        "e004008052048000002c800000f28000000080000000010214003333333333333333333333333333333333333333333333333333333333"
+        "333333000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c"
+    )
+    if max_raw_tx_length(device) < 2 + 532:
+        with pytest.raises(ExceptionRAPDU) as e:
+            backend.exchange_raw(create_validator_first_chunk)
+        assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+    else:
+        assert backend.exchange_raw(create_validator_first_chunk).status == 0x9000
+
+def test_sign_transaction_streamed_invalid_requests(backend):
+    # Second pass without an approved first pass.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e00402000400000000"))
+    assert e.value.status == Errors.SW_BAD_STATE
+    # Streamed signing mode is only supported for incoming staking transactions, and not for the basic transaction.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex(
+            "e004010055048000002c800000f28000000080000000010000e677d153553b84db141148ec9d7e77bb55983a2900000000000000000000"
+            "00000000000000000000000000000000009896800000000000000000000004d2050000"
+        ))
+    assert e.value.status == Errors.SW_NOT_SUPPORTED
+    # Unknown mode.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e00403000400000000"))
+    assert e.value.status == Errors.SW_WRONG_P1P2
+
+def test_sign_transaction_max_length(device: Device, backend):
+    # First chunks of albatross transactions, with the longest supported recipient data length, and one byte more, which
+    # is rejected as soon as the data length is known.
+    max_data_length = max_raw_tx_length(device) - 2 # minus the two bytes of the data length
+    for data_length, is_supported in [(max_data_length, True), (max_data_length + 1, False)]:
+        data = bytes.fromhex("048000002c800000f28000000080000000" "01") + data_length.to_bytes(2, "big")
+        apdu = bytes.fromhex("e0040080") + len(data).to_bytes(1, "big") + data
+        if is_supported:
+            assert backend.exchange_raw(apdu).status == 0x9000
+        else:
+            with pytest.raises(ExceptionRAPDU) as e:
+                backend.exchange_raw(apdu)
+            assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+
+def test_sign_transaction_streamed_create_validator(device: Device, backend, navigator):
+    exchange_streamed_first_pass(device, backend, navigator, CREATE_VALIDATOR_TX)
+    second_pass = transaction_apdus(CREATE_VALIDATOR_TX, P1_STREAMED_SECOND_PASS, with_path_and_version=False)
+    for apdu in second_pass[:-1]:
+        response = backend.exchange_raw(apdu)
+        assert response.status == 0x9000
+        assert response.data == b""
+    response = backend.exchange_raw(second_pass[-1])
+    assert response.status == 0x9000
+    assert response.data == CREATE_VALIDATOR_TX_SIGNATURE
+    # Each approved first pass allows for exactly one second pass.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(second_pass[0])
+    assert e.value.status == Errors.SW_BAD_STATE
+
+    if max_raw_tx_length(device) >= len(CREATE_VALIDATOR_TX):
+        # The regular mode creates the same signature over the transaction with the empty signature proof, as validator
+        # signature.
+        regular = transaction_apdus(CREATE_VALIDATOR_TX)
+        for apdu in regular[:-1]:
+            assert backend.exchange_raw(apdu).status == 0x9000
+        with backend.exchange_async_raw(regular[-1]):
+            approve_transaction_review(device, navigator)
+        response = backend.last_async_response
+        assert response.status == 0x9000
+        assert len(response.data) == 128
+        assert response.data[64:] == CREATE_VALIDATOR_TX_SIGNATURE
+
+def test_sign_transaction_streamed_modified_second_pass(device: Device, backend, navigator):
+    exchange_streamed_first_pass(device, backend, navigator, CREATE_VALIDATOR_TX)
+    # Change the fee in the second pass, which is detected at the end of the second pass.
+    modified_tx = bytearray(CREATE_VALIDATOR_TX)
+    modified_tx[-11] ^= 0x01
+    second_pass = transaction_apdus(bytes(modified_tx), P1_STREAMED_SECOND_PASS, with_path_and_version=False)
+    for apdu in second_pass[:-1]:
+        assert backend.exchange_raw(apdu).status == 0x9000
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(second_pass[-1])
+    assert e.value.status == Errors.SW_INCORRECT_DATA
+    # The nonce of the first pass was wiped, such that not even the unmodified transaction can be signed with it.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(transaction_apdus(CREATE_VALIDATOR_TX, P1_STREAMED_SECOND_PASS, False)[0])
+    assert e.value.status == Errors.SW_BAD_STATE
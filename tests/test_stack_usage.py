@@ -0,0 +1,87 @@
+import pytest
+from ledgered.devices import Device
+from ragger.error import ExceptionRAPDU
+
+from .errors import Errors
+from .test_sign_transaction import (
+    APDUS as SIGN_TRANSACTION_APDUS,
+    CONTRACT_CREATION_APDUS,
+    CREATE_VALIDATOR_TX,
+    CREATE_VALIDATOR_TX_SIGNATURE,
+    P1_STREAMED_SECOND_PASS,
+    approve_transaction_review,
+    exchange_streamed_first_pass,
+    transaction_apdus,
+)
+from .utils import max_raw_tx_length
+
+# Minimum free stack in bytes, which has to remain at the peak stack depth of each request, as safety margin for code
+# paths not covered by the tests, and for stack usage of the SDK, which might change between SDK versions.
+STACK_HEADROOM = 256
+
+# Order of the peak depths in the INS_GET_STACK_USAGE response, see stack_usage_slot_t in src/stack_usage.h
+STACK_USAGE_SLOTS = [
+    "get_public_key",
+    "sign_tx",
+    "sign_message",
+    "other_instructions",
+    "on_address_approved",
+    "on_transaction_approved",
+    "on_message_approved",
+    "on_rejected",
+    "io_event",
+]
+
+def get_stack_usage(backend, reset: bool) -> tuple[int, dict[str, int]]:
+    """Query the stack size and the peak stack depths per slot, which is only supported in debug builds.
+
+    Returns:
+        The stack size and the peak depths by slot name.
+    """
+    try:
+        response = backend.exchange_raw(bytes.fromhex("e00e" + ("01" if reset else "00") + "0000"))
+    except ExceptionRAPDU as e:
+        if e.status == Errors.SW_INS_NOT_SUPPORTED:
+            pytest.skip("Stack usage is only measured in debug builds")
+        raise
+    assert response.status == 0x9000
+    values = [int.from_bytes(response.data[i:i + 2], "big") for i in range(0, len(response.data), 2)]
+    assert len(values) == 1 + len(STACK_USAGE_SLOTS)
+    return values[0], dict(zip(STACK_USAGE_SLOTS, values[1:]))
+
+def check_stack_usage(backend, name: str) -> None:
+    """Check the peak stack depths of a signed transaction, since the last reset, and reset them."""
+    stack_size, peaks = get_stack_usage(backend, reset=True)
+    print(f"Stack usage for {name} of {stack_size} bytes: {peaks}")
+    for slot in ["sign_tx", "on_transaction_approved", "io_event"]:
+        assert peaks[slot] > 0, f"No stack usage measured for {slot} in {name}"
+        assert peaks[slot] + STACK_HEADROOM <= stack_size, \
+            f"Stack budget exceeded by {slot} in {name}: {peaks[slot]} of {stack_size} bytes"
+
+def test_stack_usage_sign_transaction(device: Device, backend, navigator):
+    get_stack_usage(backend, reset=True)
+    for name, apdus in (SIGN_TRANSACTION_APDUS | CONTRACT_CREATION_APDUS).items():
+        with apdus.exchange_async(backend):
+            approve_transaction_review(device, navigator)
+        apdus.check_async_response(backend)
+        check_stack_usage(backend, name)
+
+    # The Create Validator transaction in regular mode, on devices which support its length.
+    if max_raw_tx_length(device) >= len(CREATE_VALIDATOR_TX):
+        create_validator_apdus = transaction_apdus(CREATE_VALIDATOR_TX)
+        for apdu in create_validator_apdus[:-1]:
+            assert backend.exchange_raw(apdu).status == 0x9000
+        with backend.exchange_async_raw(create_validator_apdus[-1]):
+            approve_transaction_review(device, navigator)
+        assert backend.last_async_response.status == 0x9000
+        check_stack_usage(backend, "create_validator")
+
+def test_stack_usage_sign_transaction_streamed(device: Device, backend, navigator):
+    # Both passes of streamed signing mode, of which the first one includes the review and the second one the signing.
+    get_stack_usage(backend, reset=True)
+    exchange_streamed_first_pass(device, backend, navigator, CREATE_VALIDATOR_TX)
+    for apdu in transaction_apdus(CREATE_VALIDATOR_TX, P1_STREAMED_SECOND_PASS, with_path_and_version=False):
+        response = backend.exchange_raw(apdu)
+        assert response.status == 0x9000
+    assert response.data == CREATE_VALIDATOR_TX_SIGNATURE
+    check_stack_usage(backend, "create_validator_streamed")
@@ -0,0 +1,113 @@
+import time
+
+import pytest
+from ledgered.devices import Device
+from ragger.error import ExceptionRAPDU
+from ragger.navigator import NavInsID
+
+from .errors import Errors
+from .test_get_public_key import APDUS as GET_PUBLIC_KEY_APDUS
+
+# Order of the stages in the INS_GET_TIMINGS response, see timing_stage_t in src/timing.h
+TIMING_STAGES = [
+    "handle_apdu",
+    "parse_tx",
+    "derive_key",
+    "generate_public_key",
+    "sign",
+    "ui_init",
+    "review",
+    "ux_callback",
+]
+
+# Operations of INS_BENCHMARK, see timing_benchmark_operation_t in src/timing.h
+BENCHMARK_OPERATIONS = {
+    "derive_key": 0,
+    "generate_public_key": 1,
+    "sign": 2,
+    "blake2b": 3,
+}
+BENCHMARK_ITERATIONS = 5
+
+UNITS = ["ms", "cycles"]
+
+def exchange_debug_instruction(backend, apdu: bytes):
+    """Exchange an instruction, which is only supported in debug builds, and skip the test otherwise."""
+    try:
+        response = backend.exchange_raw(apdu)
+    except ExceptionRAPDU as e:
+        if e.status == Errors.SW_INS_NOT_SUPPORTED:
+            pytest.skip("Timings are only measured in debug builds")
+        raise
+    assert response.status == 0x9000
+    return response.data
+
+def get_timings_and_address_cache_stats(backend, reset: bool) \
+        -> tuple[str, dict[str, tuple[int, int, int]], tuple[int, int]]:
+    """Query the timing unit, the count, total and maximum duration by stage name, and the hits and misses of the
+    printed address memo."""
+    data = exchange_debug_instruction(backend, bytes.fromhex("e010" + ("01" if reset else "00") + "0000"))
+    assert len(data) == 1 + len(TIMING_STAGES) * 12 + 8
+    values = [int.from_bytes(data[i:i + 4], "big") for i in range(1, len(data), 4)]
+    timings = {stage: tuple(values[3 * i:3 * i + 3]) for i, stage in enumerate(TIMING_STAGES)}
+    return UNITS[data[0]], timings, (values[-2], values[-1])
+
+def get_timings(backend, reset: bool) -> tuple[str, dict[str, tuple[int, int, int]]]:
+    """Query the timing unit, and the count, total and maximum duration by stage name."""
+    unit, timings, _ = get_timings_and_address_cache_stats(backend, reset)
+    return unit, timings
+
+def test_timing_probes(backend):
+    get_timings(backend, reset=True)
+    GET_PUBLIC_KEY_APDUS["no_confirm"].exchange(backend)
+    unit, timings = get_timings(backend, reset=True)
+    print(f"Timings of get public key in {unit}: {timings}")
+    for stage in ["derive_key", "generate_public_key"]:
+        count, total, maximum = timings[stage]
+        assert count == 1, f"Stage {stage} not measured exactly once"
+        assert maximum == total
+    # The handling of the previous query, which reset the timings, is recorded after the reset, too.
+    assert timings["handle_apdu"][0] == 2
+    # The stats were reset by the previous query.
+    assert get_timings(backend, reset=False)[1]["derive_key"][0] == 0
+
+def test_address_cache_stats(device: Device, backend, navigator):
+    get_timings_and_address_cache_stats(backend, reset=True)
+    # Getting a public key without confirmation does not print the address.
+    GET_PUBLIC_KEY_APDUS["no_confirm"].exchange(backend)
+    assert get_timings_and_address_cache_stats(backend, reset=False)[2] == (0, 0)
+    # Getting it with confirmation prints the address when the request is received. The second time, it's memoized.
+    for _ in range(2):
+        with pytest.raises(ExceptionRAPDU) as e, GET_PUBLIC_KEY_APDUS["confirm"].exchange_async(backend):
+            if device.is_nano:
+                navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Reject")
+            else:
+                navigator.navigate([NavInsID.USE_CASE_REVIEW_REJECT, NavInsID.USE_CASE_STATUS_DISMISS])
+        assert e.value.status == Errors.SW_DENY
+    _, _, (hits, misses) = get_timings_and_address_cache_stats(backend, reset=True)
+    # The first print can also be a hit, if the address was already printed by a previous test.
+    assert hits + misses == 2 and hits >= 1
+    # The stats were reset by the previous query.
+    assert get_timings_and_address_cache_stats(backend, reset=False)[2] == (0, 0)
+
+def test_timing_benchmark(device: Device, backend):
+    for name, operation in BENCHMARK_OPERATIONS.items():
+        apdu = bytes([0xe0, 0x12, operation, 0x00, 0x02]) + BENCHMARK_ITERATIONS.to_bytes(2, "big")
+        start = time.perf_counter()
+        data = exchange_debug_instruction(backend, apdu)
+        round_trip_ms = (time.perf_counter() - start) * 1000
+        assert len(data) == 9
+        unit = UNITS[data[0]]
+        mean = int.from_bytes(data[1:5], "big")
+        maximum = int.from_bytes(data[5:9], "big")
+        assert mean <= maximum
+        if unit == "cycles":
+            assert mean > 0
+        print(f"Benchmark {name} on {device.name}: mean {mean} {unit}, max {maximum} {unit}, "
+            f"round trip {round_trip_ms / BENCHMARK_ITERATIONS:.1f} ms per iteration")
+
+    # Invalid operation and iteration count.
+    for apdu in ["e012040002" "0001", "e012000002" "0000", "e012000001" "01"]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            exchange_debug_instruction(backend, bytes.fromhex(apdu))
+        assert e.value.status in [Errors.SW_INCORRECT_DATA, Errors.SW_WRONG_DATA_LENGTH]
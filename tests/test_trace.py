@@ -0,0 +1,35 @@
+import pytest
+from ragger.error import ExceptionRAPDU
+
+from .errors import Errors
+from .test_get_public_key import APDUS as GET_PUBLIC_KEY_APDUS
+from .trace_decoder import dump_trace, format_entry
+
+def test_trace(backend):
+    try:
+        dump_trace(backend)
+    except ExceptionRAPDU as e:
+        if e.status == Errors.SW_INS_NOT_SUPPORTED:
+            pytest.skip("The trace is only recorded in debug builds")
+        raise
+
+    GET_PUBLIC_KEY_APDUS["no_confirm"].exchange(backend)
+    # Get public key with invalid P1.
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange_raw(bytes.fromhex("e002020011048000002c800000f28000000080000000"))
+    assert e.value.status == Errors.SW_WRONG_P1P2
+
+    event_count, entries = dump_trace(backend)
+    for entry in entries:
+        print(format_entry(entry))
+    assert event_count >= len(entries) >= 5
+    successful_command, successful_response, failed_command, error, failed_response = entries[-5:]
+    assert successful_command.event == "APDU_COMMAND" and successful_command.arg == 0x02
+    assert successful_response.event == "APDU_RESPONSE" and successful_response.payload == 0x9000
+    assert successful_response.error_site == 0
+    assert failed_command.event == "APDU_COMMAND" and failed_command.payload >> 16 == 0xe002
+    assert error.event == "ERROR" and error.payload == Errors.SW_WRONG_P1P2
+    assert failed_response.event == "APDU_RESPONSE" and failed_response.payload == Errors.SW_WRONG_P1P2
+    # The error site of the response is the first error of the request.
+    assert failed_response.error_site == error.error_site != 0
+    assert format_entry(error).endswith(f"main.c:{error.error_site & 0x7ff}")
@@ -0,0 +1,112 @@
+"""
+Dump and decode the binary trace of debug builds, see src/trace.h.
+
+The trace can be dumped from a running app via dump_trace, or decoded from the hex encoded INS_GET_TRACE responses
+(without status words) passed on the command line:
+
+    python3 -m tests.trace_decoder <response hex> [<response hex> ...]
+
+Error sites are resolved to source files via the error_site_file_t definitions in src/error_macros.h, and are only
+accurate for the source code version the app was built from.
+"""
+import re
+import sys
+from dataclasses import dataclass
+from pathlib import Path
+
+from ragger.backend.interface import BackendInterface
+
+INS_GET_TRACE = 0x14
+ENTRY_LENGTH = 12
+ERROR_SITE_LINE_BITS = 11
+
+# See trace_event_t in src/trace.h
+EVENTS = {
+    1: "APDU_COMMAND",
+    2: "APDU_RESPONSE",
+    3: "ERROR",
+    4: "ON_ADDRESS_APPROVED",
+    5: "ON_TRANSACTION_APPROVED",
+    6: "ON_MESSAGE_APPROVED",
+    7: "ON_REJECTED",
+    8: "KEEP_ALIVE_SENT",
+    9: "APP_RESET",
+}
+RESPONSE_KINDS = ["sync", "async started", "async sent"]
+
+@dataclass
+class TraceEntry:
+    event: str
+    arg: int
+    error_site: int
+    payload: int
+    timestamp: int
+
+def _read_error_site_files() -> dict[int, str]:
+    error_macros = (Path(__file__).parent.parent / "src" / "error_macros.h").read_text(encoding="utf-8")
+    return {
+        int(value): name.lower() + ".c"
+        for name, value in re.findall(r"^\s*ERROR_SITE_FILE_(\w+)\s*=\s*(\d+),", error_macros, re.M)
+    }
+
+ERROR_SITE_FILES = _read_error_site_files()
+
+def format_error_site(error_site: int) -> str:
+    if not error_site:
+        return "-"
+    file = ERROR_SITE_FILES.get(error_site >> ERROR_SITE_LINE_BITS, f"file {error_site >> ERROR_SITE_LINE_BITS}")
+    return f"{file}:{error_site & ((1 << ERROR_SITE_LINE_BITS) - 1)}"
+
+def parse_responses(responses: list[bytes]) -> tuple[int, list[TraceEntry]]:
+    """Parse INS_GET_TRACE responses into the total event count and the retained entries, from oldest to newest."""
+    event_count = 0
+    entries = []
+    for response in responses:
+        event_count = int.from_bytes(response[0:2], "big")
+        for offset in range(3, len(response), ENTRY_LENGTH):
+            entry = response[offset:offset + ENTRY_LENGTH]
+            entries.append(TraceEntry(
+                event=EVENTS.get(entry[0], f"UNKNOWN_{entry[0]}"),
+                arg=entry[1],
+                error_site=int.from_bytes(entry[2:4], "big"),
+                payload=int.from_bytes(entry[4:8], "big"),
+                timestamp=int.from_bytes(entry[8:12], "big"),
+            ))
+    return event_count, entries
+
+def dump_trace(backend: BackendInterface) -> tuple[int, list[TraceEntry]]:
+    """Read all retained entries of the trace, which is only supported in debug builds. Requests of the trace itself are
+    not traced, such that the trace doesn't change between the individual requests."""
+    responses = []
+    entry_index = 0
+    while True:
+        response = backend.exchange(0xe0, INS_GET_TRACE, p1=entry_index).data
+        responses.append(response)
+        entry_index += (len(response) - 3) // ENTRY_LENGTH
+        if entry_index >= response[2] or len(response) == 3:
+            break
+    return parse_responses(responses)
+
+def format_entry(entry: TraceEntry) -> str:
+    if entry.event == "APDU_COMMAND":
+        cla, p1, p2, lc = entry.payload.to_bytes(4, "big")
+        details = f"CLA {cla:02x} INS {entry.arg:02x} P1 {p1:02x} P2 {p2:02x} Lc {lc}"
+    elif entry.event == "APDU_RESPONSE":
+        kind = RESPONSE_KINDS[entry.arg] if entry.arg < len(RESPONSE_KINDS) else str(entry.arg)
+        details = f"SW {entry.payload:04x} ({kind}), error site {format_error_site(entry.error_site)}"
+    elif entry.event == "ERROR":
+        details = f"error 0x{entry.payload:02x} at {format_error_site(entry.error_site)}"
+    elif entry.event == "APP_RESET":
+        details = f"exception 0x{entry.payload:04x}"
+    else:
+        details = ""
+    return f"{entry.timestamp:>10} {entry.event:<24} {details}"
+
+def main(arguments: list[str]) -> None:
+    event_count, entries = parse_responses([bytes.fromhex(argument) for argument in arguments])
+    print(f"{event_count} events recorded, last {len(entries)} retained:")
+    for entry in entries:
+        print(format_entry(entry))
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -2,6 +2,8 @@ import re
 from pathlib import Path
 from typing import List, Tuple
 
+from ledgered.devices import Device, DeviceType
+
 def pop_sized_buf_from_buffer(buffer:bytes, size:int) -> Tuple[bytes, bytes]:
     return buffer[size:], buffer[0:size]
 
@@ -9,6 +11,27 @@ def pop_size_prefixed_buf_from_buf(buffer:bytes) -> Tuple[bytes, int, bytes]:
     data_len = buffer[0]
     return buffer[1+data_len:], data_len, buffer[1:data_len+1]
 
+def max_raw_tx_length(device: Device) -> int:
+    """Maximum length of a serialized transaction in regular signing mode, see MAX_RAW_TX in src/constants.h
+
+    Args:
+        device (Device): Device the app runs on
+    """
+    return 256 if device.type == DeviceType.NANOX else 640
+
+def max_printable_message_length(device: Device) -> int:
+    """Maximum length of a message which can be displayed as ascii or hex, see MAX_PRINTABLE_MESSAGE_LENGTH in
+    src/constants.h. Longer messages are displayed as message hash.
+
+    Args:
+        device (Device): Device the app runs on
+    """
+    if device.type == DeviceType.NANOX:
+        return 160
+    if device.type == DeviceType.NANOSP:
+        return 320
+    return 1024
+
 def verify_name(name: str) -> None:
     """Verify the app name, based on defines in Makefile
 
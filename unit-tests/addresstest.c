@@ -0,0 +1,132 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "user_friendly_address.h"
+#include "benchmark.h"
+
+static int failures = 0;
+
+static void expect_address(uint8_t *address, const char *expected) {
+    char printed[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
+    char printed_reference[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
+    memset(printed, 0xff, sizeof(printed));
+    if (print_address(address, printed) != ERROR_NONE
+        || print_address_reference(address, printed_reference) != ERROR_NONE
+        || strcmp(printed, printed_reference) != 0
+        || (expected && strcmp(printed, expected) != 0)) {
+        printf("test_address failed. Expected: %s; Actual: %s\n", expected ? expected : printed_reference, printed);
+        failures++;
+    }
+}
+
+void test_address_known() {
+    uint8_t address[20] = { 0 };
+    expect_address(address, "NQ07 0000 0000 0000 0000 0000 0000 0000 0000");
+    // Sender of the transactions in the ragger tests.
+    uint8_t sender[20] = { 0xe6, 0x77, 0xd1, 0x53, 0x55, 0x3b, 0x84, 0xdb, 0x14, 0x11, 0x48, 0xec, 0x9d, 0x7e, 0x77, 0xbb,
+        0x55, 0x98, 0x3a, 0x29 };
+    expect_address(sender, "NQ13 URTV 2LSM 7E2D N50H 93N9 SYKP PDAR GEH9");
+    memset(address, 0xff, sizeof(address));
+    expect_address(address, NULL);
+}
+
+void test_address_random() {
+    // Cross-check with the reference implementation, including all values of each single byte, which covers all chars
+    // at all positions, and random addresses.
+    uint8_t address[20];
+    for (uint8_t position = 0; position < 20; position++) {
+        for (uint16_t value = 0; value <= 0xff; value++) {
+            memset(address, 0, sizeof(address));
+            address[position] = value;
+            expect_address(address, NULL);
+        }
+    }
+    srand(1);
+    for (uint32_t i = 0; i < 100000; i++) {
+        for (uint8_t j = 0; j < 20; j++) {
+            address[j] = rand();
+        }
+        expect_address(address, NULL);
+    }
+}
+
+void test_address_cache() {
+    // The memo holds the two most recently printed addresses, in addition to the staking contract address.
+    uint8_t addresses[3][20];
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(addresses[i], i + 1, sizeof(addresses[i]));
+    }
+    uint8_t staking_contract[20] = { [19] = 1 };
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+    address_cache_stats_t stats_before = address_cache_get_stats();
+#endif
+    uint8_t sequence[] = { 0, 1, 0, 1, 2, 1, 0, 0 };
+    uint8_t expected_hits = 0;
+    for (uint8_t i = 0; i < sizeof(sequence); i++) {
+        expect_address(addresses[sequence[i]], NULL);
+        expect_address(staking_contract, "NQ77 0000 0000 0000 0000 0000 0000 0000 0001");
+    }
+    // Hits at positions 2, 3, 5 and 7, plus the staking contract each time.
+    expected_hits = 4 + sizeof(sequence);
+#if defined(NIMIQ_DEBUG) && NIMIQ_DEBUG
+    address_cache_stats_t stats = address_cache_get_stats();
+    if (stats.hits - stats_before.hits != expected_hits
+        || stats.misses - stats_before.misses != sizeof(sequence) - 4) {
+        printf("test_address_cache failed. Expected %u hits; Actual: %u hits, %u misses\n", expected_hits,
+            stats.hits - stats_before.hits, stats.misses - stats_before.misses);
+        failures++;
+    }
+#else
+    (void) expected_hits;
+#endif
+}
+
+void benchmark_address() {
+    // A transaction review prints up to four addresses. Printing them in turn evicts each from the memo of recently
+    // printed addresses before it's printed again, such that this benchmarks the actual encoding.
+    uint8_t addresses[4][20];
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 20; j++) {
+            addresses[i][j] = i * 20 + j * 37;
+        }
+    }
+    char printed[STRING_LENGTH_USER_FRIENDLY_ADDRESS];
+    uint32_t checksum = 0;
+    for (uint8_t implementation = 0; implementation < 2; implementation++) {
+        clock_t start = clock();
+        for (uint32_t iteration = 0; iteration < 100000; iteration++) {
+            for (uint8_t i = 0; i < 4; i++) {
+                error_t error = implementation == 0
+                    ? print_address(addresses[i], printed)
+                    : print_address_reference(addresses[i], printed);
+                checksum += error + printed[2] + printed[3];
+            }
+        }
+        benchmark_report(__func__, implementation == 0 ? "print_address" : "print_address_reference", start, 100000,
+            "4 addresses", checksum);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_address_known();
+    test_address_random();
+    test_address_cache();
+    if (benchmark_is_enabled(argc, argv)) benchmark_address();
+    return failures != 0;
+}
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#ifndef _NIMIQ_UNIT_TESTS_BENCHMARK_H_
+#define _NIMIQ_UNIT_TESTS_BENCHMARK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Host benchmarks of the unit tests. They only run if a test is started with argument --benchmark, to keep the
+ * default ./test.sh run quick. Each benchmark accumulates a checksum of its results, which is printed along with the
+ * timing, such that the compiler can not optimize the benchmarked code away.
+ */
+
+static inline bool benchmark_is_enabled(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--benchmark")) return true;
+    }
+    return false;
+}
+
+/**
+ * Print the duration since start per iteration. The variant is optional, for benchmarks comparing implementations.
+ */
+static inline void benchmark_report(const char *name, const char *variant, clock_t start, double iterations,
+    const char *iteration_description, uint32_t checksum) {
+    double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf("%s: %s%s%.2f ns per %s (checksum %u)\n", name, variant ? variant : "", variant ? ": " : "",
+        seconds * 1e9 / iterations, iteration_description, checksum);
+}
+
+#endif // _NIMIQ_UNIT_TESTS_BENCHMARK_H_
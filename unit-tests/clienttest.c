@@ -0,0 +1,376 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nimiq_client.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d check failed: %s\n", __func__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+// Mock transport, which checks the command APDUs against a script of expected commands and replies with the scripted
+// responses. Commands and responses are hex encoded, like in the ragger tests in tests/.
+
+#define MAX_SCRIPT_LENGTH 8
+#define MAX_HEX_LENGTH (2 * NIMIQ_TRANSPORT_MAX_COMMAND_LENGTH + 1)
+
+typedef struct {
+    nimiq_transport_t transport;
+    char expected_commands[MAX_SCRIPT_LENGTH][MAX_HEX_LENGTH];
+    char responses[MAX_SCRIPT_LENGTH][MAX_HEX_LENGTH];
+    int script_length;
+    int exchange_count;
+    bool is_closed;
+} mock_transport_t;
+
+static void encode_hex(const uint8_t *data, uint16_t length, char *out) {
+    for (uint16_t i = 0; i < length; i++) {
+        sprintf(out + 2 * i, "%02x", data[i]);
+    }
+    out[2 * length] = '\0';
+}
+
+static uint16_t decode_hex(const char *hex, uint8_t *out) {
+    uint16_t length = strlen(hex) / 2;
+    for (uint16_t i = 0; i < length; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &out[i]);
+    }
+    return length;
+}
+
+static error_t mock_exchange(nimiq_transport_t *transport, const uint8_t *command, uint16_t command_length,
+    uint8_t *out_response, uint16_t *out_response_length) {
+    mock_transport_t *mock = (mock_transport_t *) transport;
+    if (mock->exchange_count == mock->script_length) {
+        printf("Unexpected command after end of script\n");
+        failures++;
+        return ERROR_READ;
+    }
+    char command_hex[MAX_HEX_LENGTH];
+    encode_hex(command, command_length, command_hex);
+    if (strcmp(command_hex, mock->expected_commands[mock->exchange_count])) {
+        printf("Unexpected command %d.\nExpected: %s\nActual:   %s\n", mock->exchange_count,
+            mock->expected_commands[mock->exchange_count], command_hex);
+        failures++;
+    }
+    *out_response_length = decode_hex(mock->responses[mock->exchange_count], out_response);
+    mock->exchange_count++;
+    return ERROR_NONE;
+}
+
+static void mock_close(nimiq_transport_t *transport) {
+    ((mock_transport_t *) transport)->is_closed = true;
+}
+
+static void mock_init(mock_transport_t *mock) {
+    memset(mock, 0, sizeof(mock_transport_t));
+    mock->transport.exchange = mock_exchange;
+    mock->transport.close = mock_close;
+}
+
+static void mock_add_exchange(mock_transport_t *mock, const char *command_hex, const char *response_hex) {
+    strcpy(mock->expected_commands[mock->script_length], command_hex);
+    strcpy(mock->responses[mock->script_length], response_hex);
+    mock->script_length++;
+}
+
+static nimiq_client_t *create_client(mock_transport_t *mock) {
+    nimiq_client_t *client;
+    if (nimiq_client_create(&mock->transport, &client)) {
+        printf("Failed to create client\n");
+        exit(1);
+    }
+    return client;
+}
+
+static void destroy_client(nimiq_client_t *client, mock_transport_t *mock) {
+    nimiq_client_destroy(client);
+    CHECK(mock->is_closed);
+    CHECK(mock->exchange_count == mock->script_length);
+}
+
+#define PATH_HEX "048000002c800000f28000000080000000" // 44'/242'/0'/0'
+#define SIGNATURE_HEX_A "e5c55becb7c0873a23ad79c2000038475b14d95a9e49619de6b91e158e2593658758acd5f30693c36c8f9a5edd" \
+    "79668aaf07d01256ab319ab2c4fa65e6da9d09"
+#define SIGNATURE_HEX_B "9687e14d6149acbcf4e400d170b43e4537088c3f32f6f0affe2e861a0ca9924026d175f67c7b3e11e63a0c116bff" \
+    "4e68f99560d41601fe412475f0488cb8180d"
+// The "basic" transaction of tests/test_sign_transaction.py, without path and version.
+#define BASIC_TX_HEX "0000e677d153553b84db141148ec9d7e77bb55983a2900000000000000000000000000000000000000000000000000" \
+    "00009896800000000000000000000004d2050000"
+
+static nimiq_bip32_path_t default_path() {
+    nimiq_bip32_path_t path;
+    nimiq_bip32_path_parse("44'/242'/0'/0'", &path);
+    return path;
+}
+
+static bool equals_hex(const uint8_t *data, uint16_t length, const char *expected_hex) {
+    char hex[MAX_HEX_LENGTH];
+    encode_hex(data, length, hex);
+    return !strcmp(hex, expected_hex);
+}
+
+void test_bip32_path_parse() {
+    nimiq_bip32_path_t path;
+    CHECK(nimiq_bip32_path_parse("44'/242'/0'/0'", &path) == ERROR_NONE && path.length == 4
+        && path.indices[0] == 0x8000002c && path.indices[1] == 0x800000f2 && path.indices[3] == 0x80000000);
+    CHECK(nimiq_bip32_path_parse("m/44h/242h/1/2147483647", &path) == ERROR_NONE && path.length == 4
+        && path.indices[2] == 1 && path.indices[3] == 0x7fffffff);
+    CHECK(nimiq_bip32_path_parse("1/2/3/4/5/6/7/8/9/10", &path) == ERROR_NONE && path.length == 10);
+    CHECK(nimiq_bip32_path_parse("1/2/3/4/5/6/7/8/9/10/11", &path) == ERROR_INVALID_LENGTH);
+    CHECK(nimiq_bip32_path_parse("", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("m/", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("44'/", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("44''", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("/44'", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("2147483648", &path) == ERROR_INCORRECT_DATA);
+    CHECK(nimiq_bip32_path_parse("44x", &path) == ERROR_INCORRECT_DATA);
+}
+
+void test_get_public_key() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    // APDUs of tests/test_get_public_key.py
+    mock_add_exchange(&mock, "e0020000" "11" PATH_HEX,
+        "7ff1d4d8ab9cc6a4da4d2f1bf5a5e61e7b1c7b6fc3e0f0e22d1b16d9e0d5a3c2" "9000");
+    mock_add_exchange(&mock, "e0020001" "11" PATH_HEX, "6985");
+    nimiq_client_t *client = create_client(&mock);
+
+    nimiq_public_key_request_t request = { .path = default_path() };
+    nimiq_public_key_result_t result;
+    CHECK(nimiq_client_get_public_key(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK);
+    CHECK(equals_hex(result.public_key, NIMIQ_PUBLIC_KEY_LENGTH,
+        "7ff1d4d8ab9cc6a4da4d2f1bf5a5e61e7b1c7b6fc3e0f0e22d1b16d9e0d5a3c2"));
+
+    request.confirm = true;
+    CHECK(nimiq_client_get_public_key(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_DENY);
+    destroy_client(client, &mock);
+}
+
+void test_get_public_key_with_signature() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    mock_add_exchange(&mock, "e0020100" "1c" PATH_HEX "64756d6d792d646174613a" /* dummy-data: */,
+        "7ff1d4d8ab9cc6a4da4d2f1bf5a5e61e7b1c7b6fc3e0f0e22d1b16d9e0d5a3c2" SIGNATURE_HEX_A "9000");
+    // Response of invalid length
+    mock_add_exchange(&mock, "e0020100" "1c" PATH_HEX "64756d6d792d646174613a",
+        "7ff1d4d8ab9cc6a4da4d2f1bf5a5e61e7b1c7b6fc3e0f0e22d1b16d9e0d5a3c2" "9000");
+    nimiq_client_t *client = create_client(&mock);
+
+    nimiq_public_key_request_t request = {
+        .path = default_path(),
+        .verification_message = (const uint8_t *) "dummy-data:",
+        .verification_message_length = strlen("dummy-data:"),
+    };
+    nimiq_public_key_result_t result;
+    CHECK(nimiq_client_get_public_key(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK);
+    CHECK(equals_hex(result.signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_A));
+    CHECK(nimiq_client_get_public_key(client, &request, &result) == ERROR_INVALID_LENGTH);
+    destroy_client(client, &mock);
+}
+
+void test_sign_transaction() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    // The "basic" transaction of tests/test_sign_transaction.py
+    mock_add_exchange(&mock, "e0040000" "55" PATH_HEX "01" BASIC_TX_HEX, SIGNATURE_HEX_A "9000");
+    // Staker signature for an empty staker signature proof
+    mock_add_exchange(&mock, "e0040000" "55" PATH_HEX "01" BASIC_TX_HEX, SIGNATURE_HEX_A SIGNATURE_HEX_B "9000");
+    nimiq_client_t *client = create_client(&mock);
+
+    uint8_t transaction[NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH];
+    nimiq_transaction_request_t request = {
+        .path = default_path(),
+        .version = TRANSACTION_VERSION_ALBATROSS,
+        .transaction = transaction,
+        .transaction_length = decode_hex(BASIC_TX_HEX, transaction),
+    };
+    nimiq_transaction_result_t result;
+    CHECK(nimiq_client_sign_transaction(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK && !result.has_staker_signature);
+    CHECK(equals_hex(result.signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_A));
+
+    CHECK(nimiq_client_sign_transaction(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK && result.has_staker_signature);
+    CHECK(equals_hex(result.signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_A));
+    CHECK(equals_hex(result.staker_signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_B));
+    destroy_client(client, &mock);
+}
+
+void test_sign_transaction_streamed() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    mock_add_exchange(&mock, "e0040100" "55" PATH_HEX "01" BASIC_TX_HEX, "9000");
+    mock_add_exchange(&mock, "e0040200" "43" BASIC_TX_HEX, SIGNATURE_HEX_A "9000");
+    // Rejected first pass, for which no second pass is sent.
+    mock_add_exchange(&mock, "e0040100" "55" PATH_HEX "01" BASIC_TX_HEX, "6985");
+    nimiq_client_t *client = create_client(&mock);
+
+    uint8_t transaction[NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH];
+    nimiq_transaction_request_t request = {
+        .path = default_path(),
+        .version = TRANSACTION_VERSION_ALBATROSS,
+        .transaction = transaction,
+        .transaction_length = decode_hex(BASIC_TX_HEX, transaction),
+        .streamed = true,
+    };
+    nimiq_transaction_result_t result;
+    CHECK(nimiq_client_sign_transaction(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK);
+    CHECK(equals_hex(result.signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_A));
+    CHECK(nimiq_client_sign_transaction(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_DENY);
+    destroy_client(client, &mock);
+}
+
+void test_sign_transactions_batch() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    mock_add_exchange(&mock, "e0040000" "55" PATH_HEX "01" BASIC_TX_HEX, SIGNATURE_HEX_A "9000");
+    mock_add_exchange(&mock, "e0040000" "55" PATH_HEX "01" BASIC_TX_HEX, "6985");
+    // The third transaction is not sent after the rejection of the second one.
+    nimiq_client_t *client = create_client(&mock);
+
+    uint8_t transaction[NIMIQ_TRANSPORT_MAX_RESPONSE_LENGTH];
+    nimiq_transaction_request_t request = {
+        .path = default_path(),
+        .version = TRANSACTION_VERSION_ALBATROSS,
+        .transaction = transaction,
+        .transaction_length = decode_hex(BASIC_TX_HEX, transaction),
+    };
+    nimiq_transaction_request_t requests[3] = { request, request, request };
+    nimiq_transaction_result_t results[3];
+    size_t processed_count;
+    CHECK(nimiq_client_sign_transactions(client, requests, 3, results, &processed_count) == ERROR_NONE);
+    CHECK(processed_count == 2);
+    CHECK(results[0].sw == SW_OK && results[1].sw == SW_DENY);
+    destroy_client(client, &mock);
+}
+
+void test_sign_message_keep_alive() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    // The "Hello world." message of tests/test_sign_message.py, interrupted by two keep-alive heartbeats.
+    mock_add_exchange(&mock, "e00a0000" "22" PATH_HEX "00" "0000000c" "48656c6c6f20776f726c642e", "6e02");
+    mock_add_exchange(&mock, "e008000000", "6e02");
+    mock_add_exchange(&mock, "e008000000", SIGNATURE_HEX_A "9000");
+    nimiq_client_t *client = create_client(&mock);
+
+    nimiq_message_request_t request = {
+        .path = default_path(),
+        .message = (const uint8_t *) "Hello world.",
+        .message_length = strlen("Hello world."),
+    };
+    nimiq_message_result_t result;
+    CHECK(nimiq_client_sign_message(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK);
+    CHECK(equals_hex(result.signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_A));
+    destroy_client(client, &mock);
+}
+
+void test_sign_message_chunked() {
+    // 300 byte message, of which 233 bytes fit the first chunk after the 22 byte header, and 67 bytes the second one.
+    uint8_t message[300];
+    for (uint16_t i = 0; i < sizeof(message); i++) message[i] = (uint8_t) i;
+    char message_hex[2 * sizeof(message) + 1];
+    encode_hex(message, sizeof(message), message_hex);
+    char first_chunk[MAX_HEX_LENGTH];
+    char second_chunk[MAX_HEX_LENGTH];
+    snprintf(first_chunk, sizeof(first_chunk), "e00a0080" "ff" PATH_HEX "01" "0000012c" "%.*s", 2 * 233, message_hex);
+    snprintf(second_chunk, sizeof(second_chunk), "e00a8000" "43" "%s", message_hex + 2 * 233);
+
+    mock_transport_t mock;
+    mock_init(&mock);
+    mock_add_exchange(&mock, first_chunk, "9000");
+    mock_add_exchange(&mock, second_chunk, SIGNATURE_HEX_A "9000");
+    // Non-empty response to an intermediate chunk
+    mock_add_exchange(&mock, first_chunk, "00" "9000");
+    // Error for an intermediate chunk aborts the request
+    mock_add_exchange(&mock, first_chunk, "6a80");
+    nimiq_client_t *client = create_client(&mock);
+
+    nimiq_message_request_t request = {
+        .path = default_path(),
+        .flags = MESSAGE_FLAG_PREFER_DISPLAY_TYPE_HEX,
+        .message = message,
+        .message_length = sizeof(message),
+    };
+    nimiq_message_result_t result;
+    CHECK(nimiq_client_sign_message(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_OK);
+    CHECK(nimiq_client_sign_message(client, &request, &result) == ERROR_INVALID_LENGTH);
+    CHECK(nimiq_client_sign_message(client, &request, &result) == ERROR_NONE);
+    CHECK(result.sw == SW_INCORRECT_DATA);
+    destroy_client(client, &mock);
+}
+
+static void on_message_signed(error_t error, const nimiq_message_result_t *result, void *user_data) {
+    CHECK(error == ERROR_NONE && result->sw == SW_OK);
+    CHECK(equals_hex(result->signature, NIMIQ_SIGNATURE_LENGTH, SIGNATURE_HEX_B));
+    atomic_fetch_add((atomic_int *) user_data, 1);
+}
+
+void test_sign_message_async() {
+    mock_transport_t mock;
+    mock_init(&mock);
+    for (int i = 0; i < 2; i++) {
+        mock_add_exchange(&mock, "e00a0000" "22" PATH_HEX "00" "0000000c" "48656c6c6f20776f726c642e",
+            SIGNATURE_HEX_B "9000");
+    }
+    nimiq_client_t *client = create_client(&mock);
+
+    nimiq_message_request_t request = {
+        .path = default_path(),
+        .message = (const uint8_t *) "Hello world.",
+        .message_length = strlen("Hello world."),
+    };
+    atomic_int callback_count = 0;
+    CHECK(nimiq_client_sign_message_async(client, &request, on_message_signed, &callback_count) == ERROR_NONE);
+    CHECK(nimiq_client_sign_message_async(client, &request, on_message_signed, &callback_count) == ERROR_NONE);
+    // Waits for the pending requests.
+    destroy_client(client, &mock);
+    CHECK(callback_count == 2);
+}
+
+int main() {
+    test_bip32_path_parse();
+    test_get_public_key();
+    test_get_public_key_with_signature();
+    test_sign_transaction();
+    test_sign_transaction_streamed();
+    test_sign_transactions_batch();
+    test_sign_message_keep_alive();
+    test_sign_message_chunked();
+    test_sign_message_async();
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All client tests passed\n");
+    return 0;
+}
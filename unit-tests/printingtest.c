@@ -0,0 +1,223 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "printing.h"
+#include "benchmark.h"
+
+static int failures = 0;
+
+static void expect_printed(const char *test, error_t error, const char *printed, const char *expected) {
+    if ((error == ERROR_NONE) != (expected != NULL) || (expected && strcmp(printed, expected) != 0)) {
+        printf("%s failed. Expected: %s; Actual: %s (error %d)\n", test, expected ? expected : "error",
+            error == ERROR_NONE ? printed : "error", error);
+        failures++;
+    }
+}
+
+// Reference amount printing via snprintf.
+static void print_amount_reference(uint64_t amount, const char *ticker, char *out, size_t out_length) {
+    char decimals[8];
+    snprintf(decimals, sizeof(decimals), ".%05u", (unsigned int) (amount % 100000));
+    for (int i = 5; i > 0 && decimals[i] == '0'; i--) decimals[i] = '\0';
+    if (decimals[1] == '\0') decimals[0] = '\0';
+    snprintf(out, out_length, "%" PRIu64 "%s%s%s", amount / 100000, decimals, ticker ? " " : "", ticker ? ticker : "");
+}
+
+static uint64_t random_u64() {
+    // Random values of random magnitude.
+    uint64_t value = ((uint64_t) rand() << 42) ^ ((uint64_t) rand() << 21) ^ rand();
+    return value >> (rand() % 64);
+}
+
+void test_print_numbers() {
+    char printed[32];
+    char expected[32];
+    uint64_t values[] = { 0, 1, 9, 10, 99999, 100000, 999999999, 1000000000, UINT32_MAX, (uint64_t) UINT32_MAX + 1,
+        MAX_SAFE_LUNA_AMOUNT, 999999999999999999, 1000000000000000000, UINT64_MAX };
+    for (uint32_t i = 0; i < 1000000; i++) {
+        uint64_t value = i < sizeof(values) / sizeof(values[0]) ? values[i] : random_u64();
+        snprintf(expected, sizeof(expected), "%" PRIu64, value);
+        expect_printed("print_u64", print_u64(value, printed, sizeof(printed)), printed, expected);
+        snprintf(expected, sizeof(expected), "%" PRIu32, (uint32_t) value);
+        expect_printed("print_u32", print_u32(value, printed, sizeof(printed)), printed, expected);
+        snprintf(expected, sizeof(expected), "%" PRIu32 " block%s", (uint32_t) value, (uint32_t) value != 1 ? "s" : "");
+        expect_printed("print_block_count", print_block_count(value, printed, sizeof(printed)), printed, expected);
+        print_amount_reference(value, "NIM", expected, sizeof(expected));
+        expect_printed("print_amount", print_amount(value, "NIM", printed, sizeof(printed)), printed, expected);
+        print_amount_reference(value, NULL, expected, sizeof(expected));
+        expect_printed("print_amount", print_amount(value, NULL, printed, sizeof(printed)), printed, expected);
+    }
+    expect_printed("print_amount", print_amount(1, "NIM", printed, sizeof(printed)), printed, "0.00001 NIM");
+    expect_printed("print_amount", print_amount(100000001, "NIM", printed, sizeof(printed)), printed, "1000.00001 NIM");
+    expect_printed("print_amount", print_amount(1000000010000, "NIM", printed, sizeof(printed)), printed,
+        "10000000.1 NIM");
+    expect_printed("print_block_count", print_block_count(1, printed, sizeof(printed)), printed, "1 block");
+
+    // Out buffers which exactly fit, and which are one byte too short.
+    expect_printed("print_u32", print_u32(12345, printed, 6), printed, "12345");
+    expect_printed("print_u32", print_u32(12345, printed, 5), printed, NULL);
+    expect_printed("print_amount", print_amount(123, "NIM", printed, 12), printed, "0.00123 NIM");
+    expect_printed("print_amount", print_amount(123, "NIM", printed, 11), printed, NULL);
+    expect_printed("print_block_count", print_block_count(2, printed, 9), printed, "2 blocks");
+    expect_printed("print_block_count", print_block_count(2, printed, 8), printed, NULL);
+    expect_printed("print_string", print_string("None", printed, 5), printed, "None");
+    expect_printed("print_string", print_string("None", printed, 4), printed, NULL);
+}
+
+void test_print_hex() {
+    uint8_t data[256];
+    char printed[sizeof(data) * 2 + 1];
+    char expected[sizeof(data) * 2 + 1] = { 0 };
+    for (uint16_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+        snprintf(expected + i * 2, 3, "%02X", i);
+    }
+    expect_printed("print_hex", print_hex(data, sizeof(data), printed, sizeof(printed)), printed, expected);
+    expect_printed("print_hex", print_hex(data, sizeof(data), printed, sizeof(printed) - 1), printed, NULL);
+    expect_printed("print_hex", print_hex(data, 0, printed, 1), printed, "");
+
+    // All combinations of input and output alignment and of lengths covering prologue, word loop and epilogue.
+    for (uint8_t data_offset = 0; data_offset < 4; data_offset++) {
+        for (uint8_t out_offset = 0; out_offset < 4; out_offset++) {
+            for (uint16_t length = 0; length <= 16; length++) {
+                expected[(data_offset + length) * 2] = '\0';
+                expect_printed("print_hex unaligned", print_hex(data + data_offset, length, printed + out_offset,
+                    sizeof(printed) - out_offset), printed + out_offset, expected + data_offset * 2);
+                snprintf(expected + (data_offset + length) * 2, 3, "%02X", data_offset + length);
+            }
+        }
+    }
+}
+
+static bool is_printable_ascii_reference(const uint8_t *data, uint16_t data_length) {
+    for (uint16_t i = 0; i < data_length; i++) {
+        if ((data[i] < /* space */ 32) || (data[i] > /* tilde */ 126)) return false;
+    }
+    return true;
+}
+
+void test_is_printable_ascii() {
+    uint8_t data[4 + 16];
+    memset(data, 'a', sizeof(data));
+    // Each byte value at each position of each alignment and length, such that every position of the prologue, the
+    // word loop and the epilogue is covered.
+    for (uint8_t offset = 0; offset < 4; offset++) {
+        for (uint8_t length = 0; length <= 16; length++) {
+            for (uint8_t position = 0; position < length; position++) {
+                for (uint16_t value = 0; value < 256; value++) {
+                    data[offset + position] = value;
+                    if (is_printable_ascii(data + offset, length)
+                        != is_printable_ascii_reference(data + offset, length)) {
+                        printf("is_printable_ascii failed for byte %u at offset %u, position %u, length %u\n", value,
+                            offset, position, length);
+                        failures++;
+                    }
+                }
+                data[offset + position] = 'a';
+            }
+        }
+    }
+}
+
+static void print_hex_reference(const uint8_t *data, uint16_t data_length, char *out) {
+    for (uint16_t i = 0; i < data_length; i++) {
+        snprintf(out + i * 2, /* 2 hex chars + string terminator */ 3, "%02X", data[i]);
+    }
+}
+
+static void print_hex_bytewise(const uint8_t *data, uint16_t data_length, char *out) {
+    static const char HEX_DIGITS[16] = "0123456789ABCDEF";
+    for (uint16_t i = 0; i < data_length; i++) {
+        out[i * 2] = HEX_DIGITS[data[i] >> 4];
+        out[i * 2 + 1] = HEX_DIGITS[data[i] & 0x0f];
+    }
+    out[data_length * 2] = '\0';
+}
+
+void benchmark_hex_and_ascii() {
+    // A message chunk of printable ascii, and a message hash, with one byte offset to include prologue and epilogue.
+    uint8_t data[1 + 255];
+    for (uint16_t i = 0; i < sizeof(data); i++) {
+        data[i] = ' ' + i % 95;
+    }
+    char printed[sizeof(data) * 2 + 1];
+    uint32_t checksum = 0;
+    const char *implementations[] = { "printing.c", "bytewise", "snprintf" };
+    for (uint8_t implementation = 0; implementation < 3; implementation++) {
+        clock_t start = clock();
+        for (uint32_t iteration = 0; iteration < 100000; iteration++) {
+            // Vary the data a little, such that the compiler can not hoist the checks out of the loop.
+            data[1 + iteration % 255] ^= iteration & 1;
+            if (implementation == 0) {
+                checksum += is_printable_ascii(data + 1, 255);
+                checksum += print_hex(data + 1, 32, printed, sizeof(printed));
+            } else if (implementation == 1) {
+                checksum += is_printable_ascii_reference(data + 1, 255);
+                print_hex_bytewise(data + 1, 32, printed);
+            } else {
+                checksum += is_printable_ascii_reference(data + 1, 255);
+                print_hex_reference(data + 1, 32, printed);
+            }
+            checksum += printed[iteration % 64];
+        }
+        benchmark_report(__func__, implementations[implementation], start, 100000,
+            "255 byte ascii check and 32 byte hex", checksum);
+    }
+}
+
+void benchmark_printing() {
+    // Typical values of a transaction review: amounts, fee and block numbers.
+    uint64_t values[64];
+    srand(2);
+    for (uint8_t i = 0; i < 64; i++) {
+        values[i] = random_u64() % MAX_SAFE_LUNA_AMOUNT;
+    }
+    char printed[32];
+    uint32_t checksum = 0;
+    for (uint8_t implementation = 0; implementation < 2; implementation++) {
+        clock_t start = clock();
+        for (uint32_t iteration = 0; iteration < 20000; iteration++) {
+            for (uint8_t i = 0; i < 64; i++) {
+                if (implementation == 0) {
+                    checksum += print_amount(values[i], "NIM", printed, sizeof(printed));
+                    checksum += print_u32(values[i], printed, sizeof(printed));
+                } else {
+                    print_amount_reference(values[i], "NIM", printed, sizeof(printed));
+                    snprintf(printed, sizeof(printed), "%" PRIu32, (uint32_t) values[i]);
+                }
+                checksum += printed[0];
+            }
+        }
+        benchmark_report(__func__, implementation == 0 ? "printing.c" : "snprintf", start, 20000 * 64,
+            "amount and number", checksum);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_print_numbers();
+    test_print_hex();
+    test_is_printable_ascii();
+    if (benchmark_is_enabled(argc, argv)) {
+        benchmark_printing();
+        benchmark_hex_and_ascii();
+    }
+    return failures != 0;
+}
@@ -0,0 +1,199 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "signature_proof.h"
+
+static int failures = 0;
+
+// Stub of the Blake2b hash from nimiq_utils.c, which depends on the Ledger SDK. compute_signature_proof_signer is not
+// tested here.
+error_t blake2b_256(uint8_t *in, uint16_t in_length, uint8_t *out) {
+    (void) in;
+    (void) in_length;
+    (void) out;
+    return ERROR_CRYPTOGRAPHY;
+}
+
+// Serialized signature proof, built field by field.
+typedef struct {
+    uint8_t data[2048];
+    uint16_t length;
+} proof_builder_t;
+
+static void append(proof_builder_t *builder, const uint8_t *data, uint16_t length, uint8_t fill) {
+    for (uint16_t i = 0; i < length; i++) {
+        builder->data[builder->length++] = data ? data[i] : fill;
+    }
+}
+
+static void append_u8(proof_builder_t *builder, uint8_t value) {
+    append(builder, &value, 1, 0);
+}
+
+static void append_vec(proof_builder_t *builder, uint16_t length, uint8_t fill) {
+    // Varint length, as serialized by postcard.
+    uint16_t remaining_value = length;
+    do {
+        append_u8(builder, (remaining_value & 0x7f) | (remaining_value >= 0x80 ? 0x80 : 0));
+        remaining_value >>= 7;
+    } while (remaining_value);
+    append(builder, NULL, length, fill);
+}
+
+static proof_builder_t build_proof(uint8_t type_and_flags, uint8_t merkle_path_length, uint16_t origin_length,
+    uint16_t client_data_extra_length, uint16_t authenticator_data_suffix_length) {
+    proof_builder_t builder = { .length = 0 };
+    append_u8(&builder, type_and_flags);
+    append(&builder, NULL, (type_and_flags & 0x0f) == SIGNATURE_PROOF_ALGORITHM_ES256 ? 33 : 32, 0xaa);
+    append_u8(&builder, merkle_path_length);
+    append(&builder, NULL, (merkle_path_length + 7) / 8, 0x55);
+    append(&builder, NULL, merkle_path_length * 32, 0xbb);
+    append(&builder, NULL, 64, 0xcc);
+    if (type_and_flags & SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS) {
+        append_vec(&builder, origin_length, 'o');
+        append_u8(&builder, 1);
+        append_vec(&builder, client_data_extra_length, 'c');
+        append_vec(&builder, authenticator_data_suffix_length, 'a');
+    }
+    return builder;
+}
+
+// Read a signature proof from a copy of the data in a buffer of exactly the data length, such that reads beyond the
+// data are detected by the address sanitizer. Checks that all fields of a successfully read proof lie within the data,
+// in serialization order, and that exactly expected_length bytes were consumed. The buffer is kept until the next call,
+// such that the fields of the returned proof can be inspected.
+static bool read_and_check(const uint8_t *data, uint16_t length, signature_proof_t *out, uint16_t expected_length) {
+    static uint8_t *buffer = NULL;
+    free(buffer);
+    buffer = malloc(length ? length : 1);
+    memcpy(buffer, data, length);
+    buffer_reader_t reader = reader_init(buffer, length);
+    bool success = read_signature_proof(&reader, out);
+    if (success) {
+        const uint8_t *end = buffer + length - reader.remaining_length;
+        const webauthn_extra_fields_t *webauthn_fields = &out->webauthn_fields;
+        const uint8_t *fields[] = { out->public_key, out->merkle_path_left_bits, out->merkle_path_node_hashes,
+            out->signature, webauthn_fields->origin_json, webauthn_fields->client_data_extra_json,
+            webauthn_fields->authenticator_data_suffix };
+        const uint16_t field_lengths[] = { out->public_key_length, (out->merkle_path_length + 7) / 8,
+            out->merkle_path_length * 32, 64, webauthn_fields->origin_json_length,
+            webauthn_fields->client_data_extra_json_length, webauthn_fields->authenticator_data_suffix_length };
+        const uint8_t *previous_end = buffer + 1;
+        for (uint8_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+            if ((fields[i] == NULL) != (field_lengths[i] == 0)
+                || (fields[i] && (fields[i] < previous_end || fields[i] + field_lengths[i] > end))) {
+                printf("read_signature_proof returned field %u out of bounds\n", i);
+                failures++;
+            }
+            if (fields[i]) previous_end = fields[i] + field_lengths[i];
+        }
+        if (expected_length != UINT16_MAX && end - buffer != expected_length) {
+            printf("read_signature_proof consumed %ld bytes instead of %u\n", (long) (end - buffer), expected_length);
+            failures++;
+        }
+    }
+    return success;
+}
+
+void test_signature_proof_variants() {
+    uint8_t type_fields[] = {
+        SIGNATURE_PROOF_ALGORITHM_ED25519,
+        SIGNATURE_PROOF_ALGORITHM_ES256,
+        SIGNATURE_PROOF_ALGORITHM_ED25519 | SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS,
+        SIGNATURE_PROOF_ALGORITHM_ES256 | SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS,
+    };
+    uint8_t merkle_path_lengths[] = { 0, 1, 8, 9 };
+    uint16_t webauthn_lengths[] = { 0, 1, 127, 128, 300 };
+    for (uint8_t t = 0; t < sizeof(type_fields); t++) {
+        for (uint8_t m = 0; m < sizeof(merkle_path_lengths); m++) {
+            for (uint8_t w = 0; w < sizeof(webauthn_lengths) / sizeof(webauthn_lengths[0]); w++) {
+                proof_builder_t proof = build_proof(type_fields[t], merkle_path_lengths[m], webauthn_lengths[w], 20,
+                    webauthn_lengths[w] / 2);
+                signature_proof_t signature_proof;
+                if (!read_and_check(proof.data, proof.length, &signature_proof, proof.length)
+                    || signature_proof.type_and_flags != type_fields[t]
+                    || signature_proof.public_key_length != (type_fields[t] & 0x0f ? 33 : 32)
+                    || signature_proof.merkle_path_length != merkle_path_lengths[m]
+                    || signature_proof.public_key[0] != 0xaa
+                    || signature_proof.signature[63] != 0xcc
+                    || ((type_fields[t] & SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS)
+                        && (signature_proof.webauthn_fields.origin_json_length != webauthn_lengths[w]
+                            || !signature_proof.webauthn_fields.has_cross_origin_field
+                            || signature_proof.webauthn_fields.client_data_extra_json_length != 20
+                            || signature_proof.webauthn_fields.client_data_extra_json[0] != 'c'))) {
+                    printf("test_signature_proof_variants failed for type 0x%02x, merkle path length %u, webauthn "
+                        "length %u\n", type_fields[t], merkle_path_lengths[m], webauthn_lengths[w]);
+                    failures++;
+                }
+                // Every truncation fails.
+                for (uint16_t length = 0; length < proof.length; length++) {
+                    if (read_and_check(proof.data, length, &signature_proof, UINT16_MAX)) {
+                        printf("test_signature_proof_variants accepted proof truncated to %u bytes\n", length);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    // Unsupported algorithms and flags.
+    for (uint16_t type_and_flags = 0; type_and_flags <= 0xff; type_and_flags++) {
+        bool is_supported = (type_and_flags & 0x0f) <= SIGNATURE_PROOF_ALGORITHM_ES256
+            && !(type_and_flags & 0xf0 & ~SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS);
+        proof_builder_t proof = build_proof(type_and_flags, 0, 0, 0, 0);
+        signature_proof_t signature_proof;
+        if (read_and_check(proof.data, proof.length, &signature_proof, proof.length) != is_supported) {
+            printf("test_signature_proof_variants failed for type 0x%02x\n", type_and_flags);
+            failures++;
+        }
+    }
+}
+
+void fuzz_signature_proof() {
+    // Random mutations of valid proofs of all variants, checked for out of bounds reads by the address sanitizer and
+    // for returned fields out of bounds by read_and_check.
+    srand(3);
+    for (uint32_t iteration = 0; iteration < 200000; iteration++) {
+        uint8_t type_and_flags = (rand() % 2) | (rand() % 2 ? SIGNATURE_PROOF_FLAG_WEBAUTHN_FIELDS : 0);
+        proof_builder_t proof = build_proof(type_and_flags, rand() % 12, rand() % 200, rand() % 200, rand() % 200);
+        uint8_t mutation_count = 1 + rand() % 4;
+        for (uint8_t i = 0; i < mutation_count; i++) {
+            uint16_t position = rand() % proof.length;
+            switch (rand() % 3) {
+                case 0:
+                    proof.data[position] = rand();
+                    break;
+                case 1:
+                    proof.data[position] ^= 1 << (rand() % 8);
+                    break;
+                default:
+                    proof.length = position;
+                    break;
+            }
+            if (!proof.length) break;
+        }
+        signature_proof_t signature_proof;
+        read_and_check(proof.data, proof.length, &signature_proof, UINT16_MAX);
+    }
+}
+
+int main() {
+    test_signature_proof_variants();
+    fuzz_signature_proof();
+    return failures != 0;
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+ *   Ledger Nimiq App
+ *   (c) 2018 Ledger
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "buffer_reader.h"
+#include "benchmark.h"
+
+static int failures = 0;
+
+// Reference encoder, equivalent to postcard's varint serialization.
+static uint8_t encode_uvarint(uint32_t value, uint8_t *out) {
+    uint8_t length = 0;
+    do {
+        out[length] = value & 0x7f;
+        value >>= 7;
+        if (value) out[length] |= 0x80;
+        length++;
+    } while (value);
+    return length;
+}
+
+static void expect_uvarint(uint8_t *data, uint16_t data_length, uint8_t max_bits, bool expected_error,
+    uint32_t expected_value, uint16_t expected_remaining_length) {
+    buffer_reader_t reader = reader_init(data, data_length);
+    uint32_t value = reader_read_serde_uvarint(&reader, max_bits);
+    if (reader.has_error != expected_error
+        || (!expected_error && (value != expected_value || reader.remaining_length != expected_remaining_length))) {
+        printf("test_uvarint failed for max_bits %u. Expected: %u (error %d); Actual: %u (error %d)\n", max_bits,
+            expected_value, expected_error, value, reader.has_error);
+        failures++;
+    }
+}
+
+void test_uvarint_exhaustive_u16() {
+    // All u16 values in their canonical encoding, and each value as truncated encoding.
+    uint8_t buffer[8];
+    for (uint32_t value = 0; value <= UINT16_MAX; value++) {
+        uint8_t length = encode_uvarint(value, buffer);
+        buffer[length] = 0xff; // trailing byte which must not be consumed
+        expect_uvarint(buffer, length + 1, 16, false, value, 1);
+        expect_uvarint(buffer, length - 1, 16, true, 0, 0);
+        // Values exceeding the 7 bit range of a single byte varint.
+        expect_uvarint(buffer, length, 7, value > 0x7f, value, 0);
+    }
+    // Values beyond u16, which are encoded with 3 bytes as well.
+    for (uint32_t value = UINT16_MAX + 1; value < (1 << 21); value += 0x1f) {
+        uint8_t length = encode_uvarint(value, buffer);
+        expect_uvarint(buffer, length, 16, true, 0, 0);
+    }
+}
+
+void test_uvarint_u32() {
+    uint8_t buffer[8];
+    // Boundaries of each encoded length and a sweep over the value range.
+    uint32_t values[] = { 0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0x1fffff, 0x200000, 0xfffffff, 0x10000000, UINT32_MAX };
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint8_t length = encode_uvarint(values[i], buffer);
+        expect_uvarint(buffer, length, 32, false, values[i], 0);
+    }
+    for (uint64_t value = 0; value <= UINT32_MAX; value += 0x10001) {
+        uint8_t length = encode_uvarint((uint32_t) value, buffer);
+        expect_uvarint(buffer, length, 32, false, (uint32_t) value, 0);
+    }
+
+    // Overflow of a u32 in the 5th byte.
+    uint8_t overflow[] = { 0xff, 0xff, 0xff, 0xff, 0x10 };
+    expect_uvarint(overflow, sizeof(overflow), 32, true, 0, 0);
+    // More than 5 bytes.
+    uint8_t too_long[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+    expect_uvarint(too_long, sizeof(too_long), 32, true, 0, 0);
+    // Non-canonical encodings with trailing zero groups.
+    uint8_t non_canonical_zero[] = { 0x80, 0x00 };
+    expect_uvarint(non_canonical_zero, sizeof(non_canonical_zero), 32, true, 0, 0);
+    uint8_t non_canonical_one[] = { 0x81, 0x80, 0x00 };
+    expect_uvarint(non_canonical_one, sizeof(non_canonical_one), 32, true, 0, 0);
+    // Unsupported max_bits.
+    expect_uvarint(buffer, 1, 0, true, 0, 0);
+    expect_uvarint(buffer, 1, 33, true, 0, 0);
+}
+
+void test_serde_vec_u8() {
+    uint8_t buffer[300] = { 0x80 | (200 & 0x7f), 200 >> 7 };
+    buffer_reader_t reader = reader_init(buffer, 2 + 200);
+    uint16_t data_length;
+    uint8_t *data = reader_read_serde_vec_u8(&reader, &data_length);
+    if (reader.has_error || data != buffer + 2 || data_length != 200 || reader.remaining_length) {
+        printf("test_serde_vec_u8 failed for multi-byte length\n");
+        failures++;
+    }
+    reader = reader_init(buffer, 2 + 199);
+    data = reader_read_serde_vec_u8(&reader, &data_length);
+    if (!reader.has_error || data || data_length) {
+        printf("test_serde_vec_u8 failed for truncated data\n");
+        failures++;
+    }
+}
+
+void benchmark_uvarint() {
+    // Mostly single byte varints, as typical for transaction data, and some multi-byte varints.
+    uint8_t buffer[4096];
+    uint16_t length = 0;
+    for (uint32_t i = 0; length < sizeof(buffer) - 5; i++) {
+        length += encode_uvarint(i % 16 ? i & 0x7f : i * 0x3f1, buffer + length);
+    }
+    uint32_t checksum = 0;
+    clock_t start = clock();
+    for (uint32_t iteration = 0; iteration < 10000; iteration++) {
+        buffer_reader_t reader = reader_init(buffer, length);
+        while (reader.remaining_length && !reader.has_error) {
+            checksum += reader_read_serde_uvarint(&reader, 32);
+        }
+    }
+    char iteration_description[32];
+    snprintf(iteration_description, sizeof(iteration_description), "%u byte buffer iteration", length);
+    benchmark_report(__func__, NULL, start, 10000, iteration_description, checksum);
+}
+
+int main(int argc, char *argv[]) {
+    test_uvarint_exhaustive_u16();
+    test_uvarint_u32();
+    test_serde_vec_u8();
+    if (benchmark_is_enabled(argc, argv)) benchmark_uvarint();
+    return failures != 0;
+}